@@ -1,5 +1,6 @@
 #include "BLE_Comms.h"
 #include "ChargerLogic/ChargerLogic.h" // 需要與核心邏輯層交互
+#include "ConfigStore/ConfigStore.h"
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
@@ -36,21 +37,21 @@ class ConfigCallbacks: public BLECharacteristicCallbacks {
         
         if (value.length() > 0) {
             // 獲取當前的設定，因為我們只修改其中一個值
-            unsigned int current_v = logic_get_max_voltage_setting();
-            unsigned int current_a = logic_get_max_current_setting();
-            int current_soc = logic_get_target_soc_setting();
+            unsigned int current_v = config_get_max_voltage();
+            unsigned int current_a = config_get_max_current();
+            int current_soc = config_get_target_soc();
 
             // 根據UUID判斷是哪個設定被修改了
             if (uuid == BLEUUID(CHAR_TARGET_SOC_UUID).toString()) {
                 int new_soc = atoi(value.c_str());
                 Serial.print("BLE: Received new Target SOC: "); Serial.println(new_soc);
-                logic_save_config(current_v, current_a, new_soc);
+                config_set_charge_settings(current_v, current_a, new_soc);
             } 
             else if (uuid == BLEUUID(CHAR_MAX_CURRENT_UUID).toString()) {
                 float new_current_f = atof(value.c_str());
                 unsigned int new_current_ui = (unsigned int)(new_current_f * 10.0);
                 Serial.print("BLE: Received new Max Current: "); Serial.println(new_current_f);
-                logic_save_config(current_v, new_current_ui, current_soc);
+                config_set_charge_settings(current_v, new_current_ui, current_soc);
             }
         }
     }
@@ -0,0 +1,76 @@
+#include "CAN_BusHealth.h"
+#include "Config.h"
+#include "HAL/HAL.h"
+
+// 只由 CAN 任務寫入；其他任務讀取時可能看到跨欄位不一致的數值，僅供顯示
+static CAN_Bus_Health health;
+static uint32_t lastPollMs = 0;
+static bool recoveryStarted = false;
+
+void can_bus_health_init() {
+    memset(&health, 0, sizeof(health));
+    health.state = CAN_BUS_STOPPED;
+    lastPollMs = 0;
+    recoveryStarted = false;
+}
+
+void can_bus_health_poll() {
+    uint32_t now = millis();
+    if (lastPollMs != 0 && now - lastPollMs < CAN_BUS_HEALTH_POLL_MS) return;
+    lastPollMs = now;
+
+    HalCanStatus status;
+    if (!hal_can_get_status(&status)) {
+        health.state = CAN_BUS_STOPPED;
+        return;
+    }
+
+    // 遺失報文代表 CAN 任務來不及取出，0x500 可能因此被判定逾時
+    uint32_t missed = (status.rxMissed - health.rxMissed) + (status.rxOverrun - health.rxOverrun);
+    if (missed > 0) {
+        Serial.printf("CAN: %lu frame(s) lost (RX queue missed %lu, FIFO overrun %lu)\n",
+                      (unsigned long)missed, (unsigned long)status.rxMissed, (unsigned long)status.rxOverrun);
+    }
+
+    CanBusState previous = health.state;
+    health.txErrorCounter = (uint16_t)status.txErrorCounter;
+    health.rxErrorCounter = (uint16_t)status.rxErrorCounter;
+    health.errorPassive = status.txErrorCounter >= 128 || status.rxErrorCounter >= 128;
+    health.rxMissed = status.rxMissed;
+    health.rxOverrun = status.rxOverrun;
+    health.arbLost = status.arbLost;
+    health.busErrors = status.busErrors;
+    health.txFailed = status.txFailed;
+    health.state = status.state;
+
+    switch (status.state) {
+        case CAN_BUS_OFF:
+            if (previous != CAN_BUS_OFF && previous != CAN_BUS_RECOVERING) {
+                health.busOffCount++;
+                health.lastBusOffMs = now;
+                Serial.printf("!!! CAN: bus-off (TEC=%lu), starting recovery\n", (unsigned long)status.txErrorCounter);
+            }
+            if (hal_can_initiate_recovery()) {
+                recoveryStarted = true;
+                health.state = CAN_BUS_RECOVERING;
+            }
+            break;
+
+        case CAN_BUS_STOPPED:
+            // 只重啟由本模組恢復的控制器；驅動未啟動時不介入
+            if (recoveryStarted && hal_can_restart()) {
+                recoveryStarted = false;
+                health.recoveries++;
+                health.state = CAN_BUS_RUNNING;
+                Serial.printf("CAN: recovered from bus-off after %lu ms\n", (unsigned long)(now - health.lastBusOffMs));
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+CAN_Bus_Health can_bus_health_get() {
+    return health;
+}
@@ -0,0 +1,20 @@
+// src/CAN_Protocol/CAN_BusHealth.h
+// CAN 控制器健康監控：定期讀取 TEC/REC 與遺失報文計數，並在 bus-off 時自動恢復，
+// 避免一次接線干擾就讓控制器一直脫離匯流排直到重新開機。
+
+#ifndef CAN_BUS_HEALTH_H
+#define CAN_BUS_HEALTH_H
+
+#include <Arduino.h>
+#include "Charger_Defs.h"
+
+// 清除統計 (在 hal_init_can() 之後呼叫)
+void can_bus_health_init();
+
+// 在 CAN 任務中每次接收後調用，內部以 CAN_BUS_HEALTH_POLL_MS 限制讀取頻率。
+// bus-off 時啟動恢復程序，恢復完成 (控制器回到 STOPPED) 後重新啟動。
+void can_bus_health_poll();
+
+CAN_Bus_Health can_bus_health_get();
+
+#endif // CAN_BUS_HEALTH_H
@@ -0,0 +1,111 @@
+// src/CAN_Protocol/CAN_Codec.h
+// 以訊號描述 (起始位元組、寬度、位元組順序、比例) 在編譯期產生 CAN 報文的編碼/解碼函數。
+// 所有參數都是模板常數，展開後等同手寫的位移程式碼，沒有執行期查表。
+// 只使用 C++11 語法，ESP32 Arduino 核心預設的 gnu++11 也能編譯。
+
+#ifndef CAN_CODEC_H
+#define CAN_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+
+enum CanByteOrder {
+    CAN_LITTLE_ENDIAN,  // Intel：低位元組在前 (TES-0D-02-01 使用)
+    CAN_BIG_ENDIAN      // Motorola：高位元組在前
+};
+
+// --- 多位元組整數的讀寫，以模板遞迴展開 ---
+template <uint8_t Width, CanByteOrder Order, uint8_t I = 0>
+struct CanBytes {
+    static constexpr uint8_t offset = (Order == CAN_LITTLE_ENDIAN) ? I : (uint8_t)(Width - 1 - I);
+    static inline void put(uint8_t* d, uint32_t v) {
+        d[offset] = (uint8_t)(v >> (8 * I));
+        CanBytes<Width, Order, I + 1>::put(d, v);
+    }
+    static inline uint32_t get(const uint8_t* d) {
+        return ((uint32_t)d[offset] << (8 * I)) | CanBytes<Width, Order, I + 1>::get(d);
+    }
+};
+
+template <uint8_t Width, CanByteOrder Order>
+struct CanBytes<Width, Order, Width> {
+    static inline void put(uint8_t*, uint32_t) {}
+    static inline uint32_t get(const uint8_t*) { return 0; }
+};
+
+// --- 單一訊號 ---
+// 物理值 = 原始值 * ScaleNum / ScaleDen (例如 0.1V 單位為 1/10)
+template <typename Msg, typename T, T Msg::*Member, uint8_t StartByte, uint8_t Width,
+          CanByteOrder Order = CAN_LITTLE_ENDIAN, int32_t ScaleNum = 1, int32_t ScaleDen = 1>
+struct CanSignal {
+    static_assert(Width >= 1 && Width <= 4, "CAN signal width must be 1-4 bytes");
+    static_assert(StartByte + Width <= 8, "CAN signal exceeds 8 data bytes");
+    static_assert(sizeof(T) >= Width, "struct field is narrower than the CAN signal");
+
+    static constexpr uint8_t end = StartByte + Width;                          // 需要的最小 DLC
+    static constexpr uint8_t coverage = (uint8_t)(((1u << Width) - 1) << StartByte);  // 佔用的位元組遮罩
+
+    static inline void encode(const Msg& m, uint8_t* d) {
+        CanBytes<Width, Order>::put(d + StartByte, (uint32_t)(m.*Member));
+    }
+    static inline void decode(Msg& m, const uint8_t* d) {
+        m.*Member = (T)CanBytes<Width, Order>::get(d + StartByte);
+    }
+    static constexpr float to_physical(uint32_t raw) { return (float)raw * ScaleNum / ScaleDen; }
+};
+
+// 省去重複寫成員型別：CAN_SIGNAL(結構, 欄位, 起始位元組, 寬度 [, 位元組順序, 比例分子, 比例分母])
+#define CAN_SIGNAL(Msg, field, ...) CanSignal<Msg, decltype(Msg::field), &Msg::field, __VA_ARGS__>
+
+// --- 訊號列表 ---
+template <typename... Signals>
+struct CanSignalList;
+
+template <>
+struct CanSignalList<> {
+    static constexpr uint8_t end = 0;
+    static constexpr uint8_t coverage = 0;
+    template <typename Msg> static inline void encode(const Msg&, uint8_t*) {}
+    template <typename Msg> static inline void decode(Msg&, const uint8_t*, uint8_t) {}
+};
+
+template <typename S, typename... Rest>
+struct CanSignalList<S, Rest...> {
+    typedef CanSignalList<Rest...> Next;
+    static constexpr uint8_t end = S::end > Next::end ? S::end : Next::end;
+    static constexpr uint8_t coverage = S::coverage | Next::coverage;
+
+    template <typename Msg> static inline void encode(const Msg& m, uint8_t* d) {
+        S::encode(m, d);
+        Next::encode(m, d);
+    }
+    // 只解碼完整落在已收到長度內的訊號 (選填欄位在短報文中保持原值)
+    template <typename Msg> static inline void decode(Msg& m, const uint8_t* d, uint8_t len) {
+        if (len >= S::end) S::decode(m, d);
+        Next::decode(m, d, len);
+    }
+};
+
+// --- 報文 ---
+// MinLength：接受的最短 DLC，較短的報文整幀丟棄；發送時固定送 8 位元組，未定義的位元組補 0
+template <typename Msg, uint32_t Id, uint8_t MinLength, typename... Signals>
+struct CanMessage {
+    typedef Msg Type;
+    typedef CanSignalList<Signals...> List;
+    static constexpr uint32_t id = Id;
+    static constexpr uint8_t dlc = 8;
+    static constexpr uint8_t minLength = MinLength;
+    static_assert(MinLength <= 8, "CAN DLC is at most 8");
+
+    static inline void encode(const Msg& m, uint8_t* d) {
+        if (List::coverage != 0xFF) memset(d, 0, dlc);
+        List::encode(m, d);
+    }
+    static inline bool decode(Msg& m, const uint8_t* d, uint8_t len) {
+        if (len < MinLength) return false;
+        List::decode(m, d, len);
+        return true;
+    }
+};
+
+#endif // CAN_CODEC_H
@@ -1,100 +1,215 @@
 #include "CAN_Protocol.h"
 #include "HAL/HAL.h" // 翻譯部門需要和收發室(HAL)打交道
+#include "TES_Messages.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
 
-// --- 定義全局數據存儲變數的實體 ---
-CAN_Vehicle_Status_500 vehicleStatus500;
-CAN_Vehicle_Params_501 vehicleParams501;
-CAN_Vehicle_Emergency_5F0 vehicleEmergency5F0;
+#define CAN_SNAPSHOT_SPIN_LIMIT 8   // 連續撞上寫入這麼多次就讓出 CPU
 
+// --- 已解析的車輛數據 ---
+// rxState 只有 CAN 任務會存取；每批報文處理完後整份複製到 publishedState 發布。
+// publishedState 以 seqlock 保護：寫入期間序號為奇數，讀取端發現序號改變就重讀，因此不需要互斥鎖。
+static CAN_Vehicle_Snapshot rxState;
+static CAN_Vehicle_Snapshot publishedState;
+static std::atomic<uint32_t> publishSequence(0);
 
-void can_protocol_handle_receive() {
+// 只由 CAN 任務寫入，其他任務讀取時 32 位元讀寫本身是原子的
+static CAN_Rx_Counters rxCounters = {0, 0, 0};
+static uint32_t lastRxUs[VEHICLE_MSG_COUNT];
+
+// 記錄到達時間並更新間隔統計；中斷超過 CAN_VEHICLE_TIMEOUT_MS 的視為新的報文流，不計入平均與抖動
+static void record_rx_timing(VehicleCanMessage msg) {
+    CAN_Rx_Timing& t = rxState.timing[msg];
+    uint32_t nowUs = micros();
+    if (t.count > 0) {
+        uint32_t interval = nowUs - lastRxUs[msg];
+        if (interval > CAN_VEHICLE_TIMEOUT_MS * 1000) {
+            t.gaps++;
+            t.lastIntervalUs = 0;
+        } else {
+            if (t.lastIntervalUs == 0) {
+                t.meanIntervalUs = interval;
+            } else {
+                int32_t d = (int32_t)interval - (int32_t)t.lastIntervalUs;
+                if (d < 0) d = -d;
+                t.jitterUs += (d - (int32_t)t.jitterUs) / 16;
+                t.meanIntervalUs += ((int32_t)interval - (int32_t)t.meanIntervalUs) / 16;
+            }
+            if (interval > t.maxIntervalUs) t.maxIntervalUs = interval;
+            t.lastIntervalUs = interval;
+        }
+    }
+    lastRxUs[msg] = nowUs;
+    t.lastRxMs = millis();
+    t.count++;
+}
+
+uint32_t can_protocol_message_age_ms(const CAN_Vehicle_Snapshot& snapshot, VehicleCanMessage msg, uint32_t now_ms) {
+    const CAN_Rx_Timing& t = snapshot.timing[msg];
+    if (t.count == 0) return UINT32_MAX;
+    int32_t age = (int32_t)(now_ms - t.lastRxMs);
+    return age > 0 ? (uint32_t)age : 0;
+}
+
+static void publish_vehicle_state() {
+    uint32_t seq = publishSequence.load(std::memory_order_relaxed);
+    rxState.generation++;
+    publishSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&publishedState, &rxState, sizeof(CAN_Vehicle_Snapshot));
+    publishSequence.store(seq + 2, std::memory_order_release);
+}
+
+void can_protocol_get_vehicle_snapshot(CAN_Vehicle_Snapshot& snapshot) {
+    // 寫入者 (CAN 任務) 的複製只需數微秒，通常第一次就讀到一致的內容。重讀沒有次數上限，
+    // 但連續 CAN_SNAPSHOT_SPIN_LIMIT 次撞上寫入 (寫入者在另一個核心上被耽擱) 時讓出 CPU，不空轉
+    for (uint32_t attempt = 1;; attempt++) {
+        uint32_t before = publishSequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            memcpy(&snapshot, &publishedState, sizeof(CAN_Vehicle_Snapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (publishSequence.load(std::memory_order_relaxed) == before) return;
+        }
+        if (attempt % CAN_SNAPSHOT_SPIN_LIMIT == 0) vTaskDelay(1);
+    }
+}
+
+// --- 接收分派 ---
+// 每個處理函數解碼到 rxState，報文長度不足時回傳 false。
+typedef bool (*CanRxHandler)(const byte* buf, byte len, bool& safetyEvent);
+
+static bool on_vehicle_status(const byte* buf, byte len, bool& safetyEvent) {
+    byte previousFaultFlags = rxState.status.faultFlags;
+    if (!TES_VehicleStatus500::decode(rxState.status, buf, len)) return false;
+    // 故障旗標由無到有時才喚醒 Logic，避免持續故障時每幀都觸發
+    if (rxState.status.faultFlags != 0 && previousFaultFlags == 0) safetyEvent = true;
+    record_rx_timing(VEHICLE_MSG_500);
+    return true;
+}
+
+static bool on_vehicle_params(const byte* buf, byte len, bool& /* safetyEvent */) {
+    if (!TES_VehicleParams501::decode(rxState.params, buf, len)) return false;
+    record_rx_timing(VEHICLE_MSG_501);
+    return true;
+}
+
+static bool on_vehicle_emergency(const byte* buf, byte len, bool& safetyEvent) {
+    if (!TES_VehicleEmergency5F0::decode(rxState.emergency, buf, len)) return false;
+    if (rxState.emergency.errorRequestFlags & 0x01) {
+        rxState.emergencyCount++;
+        safetyEvent = true;
+    }
+    record_rx_timing(VEHICLE_MSG_5F0);
+    return true;
+}
+
+struct CanRxEntry {
+    uint32_t id;
+    CanRxHandler handler;
+};
+
+// 新增接收報文：在 TES_Messages.h 定義訊號後，於此登記
+static const CanRxEntry rxHandlers[] = {
+    { TES_VehicleStatus500::id,    on_vehicle_status },
+    { TES_VehicleParams501::id,    on_vehicle_params },
+    { TES_VehicleEmergency5F0::id, on_vehicle_emergency },
+};
+static const uint8_t RX_HANDLER_COUNT = sizeof(rxHandlers) / sizeof(rxHandlers[0]);
+static_assert(RX_HANDLER_COUNT < 0xFF, "too many CAN RX handlers");
+
+// 以 ID 的低 8 位元直接索引：0 = 無處理函數，RX_SLOT_SHARED = 多個 ID 共用 (退回逐一比對)，其他為索引 + 1
+#define RX_SLOT_SHARED 0xFF
+static uint8_t rxDispatch[256];
+
+static bool build_rx_dispatch() {
+    for (uint8_t i = 0; i < RX_HANDLER_COUNT; i++) {
+        uint8_t& slot = rxDispatch[rxHandlers[i].id & 0xFF];
+        slot = (slot == 0) ? (uint8_t)(i + 1) : (uint8_t)RX_SLOT_SHARED;
+    }
+    return true;
+}
+static const bool rxDispatchReady = build_rx_dispatch();
+
+static CanRxHandler find_rx_handler(uint32_t id) {
+    uint8_t slot = rxDispatch[id & 0xFF];
+    if (slot == 0) return NULL;
+    if (slot != RX_SLOT_SHARED) {
+        const CanRxEntry& entry = rxHandlers[slot - 1];
+        return entry.id == id ? entry.handler : NULL;
+    }
+    for (uint8_t i = 0; i < RX_HANDLER_COUNT; i++) {
+        if (rxHandlers[i].id == id) return rxHandlers[i].handler;
+    }
+    return NULL;
+}
+
+void can_protocol_handle_receive(uint32_t wait_ms) {
     unsigned long id;
     byte len;
     byte buf[8];
-    // 從收發室(HAL)獲取原始CAN報文
-    while (hal_can_receive(&id, &len, buf)) {
-    // 開始翻譯（解析）
-        if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            switch (id) {
-                case VEHICLE_STATUS_ID:
-                    if (len == 8) {
-                        vehicleStatus500.faultFlags = buf[0];
-                        vehicleStatus500.statusFlags = buf[1];
-                        vehicleStatus500.chargeCurrentCommand = (unsigned int)(buf[3] << 8 | buf[2]);
-                        vehicleStatus500.chargeVoltageLimit = (unsigned int)(buf[5] << 8 | buf[4]);
-                        vehicleStatus500.maxChargeVoltage = (unsigned int)(buf[7] << 8 | buf[6]);
-                    }
-                    break;
-                    
-                case VEHICLE_PARAMS_ID:
-                    if (len >= 4) {
-                         vehicleParams501.esChargeSequenceNumber = buf[0];
-                        vehicleParams501.stateOfCharge = buf[1];
-                        vehicleParams501.maxChargeTime = (uint16_t)(buf[3] << 8 | buf[2]);
-                        if (len >= 6) {
-                            vehicleParams501.estimatedChargeEndTime = (uint16_t)(buf[5] << 8 | buf[4]);
-                        }
-                    }
-                    break;
-
-                case VEHICLE_EMERGENCY_ID:
-                    if (len >= 1) {
-                        vehicleEmergency5F0.errorRequestFlags = buf[0];
-                    }
-                    break;
-            }
-            xSemaphoreGive(canDataMutex);
+    bool safetyEvent = false;
+    bool updated = false;
+    (void)rxDispatchReady;
+    // 從收發室(HAL)獲取原始CAN報文：第一幀阻塞等待，其餘不等待直接取完
+    while (hal_can_receive(&id, &len, buf, wait_ms)) {
+        wait_ms = 0;
+        rxCounters.received++;
+        // 開始翻譯（解析）
+        CanRxHandler handler = find_rx_handler(id);
+        if (handler != NULL && handler(buf, len, safetyEvent)) {
+            rxCounters.decoded++;
+            updated = true;
+        } else {
+            rxCounters.discarded++;
         }
     }
+    // 一批報文只發布一次，讀取端看到的 500/501/5F0 永遠來自同一批
+    if (updated) publish_vehicle_state();
+    if (safetyEvent && logicTaskHandle != NULL) {
+        xTaskNotifyGive(logicTaskHandle);
+    }
 }
 
 
-void can_protocol_send_charger_status(const CAN_Charger_Status_508& status) {
+CAN_Rx_Counters can_protocol_get_rx_counters() {
+    return rxCounters;
+}
+
+void can_protocol_send_charger_status(const CAN_Charger_Status_508& status, CanTxPriority priority) {
     byte data[8];
-    data[0] = status.faultFlags;
-    data[1] = status.statusFlags;
-    data[2] = status.availableVoltage & 0xFF;
-    data[3] = (status.availableVoltage >> 8) & 0xFF;
-    data[4] = status.availableCurrent & 0xFF;
-    data[5] = (status.availableCurrent >> 8) & 0xFF;
-    data[6] = status.faultDetectionVoltageLimit & 0xFF;
-    data[7] = (status.faultDetectionVoltageLimit >> 8) & 0xFF;
-    hal_can_send(CHARGER_STATUS_ID, data, 8);
+    TES_ChargerStatus508::encode(status, data);
+    can_tx_enqueue(TES_ChargerStatus508::id, data, TES_ChargerStatus508::dlc, priority);
 }
 
 void can_protocol_send_charger_params(const CAN_Charger_Params_509& params) {
     byte data[8];
-    data[0] = params.esChargeSequenceNumber;
-    data[1] = params.ratedOutputPower;
-    data[2] = params.actualOutputVoltage & 0xFF;
-    data[3] = (params.actualOutputVoltage >> 8) & 0xFF;
-    data[4] = params.actualOutputCurrent & 0xFF;
-    data[5] = (params.actualOutputCurrent >> 8) & 0xFF;
-    data[6] = params.remainingChargeTime & 0xFF;
-    data[7] = (params.remainingChargeTime >> 8) & 0xFF;
-    hal_can_send(CHARGER_PARAMS_ID, data, 8);
+    TES_ChargerParams509::encode(params, data);
+    can_tx_enqueue(TES_ChargerParams509::id, data, TES_ChargerParams509::dlc);
 }
 
 void can_protocol_send_emergency_stop(const CAN_Charger_Emergency_5F8& emergency) {
-    byte d[8] = {0};
-    d[0] = emergency.emergencyStopRequestFlags;
-    d[4] = emergency.chargerManufacturerID & 0xFF;
-    d[5] = (emergency.chargerManufacturerID >> 8) & 0xFF;
-    hal_can_send(CHARGER_EMERGENCY_STOP_ID, d, 8);
-}
-
-CAN_Vehicle_Status_500 can_protocol_get_vehicle_status() {
-    CAN_Vehicle_Status_500 status_snapshot;
-    
-    // 使用Mutex來保證線程安全地複製數據
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(20)) == pdTRUE) {
-        memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-        xSemaphoreGive(canDataMutex);
-    } else {
-        // 如果獲取鎖失敗，返回一個清零的結構體，防止上層使用髒數據
-        memset(&status_snapshot, 0, sizeof(CAN_Vehicle_Status_500));
-        Serial.println("WARN: Failed to get mutex in can_protocol_get_vehicle_status!");
-    }
-    
-    return status_snapshot;
-}
\ No newline at end of file
+    byte d[8];
+    TES_ChargerEmergency5F8::encode(emergency, d);
+    can_tx_enqueue(TES_ChargerEmergency5F8::id, d, TES_ChargerEmergency5F8::dlc, CAN_TX_PRIORITY_EMERGENCY);
+}
+
+void can_protocol_publish_periodic(const CAN_Charger_Status_508& status,
+                                   const CAN_Charger_Params_509& params,
+                                   const CAN_Charger_Emergency_5F8& emergency) {
+    CAN_Tx_Frame frames[3];
+    frames[0].id = TES_ChargerStatus508::id;
+    frames[0].len = TES_ChargerStatus508::dlc;
+    TES_ChargerStatus508::encode(status, frames[0].data);
+    frames[1].id = TES_ChargerParams509::id;
+    frames[1].len = TES_ChargerParams509::dlc;
+    TES_ChargerParams509::encode(params, frames[1].data);
+    frames[2].id = TES_ChargerEmergency5F8::id;
+    frames[2].len = TES_ChargerEmergency5F8::dlc;
+    TES_ChargerEmergency5F8::encode(emergency, frames[2].data);
+    can_tx_set_periodic(frames, 3);
+}
+
+void can_protocol_stop_periodic() {
+    can_tx_set_periodic(NULL, 0);
+}
@@ -4,23 +4,53 @@
 #include "Charger_Defs.h" // 引入公共定義
 #include "Config.h"       // 引入CAN ID等配置
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "CAN_TxScheduler.h"
 
-// --- 聲明全局的、已解析的數據存儲變數 ---
-// ChargerLogic 將從這裡讀取車輛的最新狀態
-extern SemaphoreHandle_t canDataMutex;
-extern CAN_Vehicle_Status_500 vehicleStatus500;
-extern CAN_Vehicle_Params_501 vehicleParams501;
-extern CAN_Vehicle_Emergency_5F0 vehicleEmergency5F0;
+extern TaskHandle_t logicTaskHandle;
+
+// --- 已解析的車輛數據快照 ---
+// CAN 任務是唯一的寫入者；讀取端不加鎖也不會阻塞，每次取得的 500/501/5F0 彼此一致。
+struct CAN_Vehicle_Snapshot {
+    CAN_Vehicle_Status_500 status;
+    CAN_Vehicle_Params_501 params;
+    CAN_Vehicle_Emergency_5F0 emergency;
+    uint32_t generation;      // 每次發布新數據 +1
+    uint32_t emergencyCount;  // 累計收到的緊急停止請求 (0x5F0 bit0)；讀取端比較此值，不再清除旗標
+    CAN_Rx_Timing timing[VEHICLE_MSG_COUNT];
+};
+
+// 距離該報文上次接收的時間 (應在取得快照之後才讀 millis())，從未收到時回傳 UINT32_MAX
+uint32_t can_protocol_message_age_ms(const CAN_Vehicle_Snapshot& snapshot, VehicleCanMessage msg, uint32_t now_ms);
+
+// --- 接收統計 ---
+// 被硬體濾波器擋下的報文不會產生中斷，控制器也不計數；
+// 若要量測匯流排上無關報文的數量，可開啟 CAN_ACCEPT_ALL_FRAMES，此時 discarded 即為硬體濾波器會擋下的量。
+struct CAN_Rx_Counters {
+    uint32_t received;   // 通過硬體濾波器、進入軟體的報文數
+    uint32_t decoded;    // 成功解析的報文數
+    uint32_t discarded;  // 在軟體中丟棄的報文數 (非車輛 ID 或長度錯誤)
+};
 
 // --- 公開的API函數 ---
-void can_protocol_handle_receive(); // 在主循環中調用，處理接收
+// 在 CAN 任務中調用：最多阻塞 wait_ms 等待第一幀，之後把驅動佇列中的報文全部處理完。
+// 收到安全相關報文 (0x5F0 緊急停止、0x500 故障旗標) 時會立即通知 Logic 任務。
+void can_protocol_handle_receive(uint32_t wait_ms = 0);
 
-CAN_Vehicle_Status_500 can_protocol_get_vehicle_status();
+void can_protocol_get_vehicle_snapshot(CAN_Vehicle_Snapshot& snapshot);
+CAN_Rx_Counters can_protocol_get_rx_counters();
 
 // --- 發送函數 ---
-void can_protocol_send_charger_status(const CAN_Charger_Status_508& status);
+// 只把報文放入 CAN_TxScheduler 的佇列，不會阻塞呼叫端；緊急停止報文一律插隊優先發送
+void can_protocol_send_charger_status(const CAN_Charger_Status_508& status,
+                                      CanTxPriority priority = CAN_TX_PRIORITY_NORMAL);
 void can_protocol_send_charger_params(const CAN_Charger_Params_509& params);
 void can_protocol_send_emergency_stop(const CAN_Charger_Emergency_5F8& emergency);
 
+// 更新 0x508/0x509/0x5F8 週期報文的內容，由排程器以 PERIODIC_SEND_INTERVAL 的節拍發送
+void can_protocol_publish_periodic(const CAN_Charger_Status_508& status,
+                                   const CAN_Charger_Params_509& params,
+                                   const CAN_Charger_Emergency_5F8& emergency);
+void can_protocol_stop_periodic();
+
 #endif // CAN_PROTOCOL_H
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "CAN_Trace.h"
+#include "Config.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+#include <time.h>
+
+static_assert((CAN_TRACE_CAPACITY & (CAN_TRACE_CAPACITY - 1)) == 0, "CAN_TRACE_CAPACITY must be a power of two");
+static_assert(CAN_TRACE_PRE_TRIGGER + CAN_TRACE_POST_TRIGGER < CAN_TRACE_CAPACITY, "fault window must fit in the trace ring");
+static_assert(sizeof(CAN_Trace_Entry) == 16, "CAN_Trace_Entry should stay 16 bytes");
+
+#define CAN_TRACE_TAG_TX 0x80
+#define CAN_TRACE_FAULT_CAPACITY (CAN_TRACE_PRE_TRIGGER + CAN_TRACE_POST_TRIGGER)
+
+// --- 常駐環形緩衝 ---
+// 索引只增不減，位置為 index % CAPACITY。RX 與 TX 任務可能在不同核心同時寫入，以原子遞增分配位置；
+// 每幀的 tag 記錄寫入輪次，讀取端據此判斷該位置是否仍是預期的那一幀 (未被覆寫、不在寫入中)。
+static CAN_Trace_Entry* ring = NULL;
+static std::atomic<uint32_t> writeIndex(0);
+static bool ringInPsram = false;
+
+// --- 故障視窗 ---
+// 觸發由 Logic 任務寫入，複製由 can_trace_service() 完成，狀態以臨界區保護。
+// 視窗另存後保留到被完整下載或清除為止，期間的觸發只計數，避免按住急停時被之後平靜的報文取代。
+// 複製前先遞增 faultGeneration，下載中的游標在讀出每一幀後檢查，不會輸出新舊混雜的內容。
+static CAN_Trace_Entry* faultBuf = NULL;
+static uint32_t faultCount = 0;
+static std::atomic<uint32_t> faultGeneration(0);
+static bool faultValid = false;
+static bool faultHeld = false;
+static bool captureArmed = false;
+static uint32_t triggerIndex = 0;
+static uint32_t triggerMs = 0;
+static CanTraceTrigger pendingTrigger = CAN_TRACE_TRIGGER_NONE;
+static CanTraceTrigger capturedTrigger = CAN_TRACE_TRIGGER_NONE;
+static uint32_t capturedTriggerMs = 0;
+static uint32_t capturedTriggerUs = 0;
+static uint32_t triggerUs = 0;
+static uint32_t triggerCount = 0;
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint8_t lap_tag(uint32_t index) {
+    return (uint8_t)((index / CAN_TRACE_CAPACITY) % 127 + 1);
+}
+
+static void* trace_alloc(size_t bytes, bool& inPsram) {
+#if defined(BOARD_HAS_PSRAM) && !defined(SIM_NATIVE)
+    void* p = ps_calloc(1, bytes);
+    if (p != NULL) {
+        inPsram = true;
+        return p;
+    }
+#endif
+    inPsram = false;
+    return calloc(1, bytes);
+}
+
+void can_trace_init() {
+    if (ring != NULL) return;
+    bool faultInPsram = false;
+    ring = (CAN_Trace_Entry*)trace_alloc(CAN_TRACE_CAPACITY * sizeof(CAN_Trace_Entry), ringInPsram);
+    faultBuf = (CAN_Trace_Entry*)trace_alloc(CAN_TRACE_FAULT_CAPACITY * sizeof(CAN_Trace_Entry), faultInPsram);
+    if (ring == NULL || faultBuf == NULL) {
+        free(ring);
+        free(faultBuf);
+        ring = NULL;
+        faultBuf = NULL;
+        Serial.println("CAN Trace: buffer allocation FAILED, recording disabled.");
+        return;
+    }
+    Serial.printf("CAN Trace: %lu frames in %s, fault window %lu + %lu frames.\n",
+                  (unsigned long)CAN_TRACE_CAPACITY, ringInPsram ? "PSRAM" : "internal RAM",
+                  (unsigned long)CAN_TRACE_PRE_TRIGGER, (unsigned long)CAN_TRACE_POST_TRIGGER);
+}
+
+void can_trace_record(CanTraceDirection direction, uint32_t id, const uint8_t* data, uint8_t len) {
+    if (ring == NULL) return;
+    if (len > 8) len = 8;
+    uint32_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    CAN_Trace_Entry& e = ring[index & (CAN_TRACE_CAPACITY - 1)];
+    e.tag = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    e.timestampUs = micros();
+    e.id = (uint16_t)id;
+    e.len = len;
+    memcpy(e.data, data, len);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.tag = lap_tag(index) | (direction == CAN_TRACE_TX ? CAN_TRACE_TAG_TX : 0);
+}
+
+// 複製 index 對應的幀；已被覆寫或仍在寫入中時回傳 false
+static bool read_ring_entry(uint32_t index, CAN_Trace_Entry& out) {
+    const CAN_Trace_Entry& e = ring[index & (CAN_TRACE_CAPACITY - 1)];
+    uint8_t tag = e.tag;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((tag & 0x7F) != lap_tag(index)) return false;
+    memcpy(&out, &e, sizeof(CAN_Trace_Entry));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return e.tag == tag;
+}
+
+void can_trace_trigger(CanTraceTrigger reason) {
+    if (ring == NULL) return;
+    portENTER_CRITICAL(&traceMux);
+    triggerCount++;
+    // 視窗記錄中或尚未下載時再次觸發 (例如故障後接著緊急停止) 保留第一個觸發點
+    if (!captureArmed && !faultHeld) {
+        captureArmed = true;
+        triggerIndex = writeIndex.load(std::memory_order_relaxed);
+        triggerMs = millis();
+        triggerUs = micros();
+        pendingTrigger = reason;
+    }
+    portEXIT_CRITICAL(&traceMux);
+}
+
+void can_trace_service() {
+    if (ring == NULL) return;
+    portENTER_CRITICAL(&traceMux);
+    bool armed = captureArmed;
+    uint32_t trigger = triggerIndex;
+    uint32_t armedAtMs = triggerMs;
+    portEXIT_CRITICAL(&traceMux);
+    if (!armed) return;
+
+    uint32_t head = writeIndex.load(std::memory_order_acquire);
+    if (head - trigger < CAN_TRACE_POST_TRIGGER && millis() - armedAtMs < CAN_TRACE_POST_TRIGGER_MS) return;
+
+    uint32_t end = (head - trigger < CAN_TRACE_POST_TRIGGER) ? head : trigger + CAN_TRACE_POST_TRIGGER;
+    uint32_t start = (trigger > CAN_TRACE_PRE_TRIGGER) ? trigger - CAN_TRACE_PRE_TRIGGER : 0;
+    portENTER_CRITICAL(&traceMux);
+    faultValid = false;
+    faultCount = 0;
+    faultGeneration.fetch_add(1, std::memory_order_release);
+    portEXIT_CRITICAL(&traceMux);
+    uint32_t count = 0;
+    for (uint32_t i = start; i != end; i++) {
+        if (read_ring_entry(i, faultBuf[count])) count++;
+    }
+
+    portENTER_CRITICAL(&traceMux);
+    faultCount = count;
+    faultValid = true;
+    faultHeld = count > 0;
+    faultGeneration.fetch_add(1, std::memory_order_release);
+    capturedTrigger = pendingTrigger;
+    capturedTriggerMs = triggerMs;
+    capturedTriggerUs = triggerUs;
+    captureArmed = false;
+    portEXIT_CRITICAL(&traceMux);
+    Serial.printf("CAN Trace: fault window saved (%lu frames).\n", (unsigned long)count);
+}
+
+void can_trace_clear_fault() {
+    if (ring == NULL) return;
+    portENTER_CRITICAL(&traceMux);
+    faultValid = false;
+    faultHeld = false;
+    faultCount = 0;
+    faultGeneration.fetch_add(1, std::memory_order_release);
+    capturedTrigger = CAN_TRACE_TRIGGER_NONE;
+    portEXIT_CRITICAL(&traceMux);
+}
+
+CAN_Trace_Status can_trace_get_status() {
+    CAN_Trace_Status status;
+    status.ready = ring != NULL;
+    status.inPsram = ringInPsram;
+    status.capacity = CAN_TRACE_CAPACITY;
+    status.recorded = writeIndex.load(std::memory_order_relaxed);
+    portENTER_CRITICAL(&traceMux);
+    status.captureArmed = captureArmed;
+    status.faultCaptured = faultValid;
+    status.faultHeld = faultHeld;
+    status.lastTrigger = capturedTrigger;
+    status.faultFrames = faultCount;
+    status.faultTriggerMs = capturedTriggerMs;
+    status.triggers = triggerCount;
+    portEXIT_CRITICAL(&traceMux);
+    return status;
+}
+
+// =================================================================
+// =                            匯出                               =
+// =================================================================
+
+#define CAN_TRACE_MAX_LINE 96
+
+void can_trace_open(CAN_Trace_Cursor& cursor, CanTraceSource source, CanTraceFormat format) {
+    memset(&cursor, 0, sizeof(cursor));
+    cursor.source = source;
+    cursor.format = format;
+    if (ring == NULL) {
+        cursor.stage = 3;
+        return;
+    }
+    if (source == CAN_TRACE_SOURCE_LIVE) {
+        cursor.end = writeIndex.load(std::memory_order_acquire);
+        cursor.next = (cursor.end > CAN_TRACE_CAPACITY) ? cursor.end - CAN_TRACE_CAPACITY : 0;
+    } else {
+        portENTER_CRITICAL(&traceMux);
+        cursor.end = faultValid ? faultCount : 0;
+        cursor.generation = faultGeneration.load(std::memory_order_relaxed);
+        portEXIT_CRITICAL(&traceMux);
+        cursor.next = 0;
+    }
+    // candump -l 沒有檔頭
+    cursor.stage = (format == CAN_TRACE_FORMAT_ASC) ? 0 : 1;
+}
+
+static size_t format_header(const CAN_Trace_Cursor& cursor, char* line) {
+    size_t n = 0;
+    time_t now = time(NULL);
+    // 尚未透過 NTP 對時的話不輸出日期，讀取端會改用相對時間
+    if (now > 1600000000) {
+        struct tm t;
+        localtime_r(&now, &t);
+        n += strftime(line + n, CAN_TRACE_MAX_LINE * 3 - n, "date %a %b %d %I:%M:%S.000 %p %Y\n", &t);
+    }
+    n += snprintf(line + n, CAN_TRACE_MAX_LINE * 3 - n, "base hex  timestamps absolute\nno internal events logged\n");
+    if (cursor.source == CAN_TRACE_SOURCE_FAULT) {
+        n += snprintf(line + n, CAN_TRACE_MAX_LINE * 3 - n, "// fault window, trigger %s at %lu.%06lu s uptime\n",
+                      capturedTrigger == CAN_TRACE_TRIGGER_EMERGENCY ? "emergency stop" : "fault",
+                      (unsigned long)(capturedTriggerUs / 1000000), (unsigned long)(capturedTriggerUs % 1000000));
+    }
+    n += snprintf(line + n, CAN_TRACE_MAX_LINE * 3 - n, "Begin Triggerblock\n");
+    return n;
+}
+
+static size_t format_entry(CAN_Trace_Cursor& cursor, const CAN_Trace_Entry& e, char* line) {
+    // micros() 約 71 分鐘溢位一次，依順序展開為 64 位元
+    if (cursor.haveFirst && e.timestampUs < cursor.lastUs) cursor.wraps++;
+    cursor.lastUs = e.timestampUs;
+    uint64_t us = ((uint64_t)cursor.wraps << 32) | e.timestampUs;
+    if (!cursor.haveFirst) {
+        cursor.haveFirst = true;
+        cursor.firstUs = us;
+    }
+
+    size_t n;
+    bool tx = (e.tag & CAN_TRACE_TAG_TX) != 0;
+    if (cursor.format == CAN_TRACE_FORMAT_CANDUMP) {
+        n = snprintf(line, CAN_TRACE_MAX_LINE, "(%lu.%06lu) can0 %03X#",
+                     (unsigned long)(us / 1000000), (unsigned long)(us % 1000000), (unsigned)e.id);
+        for (uint8_t i = 0; i < e.len; i++) n += snprintf(line + n, CAN_TRACE_MAX_LINE - n, "%02X", e.data[i]);
+    } else {
+        uint64_t rel = us - cursor.firstUs;
+        n = snprintf(line, CAN_TRACE_MAX_LINE, "%4lu.%06lu 1  %-15X %s   d %u",
+                     (unsigned long)(rel / 1000000), (unsigned long)(rel % 1000000), (unsigned)e.id,
+                     tx ? "Tx" : "Rx", (unsigned)e.len);
+        for (uint8_t i = 0; i < e.len; i++) n += snprintf(line + n, CAN_TRACE_MAX_LINE - n, " %02X", e.data[i]);
+    }
+    line[n++] = '\n';
+    return n;
+}
+
+// 故障視窗已完整下載：之後的觸發可以另存新的視窗
+static void release_fault(CAN_Trace_Cursor& cursor) {
+    portENTER_CRITICAL(&traceMux);
+    if (cursor.next == cursor.end && cursor.generation == faultGeneration.load(std::memory_order_relaxed)) {
+        faultHeld = false;
+    }
+    portEXIT_CRITICAL(&traceMux);
+    cursor.end = 0;   // 只釋放一次
+}
+
+size_t can_trace_read(CAN_Trace_Cursor& cursor, char* out, size_t max_len) {
+    char line[CAN_TRACE_MAX_LINE * 3];
+    size_t written = 0;
+    while (cursor.stage < 3) {
+        size_t n = 0;
+        if (cursor.stage == 0) {
+            n = format_header(cursor, line);
+            if (written + n > max_len) break;
+            cursor.stage = 1;
+        } else if (cursor.stage == 1) {
+            if (cursor.next == cursor.end) {
+                cursor.stage = (cursor.format == CAN_TRACE_FORMAT_ASC) ? 2 : 3;
+                continue;
+            }
+            CAN_Trace_Entry e;
+            if (cursor.source == CAN_TRACE_SOURCE_LIVE) {
+                if (!read_ring_entry(cursor.next, e)) {  // 下載期間已被新報文覆寫
+                    cursor.next++;
+                    continue;
+                }
+            } else {
+                e = faultBuf[cursor.next];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (cursor.generation != faultGeneration.load(std::memory_order_relaxed)) {  // 下載期間被清除或取代
+                    cursor.stage = 3;
+                    break;
+                }
+            }
+            CAN_Trace_Cursor saved = cursor;
+            n = format_entry(cursor, e, line);
+            if (written + n > max_len) {
+                cursor = saved;
+                break;
+            }
+            cursor.next++;
+        } else {
+            n = snprintf(line, sizeof(line), "End TriggerBlock\n");
+            if (written + n > max_len) break;
+            cursor.stage = 3;
+        }
+        memcpy(out + written, line, n);
+        written += n;
+    }
+    if (cursor.stage == 3 && cursor.source == CAN_TRACE_SOURCE_FAULT && cursor.end > 0) release_fault(cursor);
+    return written;
+}
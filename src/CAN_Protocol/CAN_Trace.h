@@ -0,0 +1,91 @@
+// src/CAN_Protocol/CAN_Trace.h
+// CAN 報文記錄器：HAL 收發的每一幀都以微秒時間戳寫入常駐的環形緩衝 (有 PSRAM 時放在 PSRAM)，
+// 發生故障 (ch_sub_10 / ch_sub_12) 時把前後一段視窗另存一份，可由網頁下載為 candump -l 或 Vector ASC 格式。
+// 另存的視窗保留到被完整下載或以 can_trace_clear_fault() 清除為止，期間的觸發不會取代它。
+// 寫入只需一次原子遞增與 16 bytes 複製，可在滿載匯流排上常駐開啟。
+
+#ifndef CAN_TRACE_H
+#define CAN_TRACE_H
+
+#include <Arduino.h>
+
+enum CanTraceDirection : uint8_t {
+    CAN_TRACE_RX,
+    CAN_TRACE_TX
+};
+
+enum CanTraceTrigger : uint8_t {
+    CAN_TRACE_TRIGGER_NONE,
+    CAN_TRACE_TRIGGER_FAULT,      // ch_sub_10 (故障)
+    CAN_TRACE_TRIGGER_EMERGENCY   // ch_sub_12
+};
+
+enum CanTraceSource : uint8_t {
+    CAN_TRACE_SOURCE_LIVE,   // 常駐緩衝中目前的內容
+    CAN_TRACE_SOURCE_FAULT   // 最近一次故障視窗
+};
+
+enum CanTraceFormat : uint8_t {
+    CAN_TRACE_FORMAT_CANDUMP, // candump -l：(秒.微秒) can0 500#0011...
+    CAN_TRACE_FORMAT_ASC      // Vector ASC，時間從第一幀起算
+};
+
+struct CAN_Trace_Entry {
+    uint32_t timestampUs;  // micros()
+    uint16_t id;           // 標準幀 ID
+    uint8_t len;
+    uint8_t tag;           // bit7 = 方向 (1 = TX)，bit6-0 = 寫入輪次 (1..127)，0 表示寫入中
+    uint8_t data[8];
+};
+
+struct CAN_Trace_Status {
+    bool ready;                 // 緩衝已配置
+    bool inPsram;
+    uint32_t capacity;
+    uint32_t recorded;          // 開機以來記錄的幀數
+    bool captureArmed;          // 已觸發，正在記錄故障後的幀
+    bool faultCaptured;         // 故障視窗可供下載
+    bool faultHeld;             // 視窗尚未下載，新的觸發不另存
+    CanTraceTrigger lastTrigger;
+    uint32_t faultFrames;
+    uint32_t faultTriggerMs;    // 觸發時的 millis()
+    uint32_t triggers;          // 累計觸發次數 (視窗記錄中或保留中再次觸發不另存)
+};
+
+// 配置緩衝，在 hal_init_can() 之前呼叫；配置失敗時記錄功能停用
+void can_trace_init();
+
+// 由 HAL 在報文成功收發後呼叫 (CAN RX/TX 任務)
+void can_trace_record(CanTraceDirection direction, uint32_t id, const uint8_t* data, uint8_t len);
+
+// 標記故障時間點；再記錄 CAN_TRACE_POST_TRIGGER 幀後由 can_trace_service() 另存視窗
+void can_trace_trigger(CanTraceTrigger reason);
+
+// 在低優先級任務中定期呼叫，負責把完成的故障視窗複製出來 (不佔用 CAN 任務的時間)
+void can_trace_service();
+
+// 捨棄目前的故障視窗，下一次觸發重新記錄；下載中的游標隨即停止
+void can_trace_clear_fault();
+
+CAN_Trace_Status can_trace_get_status();
+
+// --- 匯出 ---
+// 以游標逐段輸出文字，每次只輸出完整的行，適合網頁伺服器的 chunked response
+struct CAN_Trace_Cursor {
+    CanTraceSource source;
+    CanTraceFormat format;
+    uint8_t stage;         // 0 = 檔頭，1 = 報文，2 = 檔尾，3 = 結束
+    uint32_t next;         // 下一幀的索引
+    uint32_t end;
+    uint32_t generation;   // 故障視窗被清除或取代時停止輸出
+    uint64_t firstUs;      // ASC 的時間零點
+    uint32_t lastUs;
+    uint32_t wraps;        // micros() 溢位次數 (每次 2^32 us，約 71 分鐘)
+    bool haveFirst;
+};
+
+void can_trace_open(CAN_Trace_Cursor& cursor, CanTraceSource source, CanTraceFormat format);
+// 寫入最多 max_len bytes，回傳 0 表示結束
+size_t can_trace_read(CAN_Trace_Cursor& cursor, char* out, size_t max_len);
+
+#endif // CAN_TRACE_H
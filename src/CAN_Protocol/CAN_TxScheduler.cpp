@@ -0,0 +1,186 @@
+#include "CAN_TxScheduler.h"
+#include "Config.h"
+#include "HAL/HAL.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define CAN_TX_FLAG_PERIODIC     0x01
+#define CAN_TX_FLAG_PERIOD_START 0x02  // 每個週期的第一幀，用來量測發送間隔
+#define CAN_TX_FLAG_WAKE         0x04  // 不發送：緊急報文已放入 urgentQueue，喚醒等待中的 TX 任務
+
+struct CAN_Tx_QueueItem {
+    CAN_Tx_Frame frame;
+    uint8_t flags;
+    uint32_t generation;   // 週期報文：放入佇列時的 periodicGeneration
+    uint32_t queuedAtUs;
+};
+
+// 緊急報文另有一個 FIFO 佇列，TX 任務每次先取這裡：排在所有一般報文之前，彼此之間維持呼叫順序
+static QueueHandle_t txQueue = NULL;
+static QueueHandle_t urgentQueue = NULL;
+static portMUX_TYPE txMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 週期報文內容由 Logic 任務更新、由計時器讀取，以臨界區保護。
+// 停止週期發送時遞增 periodicGeneration，已在佇列中的舊週期報文取出時直接丟棄
+static CAN_Tx_Frame periodicFrames[CAN_TX_MAX_PERIODIC_FRAMES];
+static uint8_t periodicCount = 0;
+static uint8_t periodicInFlight = 0;    // 已放入佇列但尚未送出的週期報文數
+static uint32_t periodicGeneration = 0;
+static uint32_t lastPeriodicStartUs = 0; // 上一週期第一幀送出的時間，0 表示尚無參考點
+
+// 計時器、Logic 與 CAN TX 任務可能在不同核心同時更新，統計一律在 txMux 內讀寫
+static CAN_Tx_Stats txStats;
+
+void can_tx_init() {
+    if (txQueue == NULL) {
+        txQueue = xQueueCreate(CAN_TX_QUEUE_LEN, sizeof(CAN_Tx_QueueItem));
+        urgentQueue = xQueueCreate(CAN_TX_URGENT_QUEUE_LEN, sizeof(CAN_Tx_QueueItem));
+        if (txQueue == NULL || urgentQueue == NULL) {
+            Serial.println("FATAL: Failed to create CAN TX queue!");
+            while (1);
+        }
+    } else {
+        xQueueReset(txQueue);
+        xQueueReset(urgentQueue);
+    }
+    portENTER_CRITICAL(&txMux);
+    periodicCount = 0;
+    periodicInFlight = 0;
+    periodicGeneration = 0;
+    lastPeriodicStartUs = 0;
+    memset(&txStats, 0, sizeof(txStats));
+    portEXIT_CRITICAL(&txMux);
+}
+
+static bool enqueue_item(const CAN_Tx_QueueItem& item, CanTxPriority priority) {
+    if (priority == CAN_TX_PRIORITY_EMERGENCY) {
+        if (xQueueSendToBack(urgentQueue, &item, 0) == pdPASS) {
+            // 佇列已滿時 TX 任務本來就不會等待，喚醒失敗不影響
+            CAN_Tx_QueueItem wake;
+            memset(&wake, 0, sizeof(wake));
+            wake.flags = CAN_TX_FLAG_WAKE;
+            xQueueSendToFront(txQueue, &wake, 0);
+            return true;
+        }
+    } else if (xQueueSendToBack(txQueue, &item, 0) == pdPASS) {
+        return true;
+    }
+    portENTER_CRITICAL(&txMux);
+    txStats.queueFull++;
+    portEXIT_CRITICAL(&txMux);
+    return false;
+}
+
+bool can_tx_enqueue(uint32_t id, const uint8_t* data, uint8_t len, CanTxPriority priority) {
+    if (txQueue == NULL || len > 8) return false;
+    CAN_Tx_QueueItem item;
+    item.frame.id = id;
+    item.frame.len = len;
+    memcpy(item.frame.data, data, len);
+    item.flags = 0;
+    item.queuedAtUs = micros();
+    return enqueue_item(item, priority);
+}
+
+void can_tx_set_periodic(const CAN_Tx_Frame* frames, uint8_t count) {
+    if (count > CAN_TX_MAX_PERIODIC_FRAMES) count = CAN_TX_MAX_PERIODIC_FRAMES;
+    portENTER_CRITICAL(&txMux);
+    if (count > 0) {
+        memcpy(periodicFrames, frames, count * sizeof(CAN_Tx_Frame));
+    } else if (periodicCount > 0 || periodicInFlight > 0) {
+        // 停止：佇列中尚未送出的週期報文作廢 (例如緊急停止後不能再送出舊的 0x508)
+        periodicGeneration++;
+        periodicInFlight = 0;
+        lastPeriodicStartUs = 0;
+    }
+    periodicCount = count;
+    portEXIT_CRITICAL(&txMux);
+}
+
+void can_tx_periodic_tick() {
+    if (txQueue == NULL) return;
+    CAN_Tx_Frame frames[CAN_TX_MAX_PERIODIC_FRAMES];
+    uint8_t count;
+    bool busy;
+    uint32_t generation;
+
+    portENTER_CRITICAL(&txMux);
+    count = periodicCount;
+    busy = periodicInFlight > 0;
+    generation = periodicGeneration;
+    if (count > 0 && !busy) {
+        memcpy(frames, periodicFrames, count * sizeof(CAN_Tx_Frame));
+        periodicInFlight = count;
+    }
+    // 上一週期還卡在佇列裡 (匯流排壅塞)：不再堆積過時的報文
+    if (count > 0 && busy) txStats.periodsSkipped++;
+    portEXIT_CRITICAL(&txMux);
+
+    if (count == 0 || busy) return;
+
+    CAN_Tx_QueueItem item;
+    item.generation = generation;
+    item.queuedAtUs = micros();
+    for (uint8_t i = 0; i < count; i++) {
+        item.frame = frames[i];
+        item.flags = CAN_TX_FLAG_PERIODIC | (i == 0 ? CAN_TX_FLAG_PERIOD_START : 0);
+        if (!enqueue_item(item, CAN_TX_PRIORITY_NORMAL)) {
+            portENTER_CRITICAL(&txMux);
+            if (generation == periodicGeneration) periodicInFlight -= (count - i);
+            portEXIT_CRITICAL(&txMux);
+            break;
+        }
+    }
+}
+
+bool can_tx_handle_transmit(uint32_t wait_ms) {
+    if (txQueue == NULL) return false;
+    CAN_Tx_QueueItem item;
+    if (xQueueReceive(urgentQueue, &item, 0) != pdTRUE) {
+        if (xQueueReceive(txQueue, &item, pdMS_TO_TICKS(wait_ms)) != pdTRUE) {
+            return false;
+        }
+        // 喚醒標記：緊急報文可能已在前一次呼叫送出
+        if ((item.flags & CAN_TX_FLAG_WAKE) && xQueueReceive(urgentQueue, &item, 0) != pdTRUE) {
+            return true;
+        }
+    }
+
+    uint32_t now = micros();
+    uint32_t latency = now - item.queuedAtUs;
+
+    portENTER_CRITICAL(&txMux);
+    if (item.flags & CAN_TX_FLAG_PERIODIC) {
+        if (item.generation != periodicGeneration) {
+            // 週期發送已停止，這幀是停止前放入的
+            txStats.periodicDropped++;
+            portEXIT_CRITICAL(&txMux);
+            return true;
+        }
+        if (periodicInFlight > 0) periodicInFlight--;
+        if (item.flags & CAN_TX_FLAG_PERIOD_START) {
+            if (lastPeriodicStartUs != 0) {
+                int32_t jitter = (int32_t)(now - lastPeriodicStartUs) - (int32_t)(PERIODIC_SEND_INTERVAL * 1000);
+                uint32_t absJitter = (uint32_t)(jitter < 0 ? -jitter : jitter);
+                if (absJitter > txStats.maxPeriodJitterUs) txStats.maxPeriodJitterUs = absJitter;
+            }
+            lastPeriodicStartUs = now;
+        }
+    }
+    if (latency > txStats.maxQueueLatencyUs) txStats.maxQueueLatencyUs = latency;
+    portEXIT_CRITICAL(&txMux);
+
+    bool sent = hal_can_send(item.frame.id, item.frame.data, item.frame.len, CAN_TX_TIMEOUT_MS);
+    portENTER_CRITICAL(&txMux);
+    if (sent) txStats.sent++;
+    else txStats.failed++;
+    portEXIT_CRITICAL(&txMux);
+    return true;
+}
+
+CAN_Tx_Stats can_tx_get_stats() {
+    portENTER_CRITICAL(&txMux);
+    CAN_Tx_Stats stats = txStats;
+    portEXIT_CRITICAL(&txMux);
+    return stats;
+}
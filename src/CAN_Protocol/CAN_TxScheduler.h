@@ -0,0 +1,50 @@
+// src/CAN_Protocol/CAN_TxScheduler.h
+// CAN 發送排程器：呼叫端只把報文放進佇列，不會被 twai_transmit 阻塞；
+// 實際發送由專屬的 CAN TX 任務完成，0x508/0x509/0x5F8 的週期由 esp_timer 觸發。
+
+#ifndef CAN_TX_SCHEDULER_H
+#define CAN_TX_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define CAN_TX_MAX_PERIODIC_FRAMES 3
+
+enum CanTxPriority {
+    CAN_TX_PRIORITY_NORMAL,    // 排在佇列尾端
+    CAN_TX_PRIORITY_EMERGENCY  // 排在所有一般報文之前；緊急報文之間依呼叫順序送出
+};
+
+struct CAN_Tx_Frame {
+    uint32_t id;
+    uint8_t len;
+    uint8_t data[8];
+};
+
+struct CAN_Tx_Stats {
+    uint32_t sent;
+    uint32_t failed;             // 驅動在 CAN_TX_TIMEOUT_MS 內無法接收 (匯流排壅塞或無 ACK)
+    uint32_t queueFull;          // 佇列已滿而丟棄的報文
+    uint32_t periodsSkipped;     // 上一週期的報文尚未送完，本週期略過
+    uint32_t periodicDropped;    // 週期發送停止時仍在佇列中、因此不送出的報文
+    uint32_t maxQueueLatencyUs;  // 報文從進入佇列到交給驅動的最長時間
+    uint32_t maxPeriodJitterUs;  // 週期報文實際發送間隔與 PERIODIC_SEND_INTERVAL 的最大偏差
+};
+
+// 建立發送佇列並清除統計 (重複呼叫時只清空佇列)
+void can_tx_init();
+
+// 非阻塞：佇列已滿時直接丟棄並回傳 false
+bool can_tx_enqueue(uint32_t id, const uint8_t* data, uint8_t len, CanTxPriority priority = CAN_TX_PRIORITY_NORMAL);
+
+// 設定每個週期要發送的報文內容 (已編碼)，count = 0 表示停止週期發送，已在佇列中的週期報文也不再送出
+void can_tx_set_periodic(const CAN_Tx_Frame* frames, uint8_t count);
+
+// 由週期計時器 (PERIODIC_SEND_INTERVAL) 調用，把本週期的報文放入佇列
+void can_tx_periodic_tick();
+
+// 在 CAN TX 任務中調用：最多等待 wait_ms 取出一幀並交給 HAL 發送，沒有報文時回傳 false
+bool can_tx_handle_transmit(uint32_t wait_ms);
+
+CAN_Tx_Stats can_tx_get_stats();
+
+#endif // CAN_TX_SCHEDULER_H
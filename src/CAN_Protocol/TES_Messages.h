@@ -0,0 +1,55 @@
+// src/CAN_Protocol/TES_Messages.h
+// TES-0D-02-01 報文的訊號描述表。新增報文 (例如製造商自訂報文) 只需在此加入一個 CanMessage 定義，
+// 接收端再到 CAN_Protocol.cpp 的分派表登記處理函數。
+
+#ifndef TES_MESSAGES_H
+#define TES_MESSAGES_H
+
+#include "CAN_Codec.h"
+#include "Charger_Defs.h"
+#include "Config.h"
+
+// --- 充電樁 -> 車輛 ---
+typedef CanMessage<CAN_Charger_Status_508, CHARGER_STATUS_ID, 8,
+    CAN_SIGNAL(CAN_Charger_Status_508, faultFlags, 0, 1),
+    CAN_SIGNAL(CAN_Charger_Status_508, statusFlags, 1, 1),
+    CAN_SIGNAL(CAN_Charger_Status_508, availableVoltage, 2, 2, CAN_LITTLE_ENDIAN, 1, 10),            // 0.1V
+    CAN_SIGNAL(CAN_Charger_Status_508, availableCurrent, 4, 2, CAN_LITTLE_ENDIAN, 1, 10),            // 0.1A
+    CAN_SIGNAL(CAN_Charger_Status_508, faultDetectionVoltageLimit, 6, 2, CAN_LITTLE_ENDIAN, 1, 10)   // 0.1V
+> TES_ChargerStatus508;
+
+typedef CanMessage<CAN_Charger_Params_509, CHARGER_PARAMS_ID, 8,
+    CAN_SIGNAL(CAN_Charger_Params_509, esChargeSequenceNumber, 0, 1),
+    CAN_SIGNAL(CAN_Charger_Params_509, ratedOutputPower, 1, 1, CAN_LITTLE_ENDIAN, 50, 1),            // 50W
+    CAN_SIGNAL(CAN_Charger_Params_509, actualOutputVoltage, 2, 2, CAN_LITTLE_ENDIAN, 1, 10),         // 0.1V
+    CAN_SIGNAL(CAN_Charger_Params_509, actualOutputCurrent, 4, 2, CAN_LITTLE_ENDIAN, 1, 10),         // 0.1A
+    CAN_SIGNAL(CAN_Charger_Params_509, remainingChargeTime, 6, 2)                                    // 分鐘，0xFFFF 表示未知
+> TES_ChargerParams509;
+
+typedef CanMessage<CAN_Charger_Emergency_5F8, CHARGER_EMERGENCY_STOP_ID, 8,
+    CAN_SIGNAL(CAN_Charger_Emergency_5F8, emergencyStopRequestFlags, 0, 1),
+    CAN_SIGNAL(CAN_Charger_Emergency_5F8, chargerManufacturerID, 4, 2)
+> TES_ChargerEmergency5F8;
+
+// --- 車輛 -> 充電樁 ---
+typedef CanMessage<CAN_Vehicle_Status_500, VEHICLE_STATUS_ID, 8,
+    CAN_SIGNAL(CAN_Vehicle_Status_500, faultFlags, 0, 1),
+    CAN_SIGNAL(CAN_Vehicle_Status_500, statusFlags, 1, 1),
+    CAN_SIGNAL(CAN_Vehicle_Status_500, chargeCurrentCommand, 2, 2, CAN_LITTLE_ENDIAN, 1, 10),        // 0.1A
+    CAN_SIGNAL(CAN_Vehicle_Status_500, chargeVoltageLimit, 4, 2, CAN_LITTLE_ENDIAN, 1, 10),          // 0.1V
+    CAN_SIGNAL(CAN_Vehicle_Status_500, maxChargeVoltage, 6, 2, CAN_LITTLE_ENDIAN, 1, 10)             // 0.1V
+> TES_VehicleStatus500;
+
+// 舊版車輛只送前 4 個位元組，預計結束時間為選填
+typedef CanMessage<CAN_Vehicle_Params_501, VEHICLE_PARAMS_ID, 4,
+    CAN_SIGNAL(CAN_Vehicle_Params_501, esChargeSequenceNumber, 0, 1),
+    CAN_SIGNAL(CAN_Vehicle_Params_501, stateOfCharge, 1, 1),                                         // %
+    CAN_SIGNAL(CAN_Vehicle_Params_501, maxChargeTime, 2, 2),                                         // 分鐘
+    CAN_SIGNAL(CAN_Vehicle_Params_501, estimatedChargeEndTime, 4, 2)                                 // 分鐘
+> TES_VehicleParams501;
+
+typedef CanMessage<CAN_Vehicle_Emergency_5F0, VEHICLE_EMERGENCY_ID, 1,
+    CAN_SIGNAL(CAN_Vehicle_Emergency_5F0, errorRequestFlags, 0, 1)
+> TES_VehicleEmergency5F0;
+
+#endif // TES_MESSAGES_H
@@ -2,19 +2,17 @@
 #include "Config.h"
 #include "HAL/HAL.h"
 #include "CAN_Protocol/CAN_Protocol.h"
-#include <Preferences.h>
+#include "CAN_Protocol/CAN_Trace.h"
+#include "ConfigStore/ConfigStore.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
 #include "OTAManager/OTAManager.h"
 #include "Version.h"
 #include "PowerSupplyController/PowerSupplyController.h"
 
-extern SemaphoreHandle_t canDataMutex;
 extern bool filesystem_version_mismatch;
 extern void ui_show_boot_screen(const char* line1, const char* line2);
 
 // --- 私有(static)變量，只在這個文件內可見 ---
-static Preferences preferences; 
 static ChargerState currentChargerState = STATE_CHG_IDLE;
 static bool faultLatch = false;
 static bool chargeCompleteLatch = false;
@@ -25,7 +23,6 @@ static float measuredVoltage = 0.0;
 static float measuredCurrent = 0.0;
 
 static unsigned long currentStateStartTime = 0;
-static unsigned long lastPeriodicSendTime = 0;
 static unsigned long lastCPReadTime = 0;
 
 // 計時器相關
@@ -56,10 +53,15 @@ static void ch_sub_04_dc_current_output_control();
 static void ch_sub_06_monitoring_process();
 static void ch_sub_10_protection_and_end_flow(bool isFault);
 static void ch_sub_12_emergency_stop_procedure();
+static bool check_vehicle_data_timeout();
 static bool remote_start_requested = false;
 static bool remote_stop_requested = false;
+static bool start_button_pressed = false; // 本週期收到的按下事件
+static bool stop_button_pressed = false;
 static float lastValidRequestedCurrent_latch = 0.0;
 static byte lastFaultFlags_latch = 0;
+static uint32_t handledEmergencyCount = 0; // 已處理到第幾次車輛緊急停止請求
+static bool vehicleCanTimeoutLatch = false;
 
 enum PreChargeStep {
     STEP_INIT,
@@ -97,15 +99,22 @@ void logic_get_display_data(DisplayData& data) {
         data.measuredVoltage = measuredVoltage; // ADC 讀值
         data.measuredCurrent = measuredCurrent; // 設定值模擬
     }
+    PscCurrentLoopStatus loop = psc_get_current_loop_status();
+    data.currentLoopActive = loop.active;
+    data.currentTrackingError = loop.error_mA / 1000.0f;
+    data.currentLoopTrim = loop.trim_mA / 1000.0f;
 
 
     // --- [新增] 填充新的狀態數據 ---
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        data.vehicleRequestedCurrent = (float)vehicleStatus500.chargeCurrentCommand / 10.0;
-        xSemaphoreGive(canDataMutex);
-    } else {
-        data.vehicleRequestedCurrent = 0.0;
-    }
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    data.vehicleRequestedCurrent = (float)vehicle.status.chargeCurrentCommand / 10.0;
+    uint32_t now = millis();
+    for (int i = 0; i < VEHICLE_MSG_COUNT; i++) {
+        data.vehicleRx[i] = vehicle.timing[i];
+        data.vehicleRxAgeMs[i] = can_protocol_message_age_ms(vehicle, (VehicleCanMessage)i, now);
+    }
+    data.vehicleCanTimeout = vehicleCanTimeoutLatch;
     
     data.lastFaultFlags = lastFaultFlags_latch;
     data.lastValidRequestedCurrent = lastValidRequestedCurrent_latch;
@@ -120,9 +129,26 @@ void logic_get_display_data(DisplayData& data) {
     data.filesystemMismatch = filesystem_version_mismatch;
 }
 
-void logic_init() {
-    preferences.begin("charger_config", false);
+// 設定的衍生值 (0x508/0x509 的額定值)；開機與設定變更時呼叫
+static void logic_apply_config(const ChargerConfig& config) {
+    chargerMaxOutputVoltage_0_1V = config.maxVoltage_0_1V;
+    chargerMaxOutputCurrent_0_1A = config.maxCurrent_0_1A;
+    userSetTargetSOC = config.targetSoc;
 
+    chargerStatus508.availableVoltage = chargerMaxOutputVoltage_0_1V;
+    chargerStatus508.availableCurrent = chargerMaxOutputCurrent_0_1A;
+    chargerStatus508.faultDetectionVoltageLimit = chargerMaxOutputVoltage_0_1V;
+    unsigned int ratedPower_W = (chargerMaxOutputVoltage_0_1V / 10.0) * (chargerMaxOutputCurrent_0_1A / 10.0);
+    chargerParams509.ratedOutputPower = ratedPower_W / 50;
+}
+
+static void logic_on_config_changed(uint32_t changed, const ChargerConfig& config) {
+    if (changed & (CONFIG_CHANGED_MAX_VOLTAGE | CONFIG_CHANGED_MAX_CURRENT | CONFIG_CHANGED_TARGET_SOC)) {
+        logic_apply_config(config);
+    }
+}
+
+void logic_init() {
     ui_show_boot_screen("Please Wait", "Auto-setting Voltage...");
     Serial.println("Auto-setting max voltage...");
 
@@ -134,34 +160,19 @@ void logic_init() {
     } 
     detected_voltage/=5.0;
     if (detected_voltage > 60.0 && detected_voltage < 120.0) {
-        chargerMaxOutputVoltage_0_1V = (unsigned int)(detected_voltage * 10.0);
-        Serial.printf("Detected voltage: %.1fV. Set max voltage to: %u (0.1V units)\n", detected_voltage, chargerMaxOutputVoltage_0_1V);
-        preferences.putUInt("max_voltage", chargerMaxOutputVoltage_0_1V);
+        unsigned int detected_0_1V = (unsigned int)(detected_voltage * 10.0);
+        Serial.printf("Detected voltage: %.1fV. Set max voltage to: %u (0.1V units)\n", detected_voltage, detected_0_1V);
+        config_set_max_voltage(detected_0_1V);
     } else {
         Serial.printf("Voltage detection failed (%.1fV). Using stored value.\n", detected_voltage);
-        chargerMaxOutputVoltage_0_1V = preferences.getUInt("max_voltage", 1000);
-    }
-    
-    chargerMaxOutputCurrent_0_1A = preferences.getUInt("max_current", 100);
-    userSetTargetSOC = preferences.getInt("target_soc", 100);
-
-    if (!preferences.getBool("config_saved", false)) {
-        Serial.println(F("Logic: First boot or NVS empty. Saving default values."));
-        preferences.putBool("config_saved", true);
-        preferences.putUInt("max_voltage", chargerMaxOutputVoltage_0_1V);
-        preferences.putUInt("max_current", chargerMaxOutputCurrent_0_1A);
-        preferences.putInt("target_soc", userSetTargetSOC);
     }
-    preferences.end();
-    
-    unsigned int ratedPower_W = (chargerMaxOutputVoltage_0_1V / 10.0) * (chargerMaxOutputCurrent_0_1A / 10.0);
-    
-    chargerStatus508.availableVoltage = chargerMaxOutputVoltage_0_1V;
-    chargerStatus508.availableCurrent = chargerMaxOutputCurrent_0_1A;
-    chargerStatus508.faultDetectionVoltageLimit = chargerMaxOutputVoltage_0_1V;
-    
+
+    ChargerConfig config;
+    config_get(config);
+    logic_apply_config(config);
+    config_subscribe(logic_on_config_changed);
+
     chargerParams509.esChargeSequenceNumber = 18;
-    chargerParams509.ratedOutputPower = ratedPower_W / 50;
     chargerParams509.remainingChargeTime = 0xFFFF;
 
     chargerEmergency5F8.chargerManufacturerID = chargerManufacturerCode;
@@ -179,34 +190,26 @@ void logic_init() {
     lastValidRequestedCurrent_latch = 0.0;
     lastFaultFlags_latch = 0;
     
-    if (psc_is_connected()) {
-        psc_set_current(6.0); // 重置為預設值 6A
-        Serial.println("Logic: PSC Reset Current to 6.0A");
-    }
+    psc_reset_current();
+    Serial.printf("Logic: PSC Reset Current to %.1fA\n", PSC_RESET_CURRENT_A);
 }
 
-void logic_save_config(unsigned int voltage, unsigned int current, int soc){
-    chargerMaxOutputVoltage_0_1V = voltage;
-    chargerMaxOutputCurrent_0_1A = current;
-    userSetTargetSOC = soc;
-
-    chargerStatus508.availableVoltage = chargerMaxOutputVoltage_0_1V;
-    chargerStatus508.availableCurrent = chargerMaxOutputCurrent_0_1A;
-    chargerStatus508.faultDetectionVoltageLimit = chargerMaxOutputVoltage_0_1V;
-    unsigned int ratedPower_W = (chargerMaxOutputVoltage_0_1V / 10.0) * (chargerMaxOutputCurrent_0_1A / 10.0);
-    chargerParams509.ratedOutputPower = ratedPower_W / 50;
-
-    preferences.begin("charger_config", false);
-    preferences.putUInt("max_voltage", chargerMaxOutputVoltage_0_1V);
-    preferences.putUInt("max_current", chargerMaxOutputCurrent_0_1A);
-    preferences.putInt("target_soc", userSetTargetSOC);
-    preferences.end();
-    
-    Serial.println(F("Logic: Settings saved to NVS."));
+// 取出上一週期以來的按鈕事件；只看按下，長按與放開由 UI 使用
+static void logic_collect_button_events() {
+  start_button_pressed = false;
+  stop_button_pressed = false;
+  ButtonEvent event;
+  while (hal_button_get_event(BUTTON_CONSUMER_LOGIC, &event)) {
+    if (event.type != BUTTON_EVENT_PRESS) continue;
+    if (event.button == BUTTON_START) start_button_pressed = true;
+    else if (event.button == BUTTON_STOP) stop_button_pressed = true;
+  }
 }
 
 void logic_run_statemachine() {
-  if (hal_get_button_state(BUTTON_EMERGENCY)) {
+  logic_collect_button_events();
+  // 按下的瞬間已由 ISR 斷開繼電器並通知 Logic；按住期間每個週期維持緊急停止
+  if (hal_emergency_button_take_trip() || hal_get_button_state(BUTTON_EMERGENCY)) {
     ch_sub_12_emergency_stop_procedure();
     return;
   }
@@ -222,11 +225,12 @@ void logic_run_statemachine() {
       isChargingTimerRunning = false;
       preChargeStep = STEP_INIT;
       
-      if (hal_get_button_state(BUTTON_START)|| remote_start_requested) {
+      if (start_button_pressed || remote_start_requested) {
         remote_start_requested = false; 
         remote_stop_requested = false; 
         faultLatch = false;
         chargeCompleteLatch = false;
+        vehicleCanTimeoutLatch = false;
         hal_control_vp_relay(true);
         readAndSetCPState();
         if (currentCPState == CP_STATE_OFF || currentCPState == CP_STATE_ON) {
@@ -258,14 +262,11 @@ void logic_run_statemachine() {
       break;
 
     case STATE_CHG_PRE_CHARGE_OPERATIONS: { 
-        CAN_Vehicle_Status_500 status_snapshot;
-        if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-            xSemaphoreGive(canDataMutex);
-        } else {
-            Serial.println("WARN: PRE_CHARGE failed to get mutex!");
-            break; 
-        }
+        if (check_vehicle_data_timeout()) break;
+
+        CAN_Vehicle_Snapshot vehicle;
+        can_protocol_get_vehicle_snapshot(vehicle);
+        const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
 
         if (status_snapshot.statusFlags & 0x08) { 
             Serial.println(F("Logic: Vehicle requested a normal stop BEFORE charging."));
@@ -296,7 +297,7 @@ void logic_run_statemachine() {
                 break;
 
             case STEP_VEHICLE_CONTACTOR_WAIT:
-                if (!(vehicleStatus500.statusFlags & 0x02)) {
+                if (!(status_snapshot.statusFlags & 0x02)) {
                     if (relay_close_delay_start_time == 0) {
                         Serial.println(F("Logic: Vehicle contactor closed. Starting delay..."));
                         relay_close_delay_start_time = millis();
@@ -339,6 +340,7 @@ void logic_run_statemachine() {
 
 
     case STATE_CHG_DC_CURRENT_OUTPUT:
+      if (check_vehicle_data_timeout()) break; // 不再依過時的電流請求輸出
       ch_sub_04_dc_current_output_control();
       ch_sub_06_monitoring_process();
       break;
@@ -359,14 +361,9 @@ void logic_run_statemachine() {
           relay_open_delay_start_time = millis();
       }
 
-      CAN_Vehicle_Status_500 status_snapshot;
-        if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-            xSemaphoreGive(canDataMutex);
-        } else {
-            Serial.println("WARN: ENDING_PROCESS failed to get mutex!");
-            break;
-        }
+      CAN_Vehicle_Snapshot vehicle;
+      can_protocol_get_vehicle_snapshot(vehicle);
+      const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
 
       // 步驟3: 延遲結束後，等待車輛最終狀態
       if (relay_open_delay_start_time > 0 && (millis() - relay_open_delay_start_time >= 250)) {
@@ -429,35 +426,27 @@ void logic_run_statemachine() {
 void logic_handle_periodic_tasks() {
     unsigned long now = millis();
 
-    CAN_Vehicle_Status_500 status_snapshot;
-    CAN_Vehicle_Params_501 params_snapshot;
-    CAN_Vehicle_Emergency_5F0 emergency_snapshot;
-    // 一次性鎖定，快照所有需要的數據
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-        memcpy(&params_snapshot, &vehicleParams501, sizeof(CAN_Vehicle_Params_501));
-        memcpy(&emergency_snapshot, &vehicleEmergency5F0, sizeof(CAN_Vehicle_Emergency_5F0));
-        xSemaphoreGive(canDataMutex);
-    } else {
-        Serial.println("WARN: PERIODIC_TASKS failed to get mutex!");
-        return; // 獲取鎖失敗，跳過本輪處理
-    }
+    // 一次取得 500/501/5F0 的一致快照，不會因為等鎖而跳過本輪處理
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
+    const CAN_Vehicle_Params_501& params_snapshot = vehicle.params;
     
     if ((status_snapshot.statusFlags & 0x01) && !vehicleReadyForCharge && currentChargerState == STATE_CHG_INITIAL_PARAM_EXCHANGE) {
         Serial.println(F("Logic: Vehicle CAN permission granted."));
         vehicleReadyForCharge = true;
     }
-    if (emergency_snapshot.errorRequestFlags & 0x01) {
+    if (vehicle.emergencyCount != handledEmergencyCount) {
+        handledEmergencyCount = vehicle.emergencyCount;
         Serial.println(F("Logic: Vehicle sent EMERGENCY STOP!"));
         ch_sub_12_emergency_stop_procedure();
-        vehicleEmergency5F0.errorRequestFlags = 0;
     }
     if (isChargingTimerRunning && params_snapshot.maxChargeTime != 0xFFFF) {
         uint32_t newTotalTimeSeconds = (uint32_t)params_snapshot.maxChargeTime * 60;
         if (currentTotalTimeSeconds != newTotalTimeSeconds) {
             currentTotalTimeSeconds = newTotalTimeSeconds;
             Serial.print(F("Logic: Total charge time updated by BMS to "));
-            Serial.print(vehicleParams501.maxChargeTime);
+            Serial.print(params_snapshot.maxChargeTime);
             Serial.println(" min.");
         }
     }
@@ -483,17 +472,40 @@ void logic_handle_periodic_tasks() {
         readAndSetCPState();
     }
 
-    if (now - lastPeriodicSendTime >= PERIODIC_SEND_INTERVAL) {
-        lastPeriodicSendTime = now;
-        if (currentChargerState >= STATE_CHG_INITIAL_PARAM_EXCHANGE && currentChargerState < STATE_CHG_FAULT_HANDLING) {
-            chargerParams509.actualOutputVoltage = (uint16_t)(measuredVoltage * 10.0);
-            chargerParams509.actualOutputCurrent = (uint16_t)(measuredCurrent * 10.0);
-            chargerParams509.remainingChargeTime = isChargingTimerRunning ? (remainingTimeSeconds_global + 30) / 60 : 0xFFFF;
-            
-            can_protocol_send_charger_status(chargerStatus508);
-            can_protocol_send_charger_params(chargerParams509);
-            can_protocol_send_emergency_stop(chargerEmergency5F8);
-        }
+    // 週期報文的節拍由 CAN_TxScheduler 的計時器負責，這裡只更新最新內容
+    if (currentChargerState >= STATE_CHG_INITIAL_PARAM_EXCHANGE && currentChargerState < STATE_CHG_FAULT_HANDLING) {
+        chargerParams509.actualOutputVoltage = (uint16_t)(measuredVoltage * 10.0);
+        chargerParams509.actualOutputCurrent = (uint16_t)(measuredCurrent * 10.0);
+        chargerParams509.remainingChargeTime = isChargingTimerRunning ? (remainingTimeSeconds_global + 30) / 60 : 0xFFFF;
+
+        can_protocol_publish_periodic(chargerStatus508, chargerParams509, chargerEmergency5F8);
+    } else {
+        can_protocol_stop_periodic();
+    }
+}
+
+void logic_handle_safety_event() {
+    if (hal_emergency_button_take_trip()) {
+        Serial.println(F("Logic: Emergency button pressed!"));
+        ch_sub_12_emergency_stop_procedure();
+        return;
+    }
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
+
+    if (vehicle.emergencyCount != handledEmergencyCount) {
+        handledEmergencyCount = vehicle.emergencyCount; // 已在此處理，週期任務不再重複處理
+        Serial.println(F("Logic: Vehicle sent EMERGENCY STOP!"));
+        ch_sub_12_emergency_stop_procedure();
+        return;
+    }
+    // 與 ch_sub_06 相同的車輛故障判斷，但不等下一個控制週期，立即斷開繼電器
+    if (status_snapshot.faultFlags != 0 && currentChargerState == STATE_CHG_DC_CURRENT_OUTPUT) {
+        Serial.println(F("Logic: Fault reported by vehicle. Opening relay immediately."));
+        lastFaultFlags_latch = status_snapshot.faultFlags;
+        hal_control_charge_relay(false);
+        ch_sub_10_protection_and_end_flow(true);
     }
 }
 
@@ -508,12 +520,9 @@ ChargerState logic_get_charger_state() { return currentChargerState; }
 bool logic_is_fault_latched() { return faultLatch; }
 bool logic_is_charge_complete() { return chargeCompleteLatch; }
 int logic_get_soc() {
-    int soc = 0;
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        soc = vehicleParams501.stateOfCharge;
-        xSemaphoreGive(canDataMutex);
-    }
-    return soc;
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    return vehicle.params.stateOfCharge;
 }
 uint32_t logic_get_remaining_seconds() { return remainingTimeSeconds_global; }
 float logic_get_measured_voltage() { return measuredVoltage; }
@@ -530,17 +539,9 @@ int logic_get_target_soc_setting() { return userSetTargetSOC; }
 
 static void readAndSetCPState() {
     static byte cpErrorCount = 0;
-    float sum = 0;
-    for (int i = 0; i < CP_SAMPLE_COUNT; i++) {
-        sum += hal_read_cp_voltage();
-        delay(5);
-    }
-    measuredCPVoltage = sum / CP_SAMPLE_COUNT;
-
-    CPState detectedState;
-    if (measuredCPVoltage >= 0.0 && measuredCPVoltage <= 1.9 - CP_HYSTERESIS) detectedState = CP_STATE_OFF;
-    else if (measuredCPVoltage >= 7.4 + CP_HYSTERESIS && measuredCPVoltage <= 13.7) detectedState = CP_STATE_ON;
-    else detectedState = CP_STATE_ERROR;
+    // ADC 任務已對每筆樣本濾波並做遲滯分類，這裡直接取最新結果，不阻塞 Logic 任務
+    measuredCPVoltage = hal_read_cp_voltage();
+    CPState detectedState = hal_read_cp_state();
 
     if (detectedState == CP_STATE_ERROR) {
         if (++cpErrorCount >= CP_ERROR_THRESHOLD) currentCPState = CP_STATE_ERROR;
@@ -551,22 +552,14 @@ static void readAndSetCPState() {
 }
 
 static bool ch_sub_01_battery_compatibility_check() {
-    CAN_Vehicle_Status_500 status_snapshot;
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-        xSemaphoreGive(canDataMutex);
-    } else {
-        Serial.println("WARN: CH_SUB_01 failed to get mutex!");
-        return false; // 獲取數據失敗，則兼容性檢查失敗
-    }
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
     if (status_snapshot.chargeVoltageLimit > chargerMaxOutputVoltage_0_1V) return false;
     if (status_snapshot.maxChargeVoltage > 0 && status_snapshot.chargeVoltageLimit > status_snapshot.maxChargeVoltage) return false;
-    chargerStatus508.faultDetectionVoltageLimit = min(status_snapshot.maxChargeVoltage, chargerMaxOutputVoltage_0_1V);
-    if (psc_is_connected()) {
-        // 設定電壓上限
-        float target_v = (float)chargerStatus508.faultDetectionVoltageLimit / 10.0;
-        psc_set_voltage(target_v);
-    }
+    chargerStatus508.faultDetectionVoltageLimit = min((unsigned int)status_snapshot.maxChargeVoltage, chargerMaxOutputVoltage_0_1V);
+    // 設定電壓上限；電源尚未連線時在連線後送出
+    psc_set_voltage((float)chargerStatus508.faultDetectionVoltageLimit / 10.0);
     return true;
 }
 
@@ -578,15 +571,9 @@ static bool ch_sub_03_coupler_lock_and_insulation_diagnosis() {
 
 static void ch_sub_04_dc_current_output_control() {
     measuredVoltage = hal_read_voltage_sensor();
-    CAN_Vehicle_Status_500 status_snapshot;
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-        xSemaphoreGive(canDataMutex);
-    } else {
-        Serial.println("WARN: CH_SUB_04 failed to get mutex!");
-        // 如果獲取鎖失敗，我們不更新電流，使用上一次的值
-        return;
-    }
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
     if (hal_get_charge_relay_state()) {
         if (psc_is_connected()) {
             // --- [新增] 自動控制邏輯 ---
@@ -595,13 +582,16 @@ static void ch_sub_04_dc_current_output_control() {
             float user_limit = (float)chargerMaxOutputCurrent_0_1A / 10.0;
             float target_current = (bms_request < user_limit) ? bms_request : user_limit;
             
-            // 2. 發送指令
+            // 2. 更新目標，由 PSC 任務依斜率送出；閉迴路依量測電流修正設定值，避免電源過衝
             psc_set_current(target_current);
+            psc_set_current_regulation(true);
             
             // 3. 更新 measuredCurrent 用於本地邏輯 (雖然 display_data 會用 psc_get_current)
-            measuredCurrent = psc_get_current(); 
+            PscSample sample;
+            if (psc_get_sample(sample)) measuredCurrent = sample.current_mA / 1000.0f;
         } else {
             // --- [原有] 手動模式邏輯 ---
+            psc_set_current_regulation(false);
             measuredCurrent = (float)chargerMaxOutputCurrent_0_1A / 10.0;
         }
         float current_request = (float)status_snapshot.chargeCurrentCommand / 10.0;
@@ -609,25 +599,21 @@ static void ch_sub_04_dc_current_output_control() {
             lastValidRequestedCurrent_latch = current_request;
         }
     } else {
+        psc_set_current_regulation(false);
         measuredCurrent = 0.0;
     }
 }
 
 static void ch_sub_06_monitoring_process() {
-    CAN_Vehicle_Status_500 status_snapshot;
-    if (xSemaphoreTake(canDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        memcpy(&status_snapshot, &vehicleStatus500, sizeof(CAN_Vehicle_Status_500));
-        xSemaphoreGive(canDataMutex);
-    } else {
-        Serial.println("WARN: CH_SUB_06 failed to get mutex!");
-        return; // 跳過本輪監控
-    }
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    const CAN_Vehicle_Status_500& status_snapshot = vehicle.status;
     
     if (!(status_snapshot.statusFlags & 0x01)) {
         Serial.println(F("Logic MONITOR: Vehicle CAN stop request."));
         ch_sub_10_protection_and_end_flow(false); return;
     }
-    if (hal_get_button_state(BUTTON_STOP)) {
+    if (stop_button_pressed) {
         Serial.println(F("Logic MONITOR: User stop button pressed."));
         ch_sub_10_protection_and_end_flow(false); return;
     }
@@ -670,29 +656,49 @@ static void ch_sub_06_monitoring_process() {
     }
 }
 
+// 車輛已開始通訊後，0x500 或 0x501 超過 CAN_VEHICLE_TIMEOUT_MS 未更新即視為故障
+static bool check_vehicle_data_timeout() {
+    CAN_Vehicle_Snapshot vehicle;
+    can_protocol_get_vehicle_snapshot(vehicle);
+    uint32_t now = millis();
+    uint32_t age500 = can_protocol_message_age_ms(vehicle, VEHICLE_MSG_500, now);
+    uint32_t age501 = can_protocol_message_age_ms(vehicle, VEHICLE_MSG_501, now);
+    if (age500 <= CAN_VEHICLE_TIMEOUT_MS && age501 <= CAN_VEHICLE_TIMEOUT_MS) return false;
+
+    Serial.printf("Logic: Vehicle CAN timeout (0x500 age %lu ms, 0x501 age %lu ms).\n",
+                  (unsigned long)age500, (unsigned long)age501);
+    vehicleCanTimeoutLatch = true;
+    hal_control_charge_relay(false);
+    ch_sub_10_protection_and_end_flow(true);
+    return true;
+}
+
 static void ch_sub_10_protection_and_end_flow(bool isFault) {
     Serial.print(F("Logic: CH10_ProtectEnd. IsFault: ")); Serial.println(isFault);
     isChargingTimerRunning = false;
     if (isFault) {
         faultLatch = true;
+        if (currentChargerState != STATE_CHG_FAULT_HANDLING) can_trace_trigger(CAN_TRACE_TRIGGER_FAULT);
         currentChargerState = STATE_CHG_FAULT_HANDLING;
+        can_protocol_stop_periodic(); // 故障處理階段不再發送週期報文
     } else {
         chargeCompleteLatch = true;
         currentChargerState = STATE_CHG_ENDING_CHARGE_PROCESS;
     }
-    if (psc_is_connected()) {
-        psc_set_current(6.0); // 重置為預設值 6A
-        Serial.println("Logic: PSC Reset Current to 6.0A");
-    }
+    psc_reset_current();
+    Serial.printf("Logic: PSC Reset Current to %.1fA\n", PSC_RESET_CURRENT_A);
     currentStateStartTime = millis();
 }
 
 static void ch_sub_12_emergency_stop_procedure() {
     Serial.println(F("Logic: CH12_EmergencyStop Procedure!"));
+    // 按住急停期間每個週期都會進來，只在進入緊急停止時標記 CAN 記錄
+    if (currentChargerState != STATE_CHG_EMERGENCY_STOP_PROC) can_trace_trigger(CAN_TRACE_TRIGGER_EMERGENCY);
     faultLatch = true;
     isChargingTimerRunning = false;
     
     hal_control_charge_relay(false);
+    psc_set_current_regulation(false);
     hal_control_coupler_lock(false);
     hal_control_vp_relay(false);
     
@@ -700,8 +706,9 @@ static void ch_sub_12_emergency_stop_procedure() {
     chargerStatus508.statusFlags |= 0x01;
     chargerEmergency5F8.emergencyStopRequestFlags |= 0x01;
     
-    can_protocol_send_charger_status(chargerStatus508);
+    can_protocol_send_charger_status(chargerStatus508, CAN_TX_PRIORITY_EMERGENCY);
     can_protocol_send_emergency_stop(chargerEmergency5F8);
+    can_protocol_stop_periodic();
 
     currentChargerState = STATE_CHG_EMERGENCY_STOP_PROC;
     currentStateStartTime = millis();
@@ -725,17 +732,3 @@ void logic_stop_button_pressed() {
         Serial.println("Logic: Ignoring remote stop, charger is not in charging state.");
     }
 }
-
-void logic_save_web_settings(unsigned int current, int soc) {
-    // 獲取當前的設定值
-    unsigned int old_voltage = chargerMaxOutputVoltage_0_1V;
-    unsigned int old_current = chargerMaxOutputCurrent_0_1A;
-    int old_soc = userSetTargetSOC;
-
-    // 如果傳入的值不是 0，就使用新值；否則，使用舊值
-    unsigned int new_current = (current != 0) ? current : old_current;
-    int new_soc = (soc != 0) ? soc : old_soc;
-
-    // 呼叫底層的儲存函式
-    logic_save_config(old_voltage, new_current, new_soc);
-}
\ No newline at end of file
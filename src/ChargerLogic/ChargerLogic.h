@@ -9,10 +9,9 @@
 void logic_init();
 void logic_run_statemachine();
 void logic_handle_periodic_tasks();
-void logic_save_config(unsigned int voltage, unsigned int current, int soc);
+void logic_handle_safety_event(); // CAN 任務通知有安全相關報文、或緊急停止按鈕 ISR 通知時立即調用
 void logic_start_button_pressed();
 void logic_stop_button_pressed();
-void logic_save_web_settings(unsigned int current, int soc);
 
 // --- [新增] 提供給所有前端的統一數據接口 ---
 void logic_get_display_data(DisplayData& data);
@@ -28,6 +27,7 @@ float logic_get_measured_voltage();
 float logic_get_measured_current();
 bool logic_is_timer_running();
 uint32_t logic_get_total_time_seconds();
+// 設定值以 ConfigStore 為準，這裡回傳 Logic 目前套用的值；修改請用 config_set_*()
 unsigned int logic_get_max_voltage_setting();
 unsigned int logic_get_max_current_setting();
 int logic_get_target_soc_setting();
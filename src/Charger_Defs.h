@@ -43,7 +43,49 @@ enum UIState {
     UI_STATE_MENU_SAVED,
     UI_STATE_MENU_NETWORK,
     UI_STATE_MENU_ABOUT,
-    UI_STATE_MENU_UPDATE_OPTIONS
+    UI_STATE_MENU_UPDATE_OPTIONS,
+    UI_STATE_MENU_CALIBRATION
+};
+
+// --- 車輛 CAN 報文接收時序 ---
+enum VehicleCanMessage : byte {
+    VEHICLE_MSG_500,
+    VEHICLE_MSG_501,
+    VEHICLE_MSG_5F0,
+    VEHICLE_MSG_COUNT
+};
+
+struct CAN_Rx_Timing {
+    uint32_t count;           // 累計接收次數
+    uint32_t lastRxMs;        // 最近一次接收時的 millis()
+    uint32_t lastIntervalUs;  // 最近一次的到達間隔，0 表示尚無
+    uint32_t meanIntervalUs;  // 到達間隔的移動平均 (權重 1/16)
+    uint32_t maxIntervalUs;   // 最大到達間隔 (不含逾時中斷)
+    uint32_t jitterUs;        // 到達間隔抖動，RFC 3550 的估計式
+    uint32_t gaps;            // 間隔超過 CAN_VEHICLE_TIMEOUT_MS 的次數 (報文中斷後重新開始)
+};
+
+// --- CAN 控制器健康狀態 ---
+enum CanBusState : byte {
+    CAN_BUS_STOPPED,     // 驅動未安裝或未啟動
+    CAN_BUS_RUNNING,
+    CAN_BUS_OFF,         // TEC 超過 255，控制器已脫離匯流排
+    CAN_BUS_RECOVERING   // 等待 128 次 11 個隱性位元後回到 STOPPED
+};
+
+struct CAN_Bus_Health {
+    CanBusState state;
+    bool errorPassive;        // TEC 或 REC >= 128，只能送出被動錯誤旗標
+    uint16_t txErrorCounter;  // TEC
+    uint16_t rxErrorCounter;  // REC
+    uint32_t rxMissed;        // 驅動接收佇列已滿而遺失的報文
+    uint32_t rxOverrun;       // 硬體 RX FIFO 溢位遺失的報文 (驅動不支援時為 0)
+    uint32_t arbLost;         // 仲裁失敗次數
+    uint32_t busErrors;       // 位元/格式/填充/ACK 等匯流排錯誤次數
+    uint32_t txFailed;        // 驅動回報發送失敗的報文
+    uint32_t busOffCount;     // 進入 bus-off 的次數
+    uint32_t recoveries;      // 自動恢復成功的次數
+    uint32_t lastBusOffMs;    // 最近一次進入 bus-off 的 millis()，0 表示從未發生
 };
 
 // --- UI 顯示數據包 ---
@@ -57,6 +99,9 @@ struct DisplayData {
     int soc;
     float measuredVoltage;
     float measuredCurrent;
+    bool currentLoopActive;        // 電流閉迴路運作中 (PSC_CurrentLoop.h)
+    float currentTrackingError;    // 目標 - 量測電流 (A)
+    float currentLoopTrim;         // 閉迴路加在目標上的修正量 (A)
     
     // 時間相關
     uint32_t remainingSeconds;
@@ -72,6 +117,12 @@ struct DisplayData {
     float vehicleRequestedCurrent; // BMS 請求的電流
     byte lastFaultFlags;           // 停止前的最後故障旗標 (來自 0x500)
     float lastValidRequestedCurrent; // 停止前最後一個有效的電流請求
+    bool vehicleCanTimeout;          // 故障原因為車輛報文逾時
+
+    // 車輛報文接收時序 (0x500/0x501/0x5F0)
+    CAN_Rx_Timing vehicleRx[VEHICLE_MSG_COUNT];
+    uint32_t vehicleRxAgeMs[VEHICLE_MSG_COUNT]; // 距上次接收的時間，從未收到時為 UINT32_MAX
+    CAN_Bus_Health canBus;
 
     // OTA 相關數據
     const char* currentFirmwareVersion;
@@ -92,37 +143,38 @@ struct DisplayData {
 
 
 // --- CAN訊息資料結構 ---
+// 欄位寬度與報文中的訊號一致 (16 位元訊號使用 uint16_t)，編碼位置定義於 CAN_Protocol/TES_Messages.h
 struct CAN_Charger_Status_508 {
     byte faultFlags;
     byte statusFlags;
-    unsigned int availableVoltage;
-    unsigned int availableCurrent;
-    unsigned int faultDetectionVoltageLimit;
+    uint16_t availableVoltage;
+    uint16_t availableCurrent;
+    uint16_t faultDetectionVoltageLimit;
 };
 struct CAN_Charger_Params_509 {
     byte esChargeSequenceNumber;
     byte ratedOutputPower;
-    unsigned int actualOutputVoltage;
-    unsigned int actualOutputCurrent;
-    unsigned int remainingChargeTime;
+    uint16_t actualOutputVoltage;
+    uint16_t actualOutputCurrent;
+    uint16_t remainingChargeTime;
 };
 struct CAN_Charger_Emergency_5F8 {
     byte emergencyStopRequestFlags;
     byte reserved1_3[3];
-    unsigned int chargerManufacturerID;
+    uint16_t chargerManufacturerID;
 };
 struct CAN_Vehicle_Status_500 {
     byte faultFlags;
     byte statusFlags;
-    unsigned int chargeCurrentCommand;
-    unsigned int chargeVoltageLimit;
-    unsigned int maxChargeVoltage;
+    uint16_t chargeCurrentCommand;
+    uint16_t chargeVoltageLimit;
+    uint16_t maxChargeVoltage;
 };
 struct CAN_Vehicle_Params_501 {
     byte esChargeSequenceNumber;
     byte stateOfCharge;
-    unsigned int maxChargeTime;
-    unsigned int estimatedChargeEndTime;
+    uint16_t maxChargeTime;
+    uint16_t estimatedChargeEndTime;
     byte reserved[2];
 };
 struct CAN_Vehicle_Emergency_5F0 {
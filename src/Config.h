@@ -0,0 +1,168 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// =================================================================
+// =                 USER CONFIGURATION SECTION                    =
+// =          請在此處修改配置以適應您的硬體和偏好            =
+// =================================================================
+
+
+// --- 硬體引腳定義 (Hardware Pin Definitions) ---
+// 請根據您的實際接線修改以下GPIO編號
+
+// 按鈕 (Buttons)
+#define START_BUTTON_PIN      42
+#define STOP_BUTTON_PIN       39
+#define EMERGENCY_BUTTON_PIN  40
+#define SETTING_BUTTON_PIN    41
+
+// LED 指示燈
+#define LED_STANDBY_PIN       5  // 橘燈
+#define LED_CHARGING_PIN      6  // 綠燈
+#define LED_ERROR_PIN         7  // 紅燈
+
+// 繼電器與輸出 (Relays & Outputs)
+#define CHARGE_RELAY_PIN      11  // 主充電繼電器
+#define LOCK_SOLENOID_PIN     10  // 電磁鎖 (可選)
+#define VP_RELAY_PIN          9  // VP 繼電器 
+
+// CAN Bus (TJA1051T/3)
+#define TWAI_TX_PIN           GPIO_NUM_17
+#define TWAI_RX_PIN           GPIO_NUM_18
+
+// I2C 總線 (OLED & ADS1115)
+// 通常是固定的，除非您有特殊需求
+#define I2C_SDA_PIN           16
+#define I2C_SCL_PIN           15
+#define ADS_ALERT_PIN         8   // ADS1115 ALERT/RDY (開汲極，內部上拉)；未接線時退回輪詢
+#define I2C_BUS_FREQUENCY_HZ  400000UL  // ADS1115 與 SSD1306 都只支援到 Fast-mode 400 kHz
+// 總線仲裁 (I2C_Bus.h)：OLED 每塊傳送的 8x8 tile 數依當下到 ADC 下一筆轉換的空檔決定，至少 1 個
+// (860 SPS 約 1.1 ms，扣掉讀取約 0.9 ms；每塊的位址與命令約 0.2 ms，每個 tile 約 0.2 ms)
+#define I2C_ADC_GUARD_US        100   // OLED 傳送結束與 ADC 下一筆轉換完成之間至少留這麼多
+#define I2C_ADC_STALE_US        5000  // ADC 超過預定時間這麼久還沒讀取，視為停止，不再讓路
+#define I2C_ADC_WINDOW_WAIT_MS  5     // OLED 等待 ADC 讀完的最長時間 (沒接 RDY 時 ADC 以逾時輪詢)
+#define I2C_BUS_TIMEOUT_MS      100   // 取得總線的最長等待，超過視為總線卡住
+
+// --- 分壓電阻定義 ---
+// 標稱值；每台的電阻誤差由兩點校準補償 (存在 NVS，見 ADC_Calibration.h)，不需要為個別機器改韌體
+const float VOLTAGE_DIVIDER_120V_R1 = 348.0; // 標稱348kΩ
+const float VOLTAGE_DIVIDER_120V_R2 = 12;  // 標稱12kΩ
+const float VOLTAGE_DIVIDER_120V_RATIO = VOLTAGE_DIVIDER_120V_R2 / (VOLTAGE_DIVIDER_120V_R1 + VOLTAGE_DIVIDER_120V_R2);
+
+const float VOLTAGE_DIVIDER_CP_R1 = 150.0; // Ω
+const float VOLTAGE_DIVIDER_CP_R2 = 51.0;  // Ω
+const float VOLTAGE_DIVIDER_CP_RATIO = VOLTAGE_DIVIDER_CP_R2 / (VOLTAGE_DIVIDER_CP_R1 + VOLTAGE_DIVIDER_CP_R2);
+
+// --- CP 參數 ---
+#define CP_OFF_MAX_MV 1900      // CP 0V (未連接) 上限
+#define CP_ON_MIN_MV 7400       // CP 12V (已連接) 下限
+#define CP_ON_MAX_MV 13700      // CP 12V (已連接) 上限
+#define CP_HYSTERESIS_MV 300    // 防抖電壓寬容值：進入狀態需離邊界此值以上，離開需超出邊界此值
+#define CP_ERROR_THRESHOLD 2    // 連續錯誤次數才判斷為錯誤
+
+// --- ADS1115 背景取樣 (連續轉換，差分 0-1 與 2-3 輪流) ---
+// 每個通道各自的 PGA 滿量程 (mV)、資料速率 (SPS) 與過取樣次數 (切換前連續取的筆數)，執行中可用 hal_adc_set_profile() 或 /adc_profile 修改。
+// 切換通道後第一筆轉換丟棄，因此一個通道的時段 = (過取樣 + 1) / SPS，另一個通道的時段內不會更新。
+// 取捨可用模擬器 --bench-adc 比較。
+#define ADC_VOLTAGE_FULL_SCALE_MV 4096  // 120V 分壓後約 4.0V
+#define ADC_VOLTAGE_SPS 860
+#define ADC_VOLTAGE_OVERSAMPLING 16
+#define ADC_CP_FULL_SCALE_MV 4096       // CP 12V 分壓後約 3.0V
+#define ADC_CP_SPS 860
+#define ADC_CP_OVERSAMPLING 8
+// 每筆轉換 (分壓前的 mV) 依序經過中位數 (奇數，1 = 不使用) 與 EMA (係數 1/2^SHIFT，0 = 不使用)
+#define ADC_VOLTAGE_MEDIAN 3
+#define ADC_VOLTAGE_EMA_SHIFT 4         // CV 階段電流逐漸下降時需要較低的電壓雜訊
+#define ADC_CP_MEDIAN 3
+#define ADC_CP_EMA_SHIFT 1              // 插槍偵測要快，CP 只有 0V/12V 兩個位準，不需要低雜訊
+#define ADC_READY_MARGIN_MS 2            // 等待 ALERT/RDY 超過一次轉換時間加上此值，改為直接讀取
+
+// --- CAN ID 定義 ---
+#define CHARGER_STATUS_ID 0x508
+#define CHARGER_PARAMS_ID 0x509
+#define CHARGER_EMERGENCY_STOP_ID 0x5F8
+
+#define VEHICLE_STATUS_ID 0x500
+#define VEHICLE_PARAMS_ID 0x501
+#define VEHICLE_EMERGENCY_ID 0x5F0
+
+// 除錯用：取消註解後 TWAI 硬體濾波器接收所有報文 (預設只接收上面三個車輛 ID)
+//#define CAN_ACCEPT_ALL_FRAMES
+
+// --- 計時器與超時控制 ---
+const unsigned long PERIODIC_SEND_INTERVAL = 100;  // ms
+const unsigned long CAN_RX_WAIT_MS = 100;          // CAN 任務阻塞等待新報文的最長時間
+const unsigned long CAN_VEHICLE_TIMEOUT_MS = 1000; // 充電中超過此時間沒收到 0x500/0x501 視為故障
+const unsigned long CAN_TX_TIMEOUT_MS = 20;        // CAN TX 任務等待驅動發送佇列空位的最長時間
+const unsigned int CAN_TX_QUEUE_LEN = 16;          // 發送排程器佇列長度 (幀)
+const unsigned int CAN_TX_URGENT_QUEUE_LEN = 8;    // 緊急報文 (CAN_TX_PRIORITY_EMERGENCY) 佇列長度
+const unsigned int CAN_DRIVER_TX_QUEUE_LEN = 3;    // TWAI 驅動佇列只放一個週期的量，讓排程器的優先順序生效
+const unsigned long CAN_BUS_HEALTH_POLL_MS = 100;  // CAN 任務讀取控制器狀態 (TEC/REC、遺失報文) 的間隔
+
+// --- CAN 報文記錄 (CAN_Trace) ---
+// 每幀 16 bytes；有 PSRAM 時常駐 1 MB 環形緩衝，故障視窗前後共 8192 幀 (約 2 分鐘)
+#if defined(BOARD_HAS_PSRAM) || defined(SIM_NATIVE)
+const uint32_t CAN_TRACE_CAPACITY = 65536;      // 必須是 2 的次方
+const uint32_t CAN_TRACE_PRE_TRIGGER = 6144;    // 故障前保留的幀數
+const uint32_t CAN_TRACE_POST_TRIGGER = 2048;   // 故障後繼續記錄的幀數
+#else
+const uint32_t CAN_TRACE_CAPACITY = 2048;
+const uint32_t CAN_TRACE_PRE_TRIGGER = 384;
+const uint32_t CAN_TRACE_POST_TRIGGER = 128;
+#endif
+const unsigned long CAN_TRACE_POST_TRIGGER_MS = 5000; // 故障後匯流排安靜時，最多等這麼久就另存視窗
+const unsigned long CP_READ_INTERVAL = 50;         // ms
+const unsigned long DISPLAY_UPDATE_INTERVAL_MS = 250; // ms
+const unsigned long LONG_PRESS_DURATION_MS = 1000; // ms
+const unsigned long BUTTON_DEBOUNCE_MS = 30;       // 最後一次邊緣後維持這麼久才視為穩定
+const unsigned int BUTTON_EVENT_QUEUE_LENGTH = 8;  // 每個消費者 (Logic/UI) 各一個佇列
+const unsigned long SAVED_SCREEN_DURATION_MS = 2000; // ms
+const unsigned long CONFIG_SAVE_QUIET_MS = 3000;     // 設定最後一次變更後靜止這麼久才寫入 NVS，連續調整只寫一次
+const unsigned long PSC_TIMEOUT_MS = 3000;           // 超過此時間沒收到電源遙測視為斷線
+const unsigned long PSC_RX_IDLE_CHECK_MS = 100;      // PSC 接收任務沒有資料時，每隔這麼久檢查一次斷線
+const uint8_t PSC_RX_TIMEOUT_SYMBOLS = 2;            // UART 靜止這麼多個字元時間即通知接收任務 (每行結尾一次)
+const unsigned long PSC_SETPOINT_MIN_INTERVAL_MS = 100; // 電源設定指令的最小間隔 (最多 10 筆/秒)，期間的變更合併
+const uint32_t PSC_CURRENT_RAMP_MA_PER_S = 20000;    // 電流設定值上升的斜率 (20 A/s)，下降立即生效
+const int32_t PSC_SETPOINT_DEADBAND_MILLI = 50;      // 與上次送出的差值超過 50 mV / 50 mA 才送出
+const float PSC_RESET_CURRENT_A = 6.0;               // 開機與充電結束時的電流設定值
+// 電流閉迴路 (PSC_CurrentLoop.h)：只在二進位框架 (100 Hz 遙測) 下運作，文字協議時維持開迴路。
+// 執行中可由 /current_loop 調整，不儲存，重開機回到以下預設值
+const bool PSC_CURRENT_LOOP_ENABLED = true;
+const float PSC_CURRENT_LOOP_KP = 0.2;
+const float PSC_CURRENT_LOOP_KI = 4.0;                // 1/s
+const int32_t PSC_CURRENT_LOOP_MAX_TRIM_MA = 5000;   // 修正量上限 ±5 A
+const int32_t PSC_CURRENT_LOOP_MAX_OVER_MA = 1000;   // 修正後的設定值最多超過目標 (BMS 請求與使用者上限取小者) 1 A
+const int32_t PSC_CURRENT_LOOP_CV_MARGIN_MV = 500;   // 量測電壓距設定值不到 0.5 V 視為定電壓，暫停積分
+const unsigned long PSC_CURRENT_LOOP_COMMAND_INTERVAL_MS = 20; // 閉迴路運作時的指令最小間隔 (取代 PSC_SETPOINT_MIN_INTERVAL_MS)
+
+// --- 物理極限與安全設定 (Physical & Safety Limits) ---
+// 這些值應該根據您的電源供應器和硬體能力設定
+const unsigned int HARDWARE_MAX_VOLTAGE_0_1V = 1200; // 120.0V
+const unsigned int HARDWARE_MAX_CURRENT_0_1A = 1000; // 100.0A (假設硬體最大支持100A)
+const unsigned int HARDWARE_MIN_VOLTAGE_0_1V = 100;  // 10.0V (邏輯上的最小值)
+const unsigned int HARDWARE_MIN_CURRENT_0_1A = 10;   // 1.0A (邏輯上的最小值)
+const int HARDWARE_MAX_SOC = 100; // 100%
+const int HARDWARE_MIN_SOC = 10;  // 10% (邏輯上的最小值)
+
+// --- 充電參數 ---
+const unsigned int chargerManufacturerCode = 0x0000;
+
+//WiFi
+#define WIFI_AP_SSID "TES_Charger_ESP32"
+#define WIFI_AP_PASSWORD "12345678"
+
+// --- 功能開關 (Feature Toggles) ---
+
+// 是否啟用OLED顯示和設定選單功能
+// 如果您沒有連接OLED，可以將下面這一行註解掉，以節省程式碼空間
+#define ENABLE_OLED_SUPPORT
+
+// --- ?????? ---
+const int LUX_BEACON_TIME_UNIT_MS = 150;
+//#define DEVELOPER_MODE
+
+// =================================================================
+// =                END OF USER CONFIGURATION SECTION              =
+// =================================================================
+
+#endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,225 @@
+// src/ConfigStore/ConfigStore.cpp
+
+#include "ConfigStore.h"
+#include "Config.h"
+#include <Preferences.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define CHARGER_NAMESPACE "charger_config"
+#define WIFI_NAMESPACE    "wifi_config"
+#define SETTINGS_KEY      "settings"
+#define SETTINGS_VERSION  1
+
+// 充電設定在 NVS 中的格式：一個 blob，一次寫入。欄位有變動時遞增 SETTINGS_VERSION 並在 load_settings() 轉換
+struct SettingsBlob {
+    uint16_t version;
+    uint16_t size;
+    uint32_t maxVoltage_0_1V;
+    uint32_t maxCurrent_0_1A;
+    int32_t targetSoc;
+};
+
+extern TaskHandle_t configTaskHandle;
+
+static ChargerConfig cache;
+static portMUX_TYPE config_mux = portMUX_INITIALIZER_UNLOCKED;
+static ConfigListener listeners[CONFIG_MAX_LISTENERS];
+static uint8_t listener_count = 0;
+
+// 延遲寫入：persisted 為 NVS 中目前的內容，dirty 時在 save_due_ms 之後與 cache 比較再寫入
+static SettingsBlob persisted;
+static bool dirty = false;
+static uint32_t save_due_ms = 0;
+static ConfigWriterStats writer_stats;
+
+static void copy_string(char* dst, const char* src, size_t max_len) {
+    strncpy(dst, src ? src : "", max_len);
+    dst[max_len] = '\0';
+}
+
+static SettingsBlob make_blob(const ChargerConfig& c) {
+    SettingsBlob b;
+    memset(&b, 0, sizeof(b));
+    b.version = SETTINGS_VERSION;
+    b.size = sizeof(SettingsBlob);
+    b.maxVoltage_0_1V = c.maxVoltage_0_1V;
+    b.maxCurrent_0_1A = c.maxCurrent_0_1A;
+    b.targetSoc = c.targetSoc;
+    return b;
+}
+
+// 讀取 blob；不存在或版本不符時改讀舊版韌體的個別鍵值，回傳 false 表示需要轉存為 blob
+static bool load_settings(Preferences& prefs, ChargerConfig& c) {
+    SettingsBlob b;
+    if (prefs.getBytesLength(SETTINGS_KEY) == sizeof(b) &&
+        prefs.getBytes(SETTINGS_KEY, &b, sizeof(b)) == sizeof(b) &&
+        b.version == SETTINGS_VERSION && b.size == sizeof(b)) {
+        c.maxVoltage_0_1V = b.maxVoltage_0_1V;
+        c.maxCurrent_0_1A = b.maxCurrent_0_1A;
+        c.targetSoc = b.targetSoc;
+        return true;
+    }
+    c.maxVoltage_0_1V = prefs.getUInt("max_voltage", 1000);
+    c.maxCurrent_0_1A = prefs.getUInt("max_current", 100);
+    c.targetSoc = prefs.getInt("target_soc", 100);
+    return false;
+}
+
+void config_init() {
+    Preferences prefs;
+    ChargerConfig loaded;
+    memset(&loaded, 0, sizeof(loaded));
+
+    prefs.begin(CHARGER_NAMESPACE, true);
+    bool blob_ok = load_settings(prefs, loaded);
+    loaded.beaconUnlocked = prefs.getBool("beacon_unlocked", false);
+    prefs.end();
+
+    prefs.begin(WIFI_NAMESPACE, true);
+    copy_string(loaded.wifiSsid, prefs.getString("ssid", "").c_str(), CONFIG_WIFI_SSID_MAX);
+    copy_string(loaded.wifiPass, prefs.getString("pass", "").c_str(), CONFIG_WIFI_PASS_MAX);
+    prefs.end();
+
+    portENTER_CRITICAL(&config_mux);
+    cache = loaded;
+    persisted = make_blob(loaded);
+    // 首次開機或舊版格式：交給寫入任務轉存，不在開機路徑上寫 flash
+    if (!blob_ok) persisted.version = 0;
+    dirty = !blob_ok;
+    save_due_ms = millis() + CONFIG_SAVE_QUIET_MS;
+    portEXIT_CRITICAL(&config_mux);
+    memset(&writer_stats, 0, sizeof(writer_stats));
+
+    Serial.printf("Config: Loaded (max %.1f V, %.1f A, SOC %d %%, WiFi %s)%s.\n",
+                  loaded.maxVoltage_0_1V / 10.0, loaded.maxCurrent_0_1A / 10.0, loaded.targetSoc,
+                  loaded.wifiSsid[0] ? loaded.wifiSsid : "not set",
+                  blob_ok ? "" : ", settings blob will be written");
+}
+
+void config_get(ChargerConfig& config) {
+    portENTER_CRITICAL(&config_mux);
+    config = cache;
+    portEXIT_CRITICAL(&config_mux);
+}
+
+// 單一欄位為 32 位元，讀取本身是原子的
+unsigned int config_get_max_voltage() { return cache.maxVoltage_0_1V; }
+unsigned int config_get_max_current() { return cache.maxCurrent_0_1A; }
+int config_get_target_soc() { return cache.targetSoc; }
+bool config_get_beacon_unlocked() { return cache.beaconUnlocked; }
+
+bool config_subscribe(ConfigListener listener) {
+    for (uint8_t i = 0; i < listener_count; i++) {
+        if (listeners[i] == listener) return true;
+    }
+    if (listener_count >= CONFIG_MAX_LISTENERS) return false;
+    listeners[listener_count++] = listener;
+    return true;
+}
+
+static void notify(uint32_t changed) {
+    ChargerConfig snapshot;
+    config_get(snapshot);
+    for (uint8_t i = 0; i < listener_count; i++) {
+        listeners[i](changed, snapshot);
+    }
+}
+
+void config_set_charge_settings(unsigned int voltage_0_1V, unsigned int current_0_1A, int soc) {
+    uint32_t changed = 0;
+    portENTER_CRITICAL(&config_mux);
+    if (cache.maxVoltage_0_1V != voltage_0_1V) changed |= CONFIG_CHANGED_MAX_VOLTAGE;
+    if (cache.maxCurrent_0_1A != current_0_1A) changed |= CONFIG_CHANGED_MAX_CURRENT;
+    if (cache.targetSoc != soc) changed |= CONFIG_CHANGED_TARGET_SOC;
+    cache.maxVoltage_0_1V = voltage_0_1V;
+    cache.maxCurrent_0_1A = current_0_1A;
+    cache.targetSoc = soc;
+    if (changed) {
+        // 每次變更都把期限往後延，連續調整合併成一次寫入
+        dirty = true;
+        save_due_ms = millis() + CONFIG_SAVE_QUIET_MS;
+    }
+    portEXIT_CRITICAL(&config_mux);
+    if (!changed) return;
+
+    if (configTaskHandle != NULL) xTaskNotifyGive(configTaskHandle);
+    notify(changed);
+}
+
+void config_set_max_voltage(unsigned int voltage_0_1V) {
+    config_set_charge_settings(voltage_0_1V, config_get_max_current(), config_get_target_soc());
+}
+
+// 寫入 blob；與 NVS 中的內容相同時不寫 (例如 80% -> 95% -> 80%)
+static void write_settings() {
+    SettingsBlob blob;
+    portENTER_CRITICAL(&config_mux);
+    blob = make_blob(cache);
+    dirty = false;
+    portEXIT_CRITICAL(&config_mux);
+
+    if (memcmp(&blob, &persisted, sizeof(blob)) == 0) {
+        writer_stats.skipped++;
+        return;
+    }
+    Preferences prefs;
+    prefs.begin(CHARGER_NAMESPACE, false);
+    bool ok = prefs.putBytes(SETTINGS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    if (ok) {
+        persisted = blob;
+        writer_stats.writes++;
+        Serial.println(F("Config: Charge settings saved to NVS."));
+    } else {
+        writer_stats.failures++;
+        Serial.println(F("Config: Failed to write charge settings to NVS."));
+    }
+}
+
+uint32_t config_writer_service(uint32_t now_ms) {
+    portENTER_CRITICAL(&config_mux);
+    bool pending = dirty;
+    int32_t remaining = (int32_t)(save_due_ms - now_ms);
+    portEXIT_CRITICAL(&config_mux);
+
+    if (!pending) return CONFIG_WRITER_IDLE;
+    if (remaining > 0) return (uint32_t)remaining;
+    write_settings();
+    return CONFIG_WRITER_IDLE;
+}
+
+void config_flush() {
+    if (dirty) write_settings();
+}
+
+ConfigWriterStats config_get_writer_stats() {
+    return writer_stats;
+}
+
+// WiFi 憑證很少修改，且修改後緊接著重新開機，直接同步寫入
+void config_set_wifi_credentials(const char* ssid, const char* pass) {
+    ChargerConfig updated;
+    bool changed;
+    portENTER_CRITICAL(&config_mux);
+    updated = cache;
+    copy_string(updated.wifiSsid, ssid, CONFIG_WIFI_SSID_MAX);
+    copy_string(updated.wifiPass, updated.wifiSsid[0] ? pass : "", CONFIG_WIFI_PASS_MAX);
+    changed = strcmp(updated.wifiSsid, cache.wifiSsid) != 0 || strcmp(updated.wifiPass, cache.wifiPass) != 0;
+    cache = updated;
+    portEXIT_CRITICAL(&config_mux);
+    if (!changed) return;
+
+    Preferences prefs;
+    prefs.begin(WIFI_NAMESPACE, false);
+    if (updated.wifiSsid[0]) {
+        prefs.putString("ssid", updated.wifiSsid);
+        prefs.putString("pass", updated.wifiPass);
+    } else {
+        prefs.remove("ssid");
+        prefs.remove("pass");
+    }
+    prefs.end();
+    Serial.println(updated.wifiSsid[0] ? F("Config: WiFi credentials saved to NVS.") : F("Config: WiFi credentials cleared."));
+    notify(CONFIG_CHANGED_WIFI);
+}
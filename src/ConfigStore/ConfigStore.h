@@ -0,0 +1,66 @@
+// src/ConfigStore/ConfigStore.h
+// 設定的集中快取：開機時一次從 NVS 載入所有鍵值，之後的讀取都只讀 RAM。
+// 修改一律經過 config_set_*()：值沒有變就不寫入也不通知；有變時立即更新快取並通知訂閱者，
+// 充電設定由低優先級的 Config 任務在靜止 CONFIG_SAVE_QUIET_MS 後合併成一個 blob 寫入 NVS。
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+#define CONFIG_WIFI_SSID_MAX 32
+#define CONFIG_WIFI_PASS_MAX 64
+
+struct ChargerConfig {
+    unsigned int maxVoltage_0_1V;
+    unsigned int maxCurrent_0_1A;
+    int targetSoc;
+    bool beaconUnlocked;
+    char wifiSsid[CONFIG_WIFI_SSID_MAX + 1];  // 空字串表示未設定，開機時進入 AP 模式
+    char wifiPass[CONFIG_WIFI_PASS_MAX + 1];
+};
+
+// 通知時傳入的變更位元
+enum ConfigChange {
+    CONFIG_CHANGED_MAX_VOLTAGE = 0x01,
+    CONFIG_CHANGED_MAX_CURRENT = 0x02,
+    CONFIG_CHANGED_TARGET_SOC = 0x04,
+    CONFIG_CHANGED_WIFI = 0x08
+};
+
+// 在呼叫 setter 的任務中執行 (可能是 Web 或 BLE 的回呼)，不可阻塞
+typedef void (*ConfigListener)(uint32_t changed, const ChargerConfig& config);
+
+void config_init();  // 必須在其他模組讀取設定之前呼叫
+
+// --- 讀取 (只讀 RAM，可在任何任務中呼叫) ---
+void config_get(ChargerConfig& config);
+unsigned int config_get_max_voltage();
+unsigned int config_get_max_current();
+int config_get_target_soc();
+bool config_get_beacon_unlocked();
+
+// --- 修改 ---
+void config_set_max_voltage(unsigned int voltage_0_1V);
+void config_set_charge_settings(unsigned int voltage_0_1V, unsigned int current_0_1A, int soc);
+void config_set_wifi_credentials(const char* ssid, const char* pass);  // ssid 為空時清除
+
+// --- 延遲寫入 (由 main.cpp 的 Config 任務呼叫) ---
+#define CONFIG_WRITER_IDLE 0xFFFFFFFFUL
+
+struct ConfigWriterStats {
+    uint32_t writes;
+    uint32_t skipped;   // 到期時內容與 NVS 相同，沒有寫入
+    uint32_t failures;
+};
+
+// 到期時寫入；回傳距離下一次需要呼叫的毫秒數，沒有待寫入的變更時回傳 CONFIG_WRITER_IDLE
+uint32_t config_writer_service(uint32_t now_ms);
+void config_flush();  // 重新開機前呼叫，立即寫入尚未到期的變更
+ConfigWriterStats config_get_writer_stats();
+
+// 最多 CONFIG_MAX_LISTENERS 個；重複訂閱同一個函數只算一次
+#define CONFIG_MAX_LISTENERS 4
+bool config_subscribe(ConfigListener listener);
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,73 @@
+// src/HAL/ADC_Calibration.h
+// 每台機器的分壓校準：以標稱分壓比換算出的 mV 為輸入，實際值 = 增益 × 標稱值 + 偏移。
+// 增益併入取樣換算係數，在切換通道時算好；取樣路徑只有一次整數乘法、位移與加法。
+// 只有整數運算，不依賴 Arduino，模擬器的 --bench-filter 也檢查同一份實作。
+
+#ifndef ADC_CALIBRATION_H
+#define ADC_CALIBRATION_H
+
+#include <stdint.h>
+
+#define ADC_CAL_GAIN_ONE 65536L             // Q16，1.0 表示與標稱分壓比相同
+#define ADC_CAL_MIN_GAIN (ADC_CAL_GAIN_ONE / 2)
+#define ADC_CAL_MAX_GAIN (ADC_CAL_GAIN_ONE * 2)
+#define ADC_CAL_MAX_OFFSET_MV 5000          // 超過這個值多半是接錯線或輸入了錯的參考值
+#define ADC_CAL_MIN_SPAN_MV 1000            // 兩個校準點至少相差這麼多，否則增益誤差太大
+
+struct AdcCalibration {
+    int32_t gainQ16;
+    int32_t offsetMv;
+};
+
+inline AdcCalibration adc_calibration_nominal() {
+    AdcCalibration c = { (int32_t)ADC_CAL_GAIN_ONE, 0 };
+    return c;
+}
+
+inline bool adc_calibration_is_valid(const AdcCalibration& c) {
+    return c.gainQ16 >= ADC_CAL_MIN_GAIN && c.gainQ16 <= ADC_CAL_MAX_GAIN &&
+           c.offsetMv >= -ADC_CAL_MAX_OFFSET_MV && c.offsetMv <= ADC_CAL_MAX_OFFSET_MV;
+}
+
+// 標稱每個 count 的 mV (Q16) 乘上校準增益，結果仍為 Q16
+inline int32_t adc_calibration_scale_q16(int32_t nominal_q16, const AdcCalibration& c) {
+    return (int32_t)(((int64_t)nominal_q16 * c.gainQ16 + (ADC_CAL_GAIN_ONE / 2)) >> 16);
+}
+
+// 取樣路徑：原始 count -> 校準後 mV。差分極性取決於接線，只取大小；偏移後小於 0 視為 0
+inline int32_t adc_calibration_apply(int16_t raw, int32_t scale_q16, int32_t offset_mv) {
+    int32_t mv = (int32_t)(((int64_t)raw * scale_q16) >> 16);
+    if (mv < 0) mv = -mv;
+    mv += offset_mv;
+    return mv < 0 ? 0 : mv;
+}
+
+// 校準後 mV 還原為標稱 mV，用來擷取校準點
+inline int32_t adc_calibration_to_nominal(int32_t mv, const AdcCalibration& c) {
+    int64_t num = ((int64_t)mv - c.offsetMv) * ADC_CAL_GAIN_ONE;
+    return (int32_t)((num + (num >= 0 ? c.gainQ16 / 2 : -c.gainQ16 / 2)) / c.gainQ16);
+}
+
+// 兩點校準：nominal 為擷取時的標稱讀值，reference 為外部電錶量得的實際值 (皆為 mV)。
+// 兩點太近或結果超出範圍時回傳 false，out 不變。
+inline bool adc_calibration_solve(int32_t nominal1, int32_t reference1,
+                                  int32_t nominal2, int32_t reference2, AdcCalibration* out) {
+    int64_t span = (int64_t)nominal2 - nominal1;
+    if (span < 0) {
+        span = -span;
+        int32_t t = nominal1; nominal1 = nominal2; nominal2 = t;
+        t = reference1; reference1 = reference2; reference2 = t;
+    }
+    if (span < ADC_CAL_MIN_SPAN_MV) return false;
+    int64_t gain = (((int64_t)reference2 - reference1) * ADC_CAL_GAIN_ONE + span / 2) / span;
+    int64_t scaled = (int64_t)nominal1 * gain;
+    int64_t offset = reference1 - (scaled >= 0 ? (scaled + ADC_CAL_GAIN_ONE / 2) >> 16
+                                               : -((-scaled + ADC_CAL_GAIN_ONE / 2) >> 16));
+    if (gain < ADC_CAL_MIN_GAIN || gain > ADC_CAL_MAX_GAIN) return false;
+    if (offset < -ADC_CAL_MAX_OFFSET_MV || offset > ADC_CAL_MAX_OFFSET_MV) return false;
+    AdcCalibration c = { (int32_t)gain, (int32_t)offset };
+    *out = c;
+    return true;
+}
+
+#endif // ADC_CALIBRATION_H
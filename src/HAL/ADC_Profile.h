@@ -0,0 +1,56 @@
+// src/HAL/ADC_Profile.h
+// ADS1115 每個通道的取樣設定：PGA 滿量程、資料速率 (SPS) 與過取樣次數。
+// 只有型別與換算，不依賴 Adafruit 函式庫，模擬器的基準測試也使用同一份定義。
+
+#ifndef ADC_PROFILE_H
+#define ADC_PROFILE_H
+
+#include <stdint.h>
+
+enum AdcChannel {
+    ADC_CH_VOLTAGE,  // 差分 0-1：輸出電壓分壓
+    ADC_CH_CP,       // 差分 2-3：CP 分壓
+    ADC_CH_COUNT
+};
+
+struct AdcProfile {
+    uint16_t fullScaleMv;   // PGA 滿量程：6144/4096/2048/1024/512/256 (GAIN_TWOTHIRDS..GAIN_SIXTEEN)
+    uint16_t sps;           // 8/16/32/64/128/250/475/860
+    uint8_t oversampling;   // 切換通道前連續取的轉換筆數，每筆都經過濾波管線 (1..ADC_MAX_OVERSAMPLING)
+};
+
+#define ADC_MAX_OVERSAMPLING 64
+
+static const uint16_t ADC_FULL_SCALE_MV[] = { 6144, 4096, 2048, 1024, 512, 256 };
+static const uint16_t ADC_DATA_RATES[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+// 回傳在表中的索引，不在表中回傳 -1
+inline int adc_full_scale_index(uint16_t fullScaleMv) {
+    for (int i = 0; i < (int)(sizeof(ADC_FULL_SCALE_MV) / sizeof(ADC_FULL_SCALE_MV[0])); i++) {
+        if (ADC_FULL_SCALE_MV[i] == fullScaleMv) return i;
+    }
+    return -1;
+}
+
+inline int adc_data_rate_index(uint16_t sps) {
+    for (int i = 0; i < (int)(sizeof(ADC_DATA_RATES) / sizeof(ADC_DATA_RATES[0])); i++) {
+        if (ADC_DATA_RATES[i] == sps) return i;
+    }
+    return -1;
+}
+
+inline bool adc_profile_is_valid(const AdcProfile& p) {
+    return adc_full_scale_index(p.fullScaleMv) >= 0 && adc_data_rate_index(p.sps) >= 0 &&
+           p.oversampling >= 1 && p.oversampling <= ADC_MAX_OVERSAMPLING;
+}
+
+// 切換到此通道後的一個時段：丟棄第一筆再取 oversampling 筆
+inline uint32_t adc_profile_slot_us(const AdcProfile& p) {
+    return (uint32_t)(p.oversampling + 1) * 1000000UL / p.sps;
+}
+
+inline float adc_profile_volts_per_count(const AdcProfile& p) {
+    return p.fullScaleMv / 1000.0f / 32768.0f;
+}
+
+#endif // ADC_PROFILE_H
@@ -2,13 +2,148 @@
 #include "Config.h"
 #include <Adafruit_ADS1X15.h>
 #include "LuxBeacon/LuxBeacon.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "ConfigStore/ConfigStore.h"
+#include "I2C_Bus.h"
 #include <Preferences.h> 
 #include "driver/twai.h"
-#include <Wire.h>
+#include "esp_idf_version.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
 
 static Adafruit_ADS1115 ads;
 
-static bool charge_relay_state = false;
+// --- ADS1115 背景取樣 ---
+// 連續轉換模式下每筆轉換完成時 ALERT/RDY 拉低一次，ISR 只通知 ADC 任務；
+// I2C 讀取、切換通道與濾波都在任務中進行，其他任務只讀取已發布的值。
+static const uint16_t adc_mux[ADC_CH_COUNT] = { ADS1X15_REG_CONFIG_MUX_DIFF_0_1, ADS1X15_REG_CONFIG_MUX_DIFF_2_3 };
+static const float adc_divider_ratio[ADC_CH_COUNT] = { VOLTAGE_DIVIDER_120V_RATIO, VOLTAGE_DIVIDER_CP_RATIO };
+// 與 ADC_Profile.h 的 ADC_FULL_SCALE_MV / ADC_DATA_RATES 順序相同
+static const adsGain_t adc_gain_values[] = { GAIN_TWOTHIRDS, GAIN_ONE, GAIN_TWO, GAIN_FOUR, GAIN_EIGHT, GAIN_SIXTEEN };
+static const uint16_t adc_rate_values[] = {
+    RATE_ADS1115_8SPS, RATE_ADS1115_16SPS, RATE_ADS1115_32SPS, RATE_ADS1115_64SPS,
+    RATE_ADS1115_128SPS, RATE_ADS1115_250SPS, RATE_ADS1115_475SPS, RATE_ADS1115_860SPS
+};
+
+// 只由 ADC 任務存取
+static AdcProfile adc_active[ADC_CH_COUNT];
+static int32_t adc_scale_q16[ADC_CH_COUNT];  // 每個 count 對應分壓前的 mV (含校準增益)，隨滿量程與校準變更
+static int32_t adc_offset_mv[ADC_CH_COUNT];
+static MeasurementPipeline<ADC_VOLTAGE_MEDIAN, ADC_VOLTAGE_EMA_SHIFT> voltage_pipeline;
+static MeasurementPipeline<ADC_CP_MEDIAN, ADC_CP_EMA_SHIFT> cp_pipeline;
+static CpClassifier cp_classifier;
+static uint8_t adc_channel = ADC_CH_VOLTAGE;
+static uint8_t adc_slot_conversions = 0;
+static HalAdcStats adc_stats = {0, 0, 0};
+
+// hal_adc_set_profile() 寫入，ADC 任務在下一次切換通道時套用
+static portMUX_TYPE adc_profile_mux = portMUX_INITIALIZER_UNLOCKED;
+static AdcProfile adc_requested[ADC_CH_COUNT];
+static AdcCalibration adc_calibration[ADC_CH_COUNT];  // 同樣由 adc_profile_mux 保護
+
+// 兩點校準的擷取結果 (標稱 mV / 參考 mV)，只由網頁與 OLED 選單存取
+struct AdcCalPoint {
+    bool captured;
+    int32_t nominalMv;
+    int32_t referenceMv;
+};
+static AdcCalPoint adc_cal_points[ADC_CH_COUNT][2];
+static const char* const ADC_CAL_NAMESPACE = "adc_cal";
+static const char* const adc_cal_keys[ADC_CH_COUNT] = { "voltage", "cp" };
+
+// 32 位元讀寫本身是原子的，讀取端不需要鎖
+static volatile int32_t adc_published_mv[ADC_CH_COUNT];
+static volatile CPState adc_cp_state = CP_STATE_UNKNOWN;
+static volatile int64_t adc_ready_us = 0;  // 最近一次 ALERT/RDY 的時間，用來推算下一筆何時完成
+
+extern TaskHandle_t adcTaskHandle;
+
+static void IRAM_ATTR adc_ready_isr() {
+    adc_ready_us = esp_timer_get_time();
+    if (adcTaskHandle == NULL) return;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(adcTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+}
+
+static volatile bool charge_relay_state = false;
+
+// --- 按鈕 ---
+// 依 ButtonType 的順序
+static const uint8_t button_pins[] = { START_BUTTON_PIN, STOP_BUTTON_PIN, EMERGENCY_BUTTON_PIN, SETTING_BUTTON_PIN };
+#define BUTTON_COUNT (sizeof(button_pins) / sizeof(button_pins[0]))
+static esp_timer_handle_t button_debounce_timers[BUTTON_COUNT];
+static esp_timer_handle_t button_long_press_timers[BUTTON_COUNT];
+static volatile bool button_stable[BUTTON_COUNT];  // 去彈跳後的狀態，只由計時器回呼寫入
+static QueueHandle_t button_queues[BUTTON_CONSUMER_COUNT];
+static volatile bool emergency_tripped = false;
+
+extern TaskHandle_t logicTaskHandle;
+
+static void IRAM_ATTR emergency_trip_from_isr() {
+    digitalWrite(CHARGE_RELAY_PIN, LOW);
+    digitalWrite(VP_RELAY_PIN, LOW);
+    charge_relay_state = false;
+    emergency_tripped = true;
+    if (logicTaskHandle == NULL) return;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(logicTaskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+}
+
+static void IRAM_ATTR button_isr(void* arg) {
+    uint32_t index = (uint32_t)arg;
+    if (index == BUTTON_EMERGENCY && digitalRead(EMERGENCY_BUTTON_PIN) == LOW) {
+        emergency_trip_from_isr();
+    }
+    // 每個邊緣都重新計時，彈跳期間不會產生事件
+    esp_timer_stop(button_debounce_timers[index]);
+    esp_timer_start_once(button_debounce_timers[index], BUTTON_DEBOUNCE_MS * 1000);
+}
+
+// 計時器回呼在 esp_timer 任務中執行，可以直接送佇列
+static void button_post(uint32_t index, ButtonEventType type) {
+    ButtonEvent event = { (ButtonType)index, type, (uint32_t)millis() };
+    for (uint8_t c = 0; c < BUTTON_CONSUMER_COUNT; c++) {
+        xQueueSend(button_queues[c], &event, 0);
+    }
+}
+
+static void button_debounce_cb(void* arg) {
+    uint32_t index = (uint32_t)arg;
+    bool pressed = digitalRead(button_pins[index]) == LOW;
+    if (pressed == button_stable[index]) return;
+    button_stable[index] = pressed;
+    button_post(index, pressed ? BUTTON_EVENT_PRESS : BUTTON_EVENT_RELEASE);
+    if (pressed) {
+        esp_timer_start_once(button_long_press_timers[index], LONG_PRESS_DURATION_MS * 1000);
+    } else {
+        esp_timer_stop(button_long_press_timers[index]);
+    }
+}
+
+static void button_long_press_cb(void* arg) {
+    uint32_t index = (uint32_t)arg;
+    if (button_stable[index]) button_post(index, BUTTON_EVENT_LONG_PRESS);
+}
+
+static void button_init() {
+    for (uint8_t c = 0; c < BUTTON_CONSUMER_COUNT; c++) {
+        button_queues[c] = xQueueCreate(BUTTON_EVENT_QUEUE_LENGTH, sizeof(ButtonEvent));
+    }
+    for (uint32_t i = 0; i < BUTTON_COUNT; i++) {
+        esp_timer_create_args_t args = {};
+        args.arg = (void*)i;
+        args.callback = button_debounce_cb;
+        args.name = "btn_debounce";
+        esp_timer_create(&args, &button_debounce_timers[i]);
+        args.callback = button_long_press_cb;
+        args.name = "btn_long";
+        esp_timer_create(&args, &button_long_press_timers[i]);
+        button_stable[i] = digitalRead(button_pins[i]) == LOW;
+        attachInterruptArg(digitalPinToInterrupt(button_pins[i]), button_isr, (void*)i, CHANGE);
+    }
+}
 
 void hal_init_pins() {
     pinMode(START_BUTTON_PIN, INPUT_PULLUP);
@@ -24,18 +159,30 @@ void hal_init_pins() {
     pinMode(LED_STANDBY_PIN, OUTPUT);
     pinMode(LED_CHARGING_PIN, OUTPUT);
     pinMode(LED_ERROR_PIN, OUTPUT);
+    button_init();
 }
 
 void hal_init_can() {
     // 1. 通用配置: 設定工作模式為Normal, 並指定TX/RX引腳
     twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(TWAI_TX_PIN, TWAI_RX_PIN, TWAI_MODE_NORMAL);
+    g_config.tx_queue_len = CAN_DRIVER_TX_QUEUE_LEN; // 排隊與優先順序由 CAN_TxScheduler 負責
     
     // 2. 時序配置: 設定CAN總線鮑率為 500Kbps
     twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
     
-    // 3. 濾波器配置: 暫時先接收所有報文，方便除錯。
-    //    未來可以設定精確的Filter來只接收需要的ID，以提升性能。
+    // 3. 濾波器配置: 只讓車輛端的 0x500/0x501/0x5F0 進入接收佇列，
+    //    其他共用匯流排上的報文由硬體丟棄，不佔用 CPU。
+#ifdef CAN_ACCEPT_ALL_FRAMES
     twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    Serial.println("HAL: TWAI filter = ACCEPT ALL (debug).");
+#else
+    twai_filter_config_t f_config = {
+        .acceptance_code = CAN_ACCEPTANCE_CODE,
+        .acceptance_mask = CAN_ACCEPTANCE_MASK,
+        .single_filter = false
+    };
+    Serial.printf("HAL: TWAI filter code=0x%08lX mask=0x%08lX\n", (unsigned long)CAN_ACCEPTANCE_CODE, (unsigned long)CAN_ACCEPTANCE_MASK);
+#endif
 
     // 4. 安裝並啟動TWAI驅動
     if (twai_driver_install(&g_config, &t_config, &f_config) != ESP_OK) {
@@ -50,54 +197,259 @@ void hal_init_can() {
 }
 
 
+// 一筆轉換的時間 (us)
+static uint32_t adc_period_us(const AdcProfile& p) {
+    return (1000000UL + p.sps - 1) / p.sps;
+}
+
+// 套用該通道目前要求的設定並開始連續轉換；startADCReading() 同時設定 RDY 所需的門檻暫存器。
+// 呼叫前須已取得 I2C 總線
+static void adc_start_channel(uint8_t channel) {
+    portENTER_CRITICAL(&adc_profile_mux);
+    adc_active[channel] = adc_requested[channel];
+    AdcCalibration cal = adc_calibration[channel];
+    portEXIT_CRITICAL(&adc_profile_mux);
+    const AdcProfile& p = adc_active[channel];
+    ads.setGain(adc_gain_values[adc_full_scale_index(p.fullScaleMv)]);
+    ads.setDataRate(adc_rate_values[adc_data_rate_index(p.sps)]);
+    // 浮點只在切換通道時算一次，取樣路徑只用整數
+    int32_t nominal_q16 = (int32_t)lroundf(adc_profile_volts_per_count(p) * 1000.0f / adc_divider_ratio[channel] * 65536.0f);
+    adc_scale_q16[channel] = adc_calibration_scale_q16(nominal_q16, cal);
+    adc_offset_mv[channel] = cal.offsetMv;
+    adc_channel = channel;
+    adc_slot_conversions = 0;
+    ads.startADCReading(adc_mux[channel], true);
+    i2c_bus_set_adc_due(esp_timer_get_time() + adc_period_us(p));
+}
+
+// NVS 中沒有或內容不合法時使用標稱分壓比
+static void adc_load_calibration() {
+    Preferences prefs;
+    prefs.begin(ADC_CAL_NAMESPACE, true);
+    for (uint8_t ch = 0; ch < ADC_CH_COUNT; ch++) {
+        AdcCalibration cal = adc_calibration_nominal();
+        if (prefs.isKey(adc_cal_keys[ch])) {
+            AdcCalibration stored;
+            if (prefs.getBytes(adc_cal_keys[ch], &stored, sizeof(stored)) == sizeof(stored) &&
+                adc_calibration_is_valid(stored)) {
+                cal = stored;
+            } else {
+                Serial.printf("HAL: Invalid ADC calibration for channel %u in NVS, using nominal.\n", ch);
+            }
+        }
+        adc_calibration[ch] = cal;
+        Serial.printf("HAL: ADC channel %u calibration: gain %.5f, offset %ld mV\n",
+                      ch, cal.gainQ16 / (float)ADC_CAL_GAIN_ONE, (long)cal.offsetMv);
+    }
+    prefs.end();
+}
+
 void hal_init_adc() {
-    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-    Serial.printf("HAL: I2C bus initialized on SDA=%d, SCL=%d\n", I2C_SDA_PIN, I2C_SCL_PIN);
-    if (!ads.begin()) {
+    i2c_bus_init();
+    i2c_bus_acquire(I2C_CLIENT_ADC, 0);
+    bool found = ads.begin();
+    i2c_bus_release(I2C_CLIENT_ADC);
+    if (!found) {
         Serial.println("HAL: Failed to initialize ADS1115. Halting.");
         while (1);
     }
-    ads.setGain(GAIN_ONE);
-    Serial.println("HAL: ADS1115 initialized successfully.");
+    const AdcProfile defaults[ADC_CH_COUNT] = {
+        { ADC_VOLTAGE_FULL_SCALE_MV, ADC_VOLTAGE_SPS, ADC_VOLTAGE_OVERSAMPLING },
+        { ADC_CP_FULL_SCALE_MV, ADC_CP_SPS, ADC_CP_OVERSAMPLING },
+    };
+    for (uint8_t ch = 0; ch < ADC_CH_COUNT; ch++) {
+        if (!adc_profile_is_valid(defaults[ch])) {
+            Serial.printf("HAL: Invalid ADC profile for channel %u in Config.h. Halting.\n", ch);
+            while (1);
+        }
+        adc_requested[ch] = defaults[ch];
+        Serial.printf("HAL: ADC channel %u: +/-%u mV, %u SPS, oversampling %u\n",
+                      ch, defaults[ch].fullScaleMv, defaults[ch].sps, defaults[ch].oversampling);
+    }
+    adc_load_calibration();
+
+    // ALERT/RDY 為開汲極輸出
+    pinMode(ADS_ALERT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(ADS_ALERT_PIN), adc_ready_isr, FALLING);
+    i2c_bus_acquire(I2C_CLIENT_ADC, 0);
+    adc_start_channel(ADC_CH_VOLTAGE);
+    i2c_bus_release(I2C_CLIENT_ADC);
+    Serial.printf("HAL: ADS1115 initialized successfully (continuous, ALERT/RDY on GPIO%d).\n", ADS_ALERT_PIN);
 }
 
-bool hal_get_button_state(ButtonType button) {
-    switch (button) {
-        case BUTTON_START: return (digitalRead(START_BUTTON_PIN) == LOW);
-        case BUTTON_STOP: return (digitalRead(STOP_BUTTON_PIN) == LOW);
-        case BUTTON_EMERGENCY: return (digitalRead(EMERGENCY_BUTTON_PIN) == LOW);
-        case BUTTON_SETTING: return (digitalRead(SETTING_BUTTON_PIN) == LOW);
+void hal_adc_handle_sampling() {
+    // 沒有接 ALERT/RDY 或漏掉中斷時，逾時時間大於一次轉換，暫存器內仍是新的結果
+    const AdcProfile& p = adc_active[adc_channel];
+    uint32_t wait_ms = (1000 + p.sps - 1) / p.sps + ADC_READY_MARGIN_MS;
+    int64_t ready_us;
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) == 0) {
+        adc_stats.readyTimeouts++;
+        ready_us = esp_timer_get_time();
+    } else {
+        ready_us = adc_ready_us;
+    }
+    // OLED 最多只佔用一小塊傳輸時間，這裡的等待有上限。
+    // 讀取與切換通道在同一次持有內完成，中間不讓 OLED 插入
+    if (!i2c_bus_acquire(I2C_CLIENT_ADC, 0)) return;
+    int16_t raw = ads.getLastConversionResults();
+    uint8_t channel = adc_channel;
+    adc_stats.conversions++;
+    // 第一筆可能是切換通道前就開始的轉換，丟棄
+    bool discard = adc_slot_conversions++ == 0;
+    if (adc_slot_conversions > p.oversampling) {
+        uint8_t next = (channel + 1) % ADC_CH_COUNT;
+        if (next == 0) adc_stats.channelCycles++;
+        adc_start_channel(next);
+    } else {
+        i2c_bus_set_adc_due(ready_us + adc_period_us(p));
+    }
+    i2c_bus_release(I2C_CLIENT_ADC);
+    if (discard) return;
+
+    int32_t mv = adc_calibration_apply(raw, adc_scale_q16[channel], adc_offset_mv[channel]);
+    if (channel == ADC_CH_VOLTAGE) {
+        adc_published_mv[ADC_CH_VOLTAGE] = voltage_pipeline.push(mv);
+    } else {
+        int32_t filtered = cp_pipeline.push(mv);
+        adc_published_mv[ADC_CH_CP] = filtered;
+        adc_cp_state = cp_classifier.classify(filtered);
     }
-    return false;
+}
+
+bool hal_adc_set_profile(AdcChannel channel, const AdcProfile& profile) {
+    if (channel >= ADC_CH_COUNT || !adc_profile_is_valid(profile)) return false;
+    portENTER_CRITICAL(&adc_profile_mux);
+    adc_requested[channel] = profile;
+    portEXIT_CRITICAL(&adc_profile_mux);
+    return true;
+}
+
+AdcProfile hal_adc_get_profile(AdcChannel channel) {
+    portENTER_CRITICAL(&adc_profile_mux);
+    AdcProfile p = adc_requested[channel];
+    portEXIT_CRITICAL(&adc_profile_mux);
+    return p;
+}
+
+AdcCalibration hal_adc_get_calibration(AdcChannel channel) {
+    portENTER_CRITICAL(&adc_profile_mux);
+    AdcCalibration c = adc_calibration[channel];
+    portEXIT_CRITICAL(&adc_profile_mux);
+    return c;
+}
+
+bool hal_adc_set_calibration(AdcChannel channel, const AdcCalibration& calibration) {
+    if (channel >= ADC_CH_COUNT || !adc_calibration_is_valid(calibration)) return false;
+    Preferences prefs;
+    prefs.begin(ADC_CAL_NAMESPACE, false);
+    bool ok = prefs.putBytes(adc_cal_keys[channel], &calibration, sizeof(calibration)) == sizeof(calibration);
+    prefs.end();
+    if (!ok) return false;
+    portENTER_CRITICAL(&adc_profile_mux);
+    adc_calibration[channel] = calibration;
+    portEXIT_CRITICAL(&adc_profile_mux);
+    Serial.printf("HAL: ADC channel %u calibration saved: gain %.5f, offset %ld mV\n",
+                  channel, calibration.gainQ16 / (float)ADC_CAL_GAIN_ONE, (long)calibration.offsetMv);
+    return true;
+}
+
+void hal_adc_reset_calibration(AdcChannel channel) {
+    if (channel >= ADC_CH_COUNT) return;
+    Preferences prefs;
+    prefs.begin(ADC_CAL_NAMESPACE, false);
+    prefs.remove(adc_cal_keys[channel]);
+    prefs.end();
+    portENTER_CRITICAL(&adc_profile_mux);
+    adc_calibration[channel] = adc_calibration_nominal();
+    portEXIT_CRITICAL(&adc_profile_mux);
+    adc_cal_points[channel][0].captured = false;
+    adc_cal_points[channel][1].captured = false;
+    Serial.printf("HAL: ADC channel %u calibration reset to nominal.\n", channel);
+}
+
+int32_t hal_adc_read_nominal_mv(AdcChannel channel) {
+    return adc_calibration_to_nominal(adc_published_mv[channel], hal_adc_get_calibration(channel));
+}
+
+bool hal_adc_cal_capture(AdcChannel channel, uint8_t point, int32_t reference_mv) {
+    if (channel >= ADC_CH_COUNT || point > 1 || reference_mv < 0) return false;
+    AdcCalPoint& p = adc_cal_points[channel][point];
+    p.nominalMv = hal_adc_read_nominal_mv(channel);
+    p.referenceMv = reference_mv;
+    p.captured = true;
+    Serial.printf("HAL: ADC channel %u calibration point %u: nominal %ld mV, reference %ld mV\n",
+                  channel, point + 1, (long)p.nominalMv, (long)p.referenceMv);
+    return true;
+}
+
+bool hal_adc_cal_is_captured(AdcChannel channel, uint8_t point) {
+    return channel < ADC_CH_COUNT && point <= 1 && adc_cal_points[channel][point].captured;
+}
+
+bool hal_adc_cal_commit(AdcChannel channel) {
+    if (channel >= ADC_CH_COUNT) return false;
+    const AdcCalPoint* p = adc_cal_points[channel];
+    if (!p[0].captured || !p[1].captured) return false;
+    AdcCalibration cal;
+    if (!adc_calibration_solve(p[0].nominalMv, p[0].referenceMv, p[1].nominalMv, p[1].referenceMv, &cal)) {
+        Serial.printf("HAL: ADC channel %u calibration rejected (points too close or out of range).\n", channel);
+        return false;
+    }
+    if (!hal_adc_set_calibration(channel, cal)) return false;
+    adc_cal_points[channel][0].captured = false;
+    adc_cal_points[channel][1].captured = false;
+    return true;
+}
+
+HalAdcStats hal_adc_get_stats() {
+    return adc_stats;
+}
+
+bool hal_get_button_state(ButtonType button) {
+    return button < BUTTON_COUNT && button_stable[button];
+}
+
+bool hal_button_get_event(ButtonConsumer consumer, ButtonEvent* event) {
+    return xQueueReceive(button_queues[consumer], event, 0) == pdTRUE;
+}
+
+void hal_button_flush(ButtonConsumer consumer) {
+    xQueueReset(button_queues[consumer]);
+}
+
+bool hal_emergency_button_take_trip() {
+    if (!emergency_tripped) return false;
+    emergency_tripped = false;
+    return true;
 }
 
 float hal_read_voltage_sensor() {
     if (digitalRead(CHARGE_RELAY_PIN) == LOW) {
         return 0.0;
     }
-    int16_t adc_raw = ads.readADC_Differential_0_1();
-    float differential_voltage = ads.computeVolts(adc_raw);
-    return abs(differential_voltage) / VOLTAGE_DIVIDER_120V_RATIO;
+    return adc_published_mv[ADC_CH_VOLTAGE] / 1000.0f;
 }
 
 float hal_read_power_supply_voltage() {
-    int16_t adc_raw = ads.readADC_Differential_0_1();
-    float differential_voltage = ads.computeVolts(adc_raw);
-    return abs(differential_voltage) / VOLTAGE_DIVIDER_120V_RATIO;
+    return adc_published_mv[ADC_CH_VOLTAGE] / 1000.0f;
 }
 
 
 float hal_read_cp_voltage() {
-    int16_t adc_raw = ads.readADC_Differential_2_3();
-    float differential_voltage = ads.computeVolts(adc_raw);
-    return abs(differential_voltage) / VOLTAGE_DIVIDER_CP_RATIO;
+    return adc_published_mv[ADC_CH_CP] / 1000.0f;
+}
+
+CPState hal_read_cp_state() {
+    return adc_cp_state;
 }
 
 void hal_control_vp_relay(bool on) {
+    if (on && emergency_tripped) return;
     digitalWrite(VP_RELAY_PIN, on ? HIGH : LOW);
 }
 
 void hal_control_charge_relay(bool on) {
+    if (on && emergency_tripped) return;
     digitalWrite(CHARGE_RELAY_PIN, on ? HIGH : LOW);
     charge_relay_state = on;
 }
@@ -108,10 +460,7 @@ void hal_control_coupler_lock(bool lock) {
 
 void hal_update_leds(LedState state) {
     digitalWrite(LED_STANDBY_PIN, HIGH); // 橘燈始終常亮
-    Preferences prefs;
-    prefs.begin("charger_config", true); 
-    bool beaconUnlocked = prefs.getBool("beacon_unlocked", false);
-    prefs.end();
+    bool beaconUnlocked = config_get_beacon_unlocked();
     #ifdef DEVELOPER_MODE
         beaconUnlocked = true;
     #endif
@@ -140,7 +489,7 @@ void hal_update_leds(LedState state) {
     }
 }
 
-void hal_can_send(unsigned long id, byte* data, byte len) {
+bool hal_can_send(unsigned long id, byte* data, byte len, uint32_t timeout_ms) {
     twai_message_t message;
     message.identifier = id;
     message.flags = TWAI_MSG_FLAG_NONE; // 標準幀
@@ -151,18 +500,21 @@ void hal_can_send(unsigned long id, byte* data, byte len) {
         message.data[i] = data[i];
     }
 
-    // 發送報文，pdMS_TO_TICKS(100) 表示最多等待100ms
-    if (twai_transmit(&message, pdMS_TO_TICKS(100)) != ESP_OK) {
+    // 發送報文，最多等待 timeout_ms 讓驅動的發送佇列空出位置
+    if (twai_transmit(&message, pdMS_TO_TICKS(timeout_ms)) != ESP_OK) {
         Serial.print("!!! HAL: TWAI send FAILED for ID 0x");
         Serial.println(id, HEX);
+        return false;
     }
+    can_trace_record(CAN_TRACE_TX, id, data, len);
+    return true;
 }
 
-bool hal_can_receive(unsigned long* id, byte* len, byte* buf) {
+bool hal_can_receive(unsigned long* id, byte* len, byte* buf, uint32_t timeout_ms) {
     twai_message_t message;
     
-    // 檢查並接收報文，pdMS_TO_TICKS(0) 表示不等待，立刻返回
-    if (twai_receive(&message, pdMS_TO_TICKS(0)) == ESP_OK) {
+    // 由驅動程式的接收佇列喚醒，不需要輪詢；timeout_ms = 0 表示不等待，立刻返回
+    if (twai_receive(&message, pdMS_TO_TICKS(timeout_ms)) == ESP_OK) {
         *id = message.identifier;
         *len = message.data_length_code;
         
@@ -170,12 +522,56 @@ bool hal_can_receive(unsigned long* id, byte* len, byte* buf) {
         for (int i = 0; i < *len; i++) {
             buf[i] = message.data[i];
         }
+        can_trace_record(CAN_TRACE_RX, *id, buf, *len);
         return true;
     }
     
     return false;
 }
 
+bool hal_can_filter_accepts_all() {
+#ifdef CAN_ACCEPT_ALL_FRAMES
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool hal_can_get_status(HalCanStatus* status) {
+    twai_status_info_t info;
+    if (twai_get_status_info(&info) != ESP_OK) {
+        memset(status, 0, sizeof(HalCanStatus));
+        status->state = CAN_BUS_STOPPED;
+        return false;
+    }
+    switch (info.state) {
+        case TWAI_STATE_RUNNING:    status->state = CAN_BUS_RUNNING; break;
+        case TWAI_STATE_BUS_OFF:    status->state = CAN_BUS_OFF; break;
+        case TWAI_STATE_RECOVERING: status->state = CAN_BUS_RECOVERING; break;
+        default:                    status->state = CAN_BUS_STOPPED; break;
+    }
+    status->txErrorCounter = info.tx_error_counter;
+    status->rxErrorCounter = info.rx_error_counter;
+    status->rxMissed = info.rx_missed_count;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    status->rxOverrun = info.rx_overrun_count;
+#else
+    status->rxOverrun = 0;
+#endif
+    status->arbLost = info.arb_lost_count;
+    status->busErrors = info.bus_error_count;
+    status->txFailed = info.tx_failed_count;
+    return true;
+}
+
+bool hal_can_initiate_recovery() {
+    return twai_initiate_recovery() == ESP_OK;
+}
+
+bool hal_can_restart() {
+    return twai_start() == ESP_OK;
+}
+
 bool hal_get_charge_relay_state() {
     return charge_relay_state;
 }
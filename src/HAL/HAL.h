@@ -3,6 +3,10 @@
 
 #include <Arduino.h>
 #include "Charger_Defs.h"
+#include "Config.h"
+#include "ADC_Profile.h"
+#include "ADC_Calibration.h"
+#include "MeasurementFilter.h"
 
 enum ButtonType {
     BUTTON_START,
@@ -11,6 +15,18 @@ enum ButtonType {
     BUTTON_SETTING
 };
 
+// --- TWAI 硬體接收濾波器 (雙濾波器模式，標準幀) ---
+// 濾波器1：0x500 與 0x501 只差最低位，將差異位設為 don't care
+// 濾波器2：0x5F0 完全比對
+// 若修改了 Config.h 的 ID 使兩者差異更多位，濾波器1 會放行較多 ID，多出的報文仍由軟體丟棄
+constexpr uint32_t CAN_FILTER1_ID = VEHICLE_STATUS_ID & VEHICLE_PARAMS_ID;
+constexpr uint32_t CAN_FILTER1_DONT_CARE = VEHICLE_STATUS_ID ^ VEHICLE_PARAMS_ID;
+constexpr uint32_t CAN_FILTER2_ID = VEHICLE_EMERGENCY_ID;
+// 遮罩位為 1 表示不比對。濾波器1 佔 bit31-21 (ID)、bit20 (RTR)、bit19-16 與 bit3-0 (第一個資料位元組)；濾波器2 佔 bit15-5 (ID)、bit4 (RTR)
+constexpr uint32_t CAN_ACCEPTANCE_CODE = (CAN_FILTER1_ID << 21) | (CAN_FILTER2_ID << 5);
+constexpr uint32_t CAN_ACCEPTANCE_MASK = (CAN_FILTER1_DONT_CARE << 21) | (1UL << 20) | (0xFUL << 16) |
+                                         (1UL << 4) | 0xFUL;
+
 // 初始化函數
 void hal_init_pins();
 void hal_init_can();
@@ -25,15 +41,106 @@ void hal_control_vp_relay(bool on);
 bool hal_get_charge_relay_state();
 
 // 輸入讀取
-bool hal_get_button_state(ButtonType button);
+bool hal_get_button_state(ButtonType button); // 去彈跳後的狀態
+
+// 按鈕事件：GPIO 中斷 (雙邊緣) 重新啟動該按鈕的去彈跳計時器，電位穩定 BUTTON_DEBOUNCE_MS 後才產生按下/放開，
+// 按住超過 LONG_PRESS_DURATION_MS 再產生一次長按。每個事件都送到所有消費者的佇列，佇列滿時丟棄新事件。
+enum ButtonEventType {
+    BUTTON_EVENT_PRESS,
+    BUTTON_EVENT_RELEASE,
+    BUTTON_EVENT_LONG_PRESS
+};
+struct ButtonEvent {
+    ButtonType button;
+    ButtonEventType type;
+    uint32_t timeMs;
+};
+enum ButtonConsumer {
+    BUTTON_CONSUMER_LOGIC,
+    BUTTON_CONSUMER_UI,
+    BUTTON_CONSUMER_COUNT
+};
+bool hal_button_get_event(ButtonConsumer consumer, ButtonEvent* event); // 不阻塞，沒有事件時回傳 false
+void hal_button_flush(ButtonConsumer consumer);
+// 緊急停止按鈕按下時，ISR 不等去彈跳就直接斷開充電與 VP 繼電器並通知 Logic 任務；
+// 在 Logic 取走之前，繼電器拒絕再閉合。回傳是否觸發過，並清除
+bool hal_emergency_button_take_trip();
+// 電壓讀取只回傳 ADC 任務發布的濾波值，不存取 I2C，可在任何任務中呼叫
 float hal_read_voltage_sensor();
 float hal_read_power_supply_voltage();
 float hal_read_cp_voltage();
+// CP 分類由 ADC 任務對每筆濾波後的樣本執行 (遲滯 CP_HYSTERESIS_MV)；尚無樣本時為 CP_STATE_UNKNOWN
+CPState hal_read_cp_state();
 // 注意：hal_read_current_sensor() 已被移除，因為電流是從CAN讀取或由邏輯層模擬，不屬於HAL的職責
 
+// CP 電壓 (mV) 分類：進入 OFF/ON 需離邊界 CP_HYSTERESIS_MV 以上，已在該狀態時超出邊界同樣距離才離開。
+// HAL 與模擬器共用，兩者的判斷完全相同。
+static const MeasurementBand CP_BANDS[] = {
+    { 0, CP_OFF_MAX_MV - CP_HYSTERESIS_MV },             // CP_STATE_OFF
+    { CP_ON_MIN_MV + CP_HYSTERESIS_MV, CP_ON_MAX_MV },   // CP_STATE_ON
+};
+
+class CpClassifier {
+public:
+    CpClassifier() : bands_(CP_BANDS) {}
+    void reset() { bands_.reset(); }
+    CPState classify(int32_t mv) {
+        switch (bands_.classify(mv)) {
+            case 0: return CP_STATE_OFF;
+            case 1: return CP_STATE_ON;
+            default: return CP_STATE_ERROR;
+        }
+    }
+
+private:
+    HysteresisClassifier<CP_HYSTERESIS_MV, 2> bands_;
+};
+
+// ADS1115 背景取樣：由 main.cpp 的 ADC 任務反覆呼叫，等待 ALERT/RDY 後讀取一筆轉換，
+// 經濾波管線 (中位數 -> EMA) 後立即發布，該通道取滿過取樣筆數後切換到下一個通道
+void hal_adc_handle_sampling();
+// 設定不合法時回傳 false；新設定在該通道下一次開始取樣時生效
+bool hal_adc_set_profile(AdcChannel channel, const AdcProfile& profile);
+AdcProfile hal_adc_get_profile(AdcChannel channel);
+
+// 分壓校準存在 NVS ("adc_cal")，開機時載入；與取樣設定一樣在該通道下一次開始取樣時生效
+AdcCalibration hal_adc_get_calibration(AdcChannel channel);
+bool hal_adc_set_calibration(AdcChannel channel, const AdcCalibration& calibration); // 不合法或寫入失敗時回傳 false
+void hal_adc_reset_calibration(AdcChannel channel);  // 清除 NVS 中的校準，回到標稱分壓比
+int32_t hal_adc_read_nominal_mv(AdcChannel channel); // 目前的濾波值以標稱分壓比表示
+
+// 兩點校準：在兩個已知電壓下各擷取一次 (point 0/1，reference 為電錶讀值)，commit 計算並儲存
+bool hal_adc_cal_capture(AdcChannel channel, uint8_t point, int32_t reference_mv);
+bool hal_adc_cal_is_captured(AdcChannel channel, uint8_t point);
+bool hal_adc_cal_commit(AdcChannel channel);
+
+struct HalAdcStats {
+    uint32_t conversions;    // 讀取的轉換筆數 (含切換通道後丟棄的)
+    uint32_t readyTimeouts;  // 等不到 ALERT/RDY 而改為直接讀取的次數
+    uint32_t channelCycles;  // 兩個通道都更新一次的輪數
+};
+HalAdcStats hal_adc_get_stats();
+
 // CAN 通訊接口
-void hal_can_send(unsigned long id, byte* data, byte len);
-bool hal_can_receive(unsigned long* id, byte* len, byte* buf);
+bool hal_can_send(unsigned long id, byte* data, byte len, uint32_t timeout_ms = 100);
+// timeout_ms = 0 時立即返回；大於 0 時阻塞等待直到收到報文或超時
+bool hal_can_receive(unsigned long* id, byte* len, byte* buf, uint32_t timeout_ms = 0);
+bool hal_can_filter_accepts_all(); // 硬體濾波器是否處於除錯用的全收模式
+
+// 控制器狀態與自驅動安裝以來的累計計數
+struct HalCanStatus {
+    CanBusState state;
+    uint32_t txErrorCounter;
+    uint32_t rxErrorCounter;
+    uint32_t rxMissed;
+    uint32_t rxOverrun;
+    uint32_t arbLost;
+    uint32_t busErrors;
+    uint32_t txFailed;
+};
+bool hal_can_get_status(HalCanStatus* status);
+bool hal_can_initiate_recovery(); // 只能在 bus-off 時呼叫，完成後控制器處於 STOPPED
+bool hal_can_restart();           // 恢復完成後重新啟動控制器
 
 
 #endif // HAL_H
\ No newline at end of file
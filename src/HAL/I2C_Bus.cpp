@@ -0,0 +1,115 @@
+// src/HAL/I2C_Bus.cpp
+
+#include "I2C_Bus.h"
+#include "Config.h"
+#include <Wire.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static SemaphoreHandle_t bus_mutex = NULL;     // 互斥鎖有優先級繼承，ADC 任務等待時 UI 任務會暫時升級
+static SemaphoreHandle_t adc_window = NULL;    // ADC 每次 release 時給出，OLED 在這之後的空檔傳送
+static volatile int64_t adc_due_us = 0;
+
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static I2cBusStats stats;
+static int64_t acquired_at_us[I2C_CLIENT_COUNT];
+
+void i2c_bus_init() {
+    if (bus_mutex != NULL) return;
+    bus_mutex = xSemaphoreCreateMutex();
+    adc_window = xSemaphoreCreateBinary();
+    if (bus_mutex == NULL || adc_window == NULL) {
+        Serial.println("FATAL: Failed to create I2C bus semaphores!");
+        while (1);
+    }
+    memset(&stats, 0, sizeof(stats));
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_BUS_FREQUENCY_HZ);
+    Serial.printf("I2C: Bus initialized on SDA=%d, SCL=%d at %lu Hz\n",
+                  I2C_SDA_PIN, I2C_SCL_PIN, (unsigned long)I2C_BUS_FREQUENCY_HZ);
+}
+
+uint32_t i2c_bus_transfer_us(uint32_t bytes) {
+    return (uint32_t)(((uint64_t)bytes * 9 + 2) * 1000000ULL / I2C_BUS_FREQUENCY_HZ);
+}
+
+// 到 ADC 下一筆轉換前可用的空檔；ADC 沒有排定或已經逾時很久 (沒接 RDY、ADC 停止) 時不再讓路
+static uint32_t adc_window_us(int64_t now) {
+    int64_t due = adc_due_us;
+    if (due == 0) return UINT32_MAX;
+    if (now > due + I2C_ADC_STALE_US) return UINT32_MAX;
+    int64_t window = due - I2C_ADC_GUARD_US - now;
+    return window > 0 ? (uint32_t)window : 0;
+}
+
+static void record_grant(I2cClient client, int64_t requested_us) {
+    int64_t now = esp_timer_get_time();
+    acquired_at_us[client] = now;
+    uint32_t wait = (uint32_t)(now - requested_us);
+    portENTER_CRITICAL(&stats_mux);
+    if (wait > stats.maxWaitUs[client]) stats.maxWaitUs[client] = wait;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+bool i2c_bus_acquire(I2cClient client, uint32_t expected_us) {
+    uint32_t window_us;
+    return i2c_bus_acquire_window(client, expected_us, &window_us);
+}
+
+bool i2c_bus_acquire_window(I2cClient client, uint32_t min_us, uint32_t* window_us) {
+    int64_t requested = esp_timer_get_time();
+    int64_t deadline = requested + (int64_t)I2C_BUS_TIMEOUT_MS * 1000;
+    for (;;) {
+        int64_t now = esp_timer_get_time();
+        if (now >= deadline) break;
+        TickType_t ticks = pdMS_TO_TICKS((deadline - now + 999) / 1000);
+        if (xSemaphoreTake(bus_mutex, ticks) != pdTRUE) break;
+        uint32_t window = client == I2C_CLIENT_ADC ? UINT32_MAX : adc_window_us(esp_timer_get_time());
+        if (window >= min_us) {
+            *window_us = window;
+            record_grant(client, requested);
+            return true;
+        }
+        // 放不下：讓出總線，等 ADC 讀完下一筆再試；ADC 沒有如期讀取時等待逾時後照樣重試
+        xSemaphoreGive(bus_mutex);
+        portENTER_CRITICAL(&stats_mux);
+        stats.deferred++;
+        portEXIT_CRITICAL(&stats_mux);
+        xSemaphoreTake(adc_window, 0);
+        xSemaphoreTake(adc_window, pdMS_TO_TICKS(I2C_ADC_WINDOW_WAIT_MS));
+    }
+    portENTER_CRITICAL(&stats_mux);
+    stats.timeouts++;
+    portEXIT_CRITICAL(&stats_mux);
+    return false;
+}
+
+void i2c_bus_release(I2cClient client) {
+    uint32_t held = (uint32_t)(esp_timer_get_time() - acquired_at_us[client]);
+    portENTER_CRITICAL(&stats_mux);
+    stats.transactions[client]++;
+    stats.busyUs[client] += held;
+    if (held > stats.maxHoldUs[client]) stats.maxHoldUs[client] = held;
+    portEXIT_CRITICAL(&stats_mux);
+    xSemaphoreGive(bus_mutex);
+    if (client == I2C_CLIENT_ADC) xSemaphoreGive(adc_window);
+}
+
+void i2c_bus_set_adc_due(int64_t due_us) {
+    adc_due_us = due_us;
+}
+
+void i2c_bus_record_display_frame(uint32_t frame_us) {
+    portENTER_CRITICAL(&stats_mux);
+    stats.displayFrames++;
+    stats.lastFrameUs = frame_us;
+    if (frame_us > stats.maxFrameUs) stats.maxFrameUs = frame_us;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+I2cBusStats i2c_bus_get_stats() {
+    portENTER_CRITICAL(&stats_mux);
+    I2cBusStats s = stats;
+    portEXIT_CRITICAL(&stats_mux);
+    return s;
+}
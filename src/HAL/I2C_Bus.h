@@ -0,0 +1,51 @@
+// src/HAL/I2C_Bus.h
+// OLED (SSD1306) 與 ADS1115 共用的 I2C 總線仲裁。每個使用者在存取 Wire 前後呼叫 acquire/release。
+// ADC 讀取優先：ADC 每次讀完公布下一筆轉換完成的時間，OLED 只在放得進這段空檔時才取得總線，
+// 否則等到下一次 ADC 讀取結束再傳。OLED 以 i2c_bus_acquire_window() 取得實際空檔，每塊傳送量剛好填滿空檔。
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+enum I2cClient {
+    I2C_CLIENT_ADC,      // 電壓與 CP 取樣，安全相關
+    I2C_CLIENT_DISPLAY,  // OLED 畫面與偵測
+    I2C_CLIENT_COUNT
+};
+
+struct I2cBusStats {
+    uint32_t transactions[I2C_CLIENT_COUNT];
+    uint64_t busyUs[I2C_CLIENT_COUNT];     // 持有總線的累計時間，除以經過時間即為佔用率
+    uint32_t maxWaitUs[I2C_CLIENT_COUNT];  // acquire 到取得總線的最長時間
+    uint32_t maxHoldUs[I2C_CLIENT_COUNT];
+    uint32_t deferred;                     // OLED 為了讓 ADC 讀取而延後的次數
+    uint32_t timeouts;
+    uint32_t displayFrames;                // 完整送出的 OLED 畫面
+    uint32_t lastFrameUs;                  // 送出一整個畫面的時間 (含等待 ADC 空檔)
+    uint32_t maxFrameUs;
+};
+
+// 以 I2C_SDA_PIN / I2C_SCL_PIN / I2C_BUS_FREQUENCY_HZ 啟動 Wire；可重複呼叫
+void i2c_bus_init();
+
+// expected_us：預計持有總線的時間 (見 i2c_bus_transfer_us)，OLED 依此判斷是否放得進 ADC 的空檔。
+// 超過 I2C_BUS_TIMEOUT_MS 取不到時回傳 false，此時不可存取 Wire 也不可 release。
+bool i2c_bus_acquire(I2cClient client, uint32_t expected_us);
+// 同 i2c_bus_acquire，取得時 *window_us 為到 ADC 下一筆轉換 (扣掉 I2C_ADC_GUARD_US) 的空檔，至少 min_us；
+// ADC 沒有排定或已停止時為 UINT32_MAX
+bool i2c_bus_acquire_window(I2cClient client, uint32_t min_us, uint32_t* window_us);
+void i2c_bus_release(I2cClient client);
+
+// ADC 公布下一筆轉換完成的時間 (esp_timer_get_time() 的 us)；0 表示目前沒有排定
+void i2c_bus_set_adc_due(int64_t due_us);
+
+// 在 I2C_BUS_FREQUENCY_HZ 下傳送 bytes 個位元組 (含位址) 的時間，每個位元組 9 個時脈加上 START/STOP
+uint32_t i2c_bus_transfer_us(uint32_t bytes);
+
+// OLED 送完一整個畫面後回報所花的時間
+void i2c_bus_record_display_frame(uint32_t frame_us);
+
+I2cBusStats i2c_bus_get_stats();
+
+#endif // I2C_BUS_H
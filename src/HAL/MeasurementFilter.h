@@ -0,0 +1,158 @@
+// src/HAL/MeasurementFilter.h
+// 定點數量測管線：中位數去除突波 -> EMA 平滑 -> 遲滯分類。
+// 係數由樣板參數在編譯期決定，全部為整數運算，不依賴 Arduino，可在主機端測試與量測 (模擬器 --bench-filter)。
+
+#ifndef MEASUREMENT_FILTER_H
+#define MEASUREMENT_FILTER_H
+
+#include <stdint.h>
+
+// 最近 N 筆的中位數；N 為奇數。未滿 N 筆時取已有樣本的中位數 (偶數筆取較小的中間值)
+template <uint8_t N>
+class MedianFilter {
+    static_assert(N >= 1 && N <= 9 && (N & 1), "median window must be odd and at most 9");
+public:
+    MedianFilter() { reset(); }
+    void reset() { count_ = 0; index_ = 0; }
+
+    int32_t push(int32_t x) {
+        window_[index_] = x;
+        index_ = (uint8_t)((index_ + 1) % N);
+        if (count_ < N) count_++;
+        // 插入排序一份副本，N 最多 9，比維護有序結構便宜
+        int32_t sorted[N];
+        for (uint8_t i = 0; i < count_; i++) {
+            int32_t v = window_[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        return sorted[(count_ - 1) / 2];
+    }
+
+private:
+    int32_t window_[N];
+    uint8_t count_;
+    uint8_t index_;
+};
+
+// 最常用的 3 點：以 min/max 求中位數，不需要排序與分支
+template <>
+class MedianFilter<3> {
+public:
+    MedianFilter() { reset(); }
+    void reset() { a_ = b_ = c_ = 0; count_ = 0; }
+
+    int32_t push(int32_t x) {
+        a_ = b_;
+        b_ = c_;
+        c_ = x;
+        if (count_ < 3) {
+            count_++;
+            if (count_ == 1) return x;
+            if (count_ == 2) return b_ < c_ ? b_ : c_;
+        }
+        int32_t lo = a_ < b_ ? a_ : b_;
+        int32_t hi = a_ < b_ ? b_ : a_;
+        int32_t m = hi < c_ ? hi : c_;
+        return lo > m ? lo : m;
+    }
+
+private:
+    int32_t a_, b_, c_;
+    uint8_t count_;
+};
+
+template <>
+class MedianFilter<1> {
+public:
+    void reset() {}
+    int32_t push(int32_t x) { return x; }
+};
+
+// 一階 IIR：y += (x - y) / 2^Shift。狀態多保留 Shift 位小數，定值輸入時輸出與輸入完全相同，不會因截斷而偏低。
+// 第一筆直接作為初值。輸入的絕對值需小於 2^(31 - Shift)。
+template <uint8_t Shift>
+class EmaFilter {
+    static_assert(Shift <= 12, "EMA shift too large");
+public:
+    EmaFilter() { reset(); }
+    void reset() { primed_ = false; acc_ = 0; }
+
+    int32_t push(int32_t x) {
+        if (!primed_) {
+            acc_ = x * (int32_t)(1L << Shift);
+            primed_ = true;
+        } else {
+            acc_ += x - round_shift(acc_);
+        }
+        return round_shift(acc_);
+    }
+
+    int32_t value() const { return round_shift(acc_); }
+
+private:
+    // 四捨五入 (遠離零)，正負輸入對稱
+    static int32_t round_shift(int32_t v) {
+        if (Shift == 0) return v;
+        const int32_t half = (int32_t)(1L << Shift) / 2;
+        return v >= 0 ? (v + half) >> Shift : -((-v + half) >> Shift);
+    }
+
+    int32_t acc_;
+    bool primed_;
+};
+
+template <uint8_t MedianN, uint8_t EmaShift>
+class MeasurementPipeline {
+public:
+    void reset() { median_.reset(); ema_.reset(); }
+    int32_t push(int32_t x) { return ema_.push(median_.push(x)); }
+    int32_t value() const { return ema_.value(); }
+
+private:
+    MedianFilter<MedianN> median_;
+    EmaFilter<EmaShift> ema_;
+};
+
+// 進入區間需落在 [lo, hi]；已在區間內時放寬到 [lo - Hyst, hi + Hyst] 才離開，避免在邊界上跳動
+struct MeasurementBand {
+    int32_t lo;
+    int32_t hi;
+};
+
+template <int32_t Hyst, uint8_t N>
+class HysteresisClassifier {
+public:
+    static const int8_t NONE = -1;
+
+    explicit HysteresisClassifier(const MeasurementBand (&bands)[N]) : bands_(bands), current_(NONE) {}
+    void reset() { current_ = NONE; }
+
+    // 回傳區間索引，不在任何區間時回傳 NONE
+    int8_t classify(int32_t x) {
+        if (current_ != NONE) {
+            const MeasurementBand& b = bands_[current_];
+            if (x >= b.lo - Hyst && x <= b.hi + Hyst) return current_;
+        }
+        current_ = NONE;
+        for (uint8_t i = 0; i < N; i++) {
+            if (x >= bands_[i].lo && x <= bands_[i].hi) {
+                current_ = (int8_t)i;
+                break;
+            }
+        }
+        return current_;
+    }
+
+    int8_t current() const { return current_; }
+
+private:
+    const MeasurementBand* bands_;
+    int8_t current_;
+};
+
+#endif // MEASUREMENT_FILTER_H
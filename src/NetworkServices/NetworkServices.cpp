@@ -5,11 +5,15 @@
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <DNSServer.h>
-#include <Preferences.h>
 #include "ArduinoJson.h"
 #include <LittleFS.h>
 #include <Update.h>
 #include "OTAManager/OTAManager.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "HAL/HAL.h"
+#include "ConfigStore/ConfigStore.h"
+#include "PowerSupplyController/PowerSupplyController.h"
+#include <memory>
 
 // --- 私有變數 ---
 static AsyncWebServer server(80);
@@ -20,7 +24,6 @@ static bool should_reboot = false;
 // --- [新增] 引用外部的 OTA 觸發函數 ---
 extern void ota_start_check();
 extern void ota_start_update();
-extern void logic_save_web_settings(unsigned int current, int soc);
 
 enum WiFiState {
     WIFI_STATE_INIT,
@@ -73,6 +76,87 @@ static void startWebServer() {
         json_doc["is_fault"] = network_display_data.isFaultLatched;
         json_doc["last_fault_flags"] = network_display_data.lastFaultFlags;
         json_doc["last_valid_req_current"] = network_display_data.lastValidRequestedCurrent;
+        json_doc["can_timeout"] = network_display_data.vehicleCanTimeout;
+
+        // 電流閉迴路：追蹤誤差為目標 - 量測，修改路徑為 /current_loop
+        PscCurrentLoopConfig loop_config = psc_get_current_loop_config();
+        JsonObject current_loop = json_doc["current_loop"].to<JsonObject>();
+        current_loop["enabled"] = loop_config.enabled;
+        current_loop["active"] = network_display_data.currentLoopActive;
+        current_loop["voltage_limited"] = psc_get_current_loop_status().voltageLimited;
+        current_loop["kp"] = loop_config.kp;
+        current_loop["ki"] = loop_config.ki;
+        current_loop["max_trim"] = loop_config.maxTrim_mA / 1000.0;
+        current_loop["max_over"] = PSC_CURRENT_LOOP_MAX_OVER_MA / 1000.0;
+        current_loop["error"] = network_display_data.currentTrackingError;
+        current_loop["trim"] = network_display_data.currentLoopTrim;
+
+        // 車輛報文接收時序，用於調整 CAN_VEHICLE_TIMEOUT_MS
+        static const char* const vehicle_msg_ids[VEHICLE_MSG_COUNT] = {"0x500", "0x501", "0x5F0"};
+        JsonArray vehicle_can = json_doc["vehicle_can"].to<JsonArray>();
+        for (int i = 0; i < VEHICLE_MSG_COUNT; i++) {
+            const CAN_Rx_Timing& t = network_display_data.vehicleRx[i];
+            JsonObject msg = vehicle_can.add<JsonObject>();
+            msg["id"] = vehicle_msg_ids[i];
+            msg["count"] = t.count;
+            if (network_display_data.vehicleRxAgeMs[i] == UINT32_MAX) msg["age_ms"] = -1;
+            else msg["age_ms"] = network_display_data.vehicleRxAgeMs[i];
+            msg["rate_hz"] = t.meanIntervalUs > 0 ? 1000000.0 / t.meanIntervalUs : 0.0;
+            msg["jitter_ms"] = t.jitterUs / 1000.0;
+            msg["max_interval_ms"] = t.maxIntervalUs / 1000.0;
+            msg["gaps"] = t.gaps;
+        }
+
+        // CAN 控制器健康狀態，計數為開機以來的累計值
+        static const char* const bus_state_names[] = {"stopped", "running", "bus_off", "recovering"};
+        const CAN_Bus_Health& bus = network_display_data.canBus;
+        JsonObject can_bus = json_doc["can_bus"].to<JsonObject>();
+        can_bus["state"] = bus_state_names[bus.state];
+        can_bus["error_passive"] = bus.errorPassive;
+        can_bus["tec"] = bus.txErrorCounter;
+        can_bus["rec"] = bus.rxErrorCounter;
+        can_bus["rx_missed"] = bus.rxMissed;
+        can_bus["rx_overrun"] = bus.rxOverrun;
+        can_bus["arb_lost"] = bus.arbLost;
+        can_bus["bus_errors"] = bus.busErrors;
+        can_bus["tx_failed"] = bus.txFailed;
+        can_bus["bus_off_count"] = bus.busOffCount;
+        can_bus["recoveries"] = bus.recoveries;
+
+        // CAN 報文記錄器，下載路徑為 /can_trace
+        CAN_Trace_Status trace = can_trace_get_status();
+        JsonObject can_trace = json_doc["can_trace"].to<JsonObject>();
+        can_trace["ready"] = trace.ready;
+        can_trace["psram"] = trace.inPsram;
+        can_trace["capacity"] = trace.capacity;
+        can_trace["recorded"] = trace.recorded;
+        can_trace["capturing"] = trace.captureArmed;
+        can_trace["fault_captured"] = trace.faultCaptured;
+        can_trace["fault_held"] = trace.faultHeld;
+        can_trace["fault_frames"] = trace.faultFrames;
+        can_trace["fault_trigger"] = trace.lastTrigger == CAN_TRACE_TRIGGER_EMERGENCY ? "emergency" :
+                                     trace.lastTrigger == CAN_TRACE_TRIGGER_FAULT ? "fault" : "none";
+        can_trace["fault_trigger_ms"] = trace.faultTriggerMs;
+
+        // ADS1115 各通道目前的取樣設定與校準，修改路徑為 /adc_profile 與 /adc_calibration
+        static const char* const adc_channel_names[ADC_CH_COUNT] = {"voltage", "cp"};
+        JsonObject adc = json_doc["adc"].to<JsonObject>();
+        for (int ch = 0; ch < ADC_CH_COUNT; ch++) {
+            AdcProfile p = hal_adc_get_profile((AdcChannel)ch);
+            JsonObject profile = adc[adc_channel_names[ch]].to<JsonObject>();
+            profile["full_scale_mv"] = p.fullScaleMv;
+            profile["sps"] = p.sps;
+            profile["oversampling"] = p.oversampling;
+            profile["slot_ms"] = adc_profile_slot_us(p) / 1000.0;
+            AdcCalibration cal = hal_adc_get_calibration((AdcChannel)ch);
+            JsonObject calibration = profile["calibration"].to<JsonObject>();
+            calibration["gain"] = cal.gainQ16 / (double)ADC_CAL_GAIN_ONE;
+            calibration["offset_mv"] = cal.offsetMv;
+            calibration["reading_v"] = ch == ADC_CH_VOLTAGE ? hal_read_power_supply_voltage() : hal_read_cp_voltage();
+            calibration["nominal_mv"] = hal_adc_read_nominal_mv((AdcChannel)ch);
+            calibration["point1"] = hal_adc_cal_is_captured((AdcChannel)ch, 0);
+            calibration["point2"] = hal_adc_cal_is_captured((AdcChannel)ch, 1);
+        }
 
         // --- [新增] 填充 OTA 數據 ---
         json_doc["current_fw_version"] = network_display_data.currentFirmwareVersion;
@@ -93,6 +177,134 @@ static void startWebServer() {
         request->send(LittleFS, "/index.html", "text/html");
     });
 
+    // CAN 報文記錄下載：source=live|fault (預設 fault)，format=candump|asc (預設 candump)
+    server.on("/can_trace", HTTP_GET, [](AsyncWebServerRequest *request){
+        CanTraceSource source = CAN_TRACE_SOURCE_FAULT;
+        CanTraceFormat format = CAN_TRACE_FORMAT_CANDUMP;
+        if (request->hasParam("source") && request->getParam("source")->value() == "live") {
+            source = CAN_TRACE_SOURCE_LIVE;
+        }
+        if (request->hasParam("format") && request->getParam("format")->value() == "asc") {
+            format = CAN_TRACE_FORMAT_ASC;
+        }
+        CAN_Trace_Status trace = can_trace_get_status();
+        if (!trace.ready || (source == CAN_TRACE_SOURCE_FAULT && !trace.faultCaptured)) {
+            request->send(404, "text/plain", trace.ready ? "No fault window captured yet." : "CAN trace disabled.");
+            return;
+        }
+
+        // 游標隨回應一起釋放；每次只填入完整的行，不需要一次產生整個檔案
+        std::shared_ptr<CAN_Trace_Cursor> cursor(new CAN_Trace_Cursor);
+        can_trace_open(*cursor, source, format);
+        AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return can_trace_read(*cursor, (char*)buffer, maxLen);
+            });
+        String filename = String("can_trace_") + (source == CAN_TRACE_SOURCE_LIVE ? "live" : "fault") +
+                          (format == CAN_TRACE_FORMAT_ASC ? ".asc" : ".log");
+        response->addHeader("Content-Disposition", "attachment; filename=" + filename);
+        request->send(response);
+    });
+
+    // 捨棄故障視窗，下一次故障重新記錄 (視窗被完整下載後也會自動釋放)
+    server.on("/can_trace_clear", HTTP_POST, [](AsyncWebServerRequest *request){
+        can_trace_clear_fault();
+        request->send(200, "text/plain", "OK");
+    });
+
+    // 執行中調整 ADS1115 通道設定 (不儲存，重開機回到 Config.h 的預設值)：
+    // channel=voltage|cp，full_scale_mv / sps / oversampling 未提供的保持原值
+    server.on("/adc_profile", HTTP_POST, [](AsyncWebServerRequest *request){
+        if (!request->hasParam("channel", true)) {
+            request->send(400, "text/plain", "Missing channel.");
+            return;
+        }
+        String name = request->getParam("channel", true)->value();
+        AdcChannel channel;
+        if (name == "voltage") channel = ADC_CH_VOLTAGE;
+        else if (name == "cp") channel = ADC_CH_CP;
+        else {
+            request->send(400, "text/plain", "Unknown channel.");
+            return;
+        }
+        AdcProfile current = hal_adc_get_profile(channel);
+        long full_scale = current.fullScaleMv, sps = current.sps, oversampling = current.oversampling;
+        if (request->hasParam("full_scale_mv", true)) full_scale = request->getParam("full_scale_mv", true)->value().toInt();
+        if (request->hasParam("sps", true)) sps = request->getParam("sps", true)->value().toInt();
+        if (request->hasParam("oversampling", true)) oversampling = request->getParam("oversampling", true)->value().toInt();
+        // 先檢查範圍再縮成欄位寬度，避免溢位後剛好落在合法值
+        AdcProfile profile = { (uint16_t)full_scale, (uint16_t)sps, (uint8_t)oversampling };
+        if (full_scale < 0 || full_scale > 0xFFFF || sps < 0 || sps > 0xFFFF || oversampling < 1 ||
+            oversampling > ADC_MAX_OVERSAMPLING || !hal_adc_set_profile(channel, profile)) {
+            request->send(400, "text/plain", "Invalid profile.");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
+    // 執行中調整電流閉迴路 (不儲存，重開機回到 Config.h 的預設值)：
+    // enabled=0|1、kp、ki (1/s)、max_trim (A)，未提供的保持原值
+    server.on("/current_loop", HTTP_POST, [](AsyncWebServerRequest *request){
+        PscCurrentLoopConfig config = psc_get_current_loop_config();
+        if (request->hasParam("enabled", true)) config.enabled = request->getParam("enabled", true)->value().toInt() != 0;
+        if (request->hasParam("kp", true)) config.kp = request->getParam("kp", true)->value().toFloat();
+        if (request->hasParam("ki", true)) config.ki = request->getParam("ki", true)->value().toFloat();
+        if (request->hasParam("max_trim", true)) {
+            float max_trim = request->getParam("max_trim", true)->value().toFloat();
+            config.maxTrim_mA = max_trim >= 0.0f && max_trim <= 100.0f ? (int32_t)lroundf(max_trim * 1000.0f) : -1;
+        }
+        if (!psc_set_current_loop_config(config)) {
+            request->send(400, "text/plain", "Invalid current loop settings.");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
+    // 兩點分壓校準 (儲存在 NVS)：channel=voltage|cp，
+    // action=point1|point2 以 reference (電錶量得的 V) 擷取目前讀值，save 計算並儲存，reset 回到標稱分壓比
+    server.on("/adc_calibration", HTTP_POST, [](AsyncWebServerRequest *request){
+        if (!request->hasParam("channel", true) || !request->hasParam("action", true)) {
+            request->send(400, "text/plain", "Missing channel or action.");
+            return;
+        }
+        String name = request->getParam("channel", true)->value();
+        AdcChannel channel;
+        if (name == "voltage") channel = ADC_CH_VOLTAGE;
+        else if (name == "cp") channel = ADC_CH_CP;
+        else {
+            request->send(400, "text/plain", "Unknown channel.");
+            return;
+        }
+        String action = request->getParam("action", true)->value();
+        if (action == "point1" || action == "point2") {
+            if (!request->hasParam("reference", true)) {
+                request->send(400, "text/plain", "Missing reference.");
+                return;
+            }
+            float reference = request->getParam("reference", true)->value().toFloat();
+            if (reference < 0.0f || reference > 1000.0f ||
+                !hal_adc_cal_capture(channel, action == "point1" ? 0 : 1, (int32_t)lroundf(reference * 1000.0f))) {
+                request->send(400, "text/plain", "Invalid reference.");
+                return;
+            }
+        } else if (action == "save") {
+            if (!hal_adc_cal_is_captured(channel, 0) || !hal_adc_cal_is_captured(channel, 1)) {
+                request->send(400, "text/plain", "Capture both points first.");
+                return;
+            }
+            if (!hal_adc_cal_commit(channel)) {
+                request->send(400, "text/plain", "Calibration rejected: points too close or result out of range.");
+                return;
+            }
+        } else if (action == "reset") {
+            hal_adc_reset_calibration(channel);
+        } else {
+            request->send(400, "text/plain", "Unknown action.");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
     server.on("/save_settings", HTTP_POST, [](AsyncWebServerRequest *request){
         unsigned int current = 0;
         int soc = 0;
@@ -104,8 +316,10 @@ static void startWebServer() {
             soc = request->getParam("target_soc", true)->value().toInt();
         }
 
-        // 呼叫 logic 層的函式來儲存設定
-        logic_save_web_settings(current, soc);
+        // 傳入 0 表示該欄位未修改，沿用目前設定
+        config_set_charge_settings(config_get_max_voltage(),
+                                   current != 0 ? current : config_get_max_current(),
+                                   soc != 0 ? soc : config_get_target_soc());
 
         request->send(200, "text/plain", "OK");
     });
@@ -128,11 +342,7 @@ static void startWebServer() {
         Serial.print("SSID: "); Serial.println(ssid);
         Serial.print("Password: "); Serial.println(pass);
 
-        Preferences prefs;
-        prefs.begin("wifi_config", false);
-        prefs.putString("ssid", ssid);
-        prefs.putString("pass", pass);
-        prefs.end();
+        config_set_wifi_credentials(ssid.c_str(), pass.c_str());
 
         String response_html = R"rawliteral(
             <!DOCTYPE html>
@@ -148,6 +358,7 @@ static void startWebServer() {
         request->send(200, "text/html", response_html);
         
         delay(1000);
+        config_flush();
         ESP.restart();
     });
 
@@ -276,11 +487,10 @@ void net_handle_tasks(DisplayData& data) {
 
     switch (wifiState) {
         case WIFI_STATE_INIT: {
-            Preferences prefs;
-            prefs.begin("wifi_config", true);
-            String ssid = prefs.getString("ssid", "");
-            String pass = prefs.getString("pass", "");
-            prefs.end();
+            ChargerConfig config;
+            config_get(config);
+            String ssid = config.wifiSsid;
+            String pass = config.wifiPass;
             if (ssid.length() > 0) {
                 Serial.print("WiFi: Trying to connect to '");
                 Serial.print(ssid);
@@ -338,18 +548,16 @@ void net_handle_tasks(DisplayData& data) {
         Serial.println("Reboot requested by manual update. Rebooting in 1 second...");
         should_reboot = false; // 清除旗標
         delay(1000); // 等待 Web Server 回應完成
+        config_flush();
         ESP.restart();
     }
 }
 
 void net_reset_wifi_credentials() {
     Serial.println("NET: Resetting WiFi credentials...");
-    Preferences prefs;
-    prefs.begin("wifi_config", false);
-    prefs.remove("ssid");
-    prefs.remove("pass");
-    prefs.end();
+    config_set_wifi_credentials("", "");
     Serial.println("NET: WiFi credentials cleared. Rebooting...");
     delay(1000);
+    config_flush();
     ESP.restart();
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <HTTPUpdate.h>
 #include <WiFi.h>
 #include "Version.h"
+#include "ConfigStore/ConfigStore.h"
 #include <Update.h>
 #include <LittleFS.h>
 
@@ -269,6 +270,7 @@ static void perform_firmware_update() {
                 statusMessage = "FW Success! Rebooting...";
                 ota_step = 0;
                 delay(1000);
+                config_flush();
                 ESP.restart();
             } else {
                 Update.printError(Serial);
@@ -337,6 +339,7 @@ static void perform_filesystem_update() {
                     ota_step = 0;
                 }
                 delay(1000);
+                config_flush();
                 ESP.restart();
             } else { 
                 Update.printError(Serial); 
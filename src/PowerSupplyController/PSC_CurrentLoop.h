@@ -0,0 +1,147 @@
+// src/PowerSupplyController/PSC_CurrentLoop.h
+// 電流閉迴路：依電源回報的電流修正送給電源的設定值，讓實際電流追上目標 (BMS 請求與使用者上限取小者)。
+// 送出值 = 目標 (前饋) + 修正量；修正量為 PI：kp * e + ∫ ki * e dt，e = 目標 - 量測。
+// 修正量向下最多 maxTrim (送出值不低於 0)，向上最多 min(maxTrim, maxOver)：送出值不會超過目標 maxOver 以上，
+// 目標 (BMS 請求與使用者上限) 是限制電源輸出電流的唯一依據。
+// 抗積分飽和：修正量被限制時，不再往飽和的方向積分，積分項本身也限制在同一範圍，目標下降後可以立即退出飽和；
+// 目標下降時積分依比例縮小 (增益誤差與電流成正比)，不把大電流時學到的修正帶到小電流；
+// 之後電流仍在往下走的期間誤差來自電源本身的響應，不加比例項、不積分，避免把下衝放大。
+// 電流降到目標、開始回升或經過 PSC_CURRENT_LOOP_SETTLE_S 後恢復正常運作。
+// 電源進入定電壓 (量測電壓達到設定值) 時電流不受設定值控制：停止積分、不做正向修正，積分以 PSC_CURRENT_LOOP_BLEED_S 逐漸歸零。
+// 每筆遙測更新一次，dt 由遙測的接收時間計算；遙測中斷時 dt 上限為 PSC_CURRENT_LOOP_MAX_DT_S，不會一次積分過多。
+// 不依賴 Arduino，模擬器的 --bench-current-loop 以會過衝、有增益誤差的電源模型測試同一份實作。
+
+#ifndef PSC_CURRENT_LOOP_H
+#define PSC_CURRENT_LOOP_H
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#define PSC_CURRENT_LOOP_MAX_DT_S 0.05f
+#define PSC_CURRENT_LOOP_BLEED_S  1.0f   // 定電壓期間積分歸零的時間常數
+#define PSC_CURRENT_LOOP_SETTLE_S 1.0f   // 目標下降後暫停修正的最長時間
+
+struct PscCurrentLoopConfig {
+    bool enabled;
+    float kp;            // 每 mA 誤差的修正量 (mA/mA)
+    float ki;            // 1/s
+    int32_t maxTrim_mA;  // 修正量上限 (正負相同)
+};
+
+struct PscCurrentLoopStatus {
+    bool active;           // 啟用、Logic 要求穩流且電源以二進位框架回報時才運作
+    bool saturated;        // 修正量達到上限
+    bool voltageLimited;   // 電源在定電壓，暫停積分
+    int32_t reference_mA;  // 斜坡後的目標
+    int32_t measured_mA;
+    int32_t error_mA;      // 追蹤誤差 = 目標 - 量測
+    int32_t trim_mA;       // 加在目標上的修正量
+    uint32_t updates;
+};
+
+class PscCurrentLoop {
+public:
+    PscCurrentLoop() {
+        memset(&status_, 0, sizeof(status_));
+        configure(0.0f, 0.0f, 0, 0);
+        reset();
+    }
+
+    void configure(float kp, float ki, int32_t max_trim_mA, int32_t max_over_mA) {
+        kp_ = kp;
+        ki_ = ki;
+        maxTrim_ = max_trim_mA;
+        maxOver_ = max_over_mA;
+    }
+
+    void reset() {
+        integral_ = 0.0f;
+        lastReference_ = 0;
+        lastMeasured_ = 0;
+        settling_ = false;
+        settleTime_ = 0.0f;
+        status_.saturated = false;
+        status_.voltageLimited = false;
+        status_.error_mA = 0;
+        status_.trim_mA = 0;
+    }
+
+    // 以一筆量測更新，回傳修正量 (mA)；目標為 0 或未設定時回到初始狀態。
+    // voltage_limited：電源回報的電壓已達設定值 (定電壓)
+    int32_t update(int32_t reference_mA, int32_t measured_mA, float dt_s, bool voltage_limited = false) {
+        status_.reference_mA = reference_mA;
+        status_.measured_mA = measured_mA;
+        status_.updates++;
+        if (reference_mA <= 0) {
+            reset();
+            return 0;
+        }
+        if (dt_s > PSC_CURRENT_LOOP_MAX_DT_S) dt_s = PSC_CURRENT_LOOP_MAX_DT_S;
+        if (dt_s < 0.0f) dt_s = 0.0f;
+
+        if (lastReference_ > 0 && reference_mA < lastReference_) {
+            integral_ *= (float)reference_mA / (float)lastReference_;
+            settling_ = true;
+            settleTime_ = 0.0f;
+        } else if (settling_) {
+            settleTime_ += dt_s;
+            if (measured_mA <= reference_mA || measured_mA > lastMeasured_ || settleTime_ >= PSC_CURRENT_LOOP_SETTLE_S) {
+                settling_ = false;
+            }
+        }
+        lastReference_ = reference_mA;
+        lastMeasured_ = measured_mA;
+
+        float e = (float)(reference_mA - measured_mA);
+        float hi = (float)(maxTrim_ < maxOver_ ? maxTrim_ : maxOver_);
+        float lo = -(float)(maxTrim_ < reference_mA ? maxTrim_ : reference_mA);
+        if (voltage_limited) {
+            // 誤差來自定電壓而非設定值，只保留逐漸歸零的負向修正
+            float bleed = dt_s / PSC_CURRENT_LOOP_BLEED_S;
+            integral_ -= integral_ * (bleed < 1.0f ? bleed : 1.0f);
+            integral_ = integral_ > 0.0f ? 0.0f : integral_ < lo ? lo : integral_;
+            status_.saturated = false;
+            status_.voltageLimited = true;
+            status_.error_mA = reference_mA - measured_mA;
+            status_.trim_mA = (int32_t)lroundf(integral_);
+            return status_.trim_mA;
+        }
+        status_.voltageLimited = false;
+        float integral = settling_ ? integral_ : integral_ + ki_ * e * dt_s;
+        float u = settling_ ? integral : kp_ * e + integral;
+        bool saturated = false;
+        if (u > hi) {
+            u = hi;
+            saturated = true;
+            if (e > 0.0f) integral = integral_;
+        } else if (u < lo) {
+            u = lo;
+            saturated = true;
+            if (e < 0.0f) integral = integral_;
+        }
+        integral_ = integral > hi ? hi : integral < lo ? lo : integral;
+
+        status_.saturated = saturated;
+        status_.error_mA = reference_mA - measured_mA;
+        status_.trim_mA = (int32_t)lroundf(u);
+        return status_.trim_mA;
+    }
+
+    int32_t trim() const { return status_.trim_mA; }
+    const PscCurrentLoopStatus& status() const { return status_; }
+
+private:
+    float kp_;
+    float ki_;
+    int32_t maxTrim_;
+    int32_t maxOver_;
+    int32_t lastReference_;
+    int32_t lastMeasured_;
+    bool settling_;        // 目標下降後電流仍在往下走
+    float settleTime_;
+    float integral_;
+    PscCurrentLoopStatus status_;
+};
+
+#endif // PSC_CURRENT_LOOP_H
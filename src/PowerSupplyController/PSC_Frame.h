@@ -0,0 +1,165 @@
+// src/PowerSupplyController/PSC_Frame.h
+// 電源 UART 的二進位框架協議，協商成功後取代文字協議 (見 PSC_Parser.h 的 PSC_BINARY_REQUEST)。
+// 每個框架：COBS(type, seq, body..., crc16_lo, crc16_hi) + 0x00 分隔。
+// CRC 為 CRC-16/CCITT-FALSE (多項式 0x1021，初值 0xFFFF)，涵蓋 type 到 body 的最後一個位元組。
+// 多位元組欄位一律 little-endian。COBS 編碼後資料中不會出現 0x00，任何位置丟失位元組都在下一個 0x00 重新同步。
+//
+//   TELEMETRY   電源 -> MCU  seq 每筆遞增，可計算遺失筆數    body: int32 mV, int32 mA
+//   SET         MCU -> 電源  seq 為 MCU 的指令序號             body: int32 mV, int32 mA
+//                            -1 (PSC_SETPOINT_UNSET) 表示該項不變更；兩項一起套用，任一項超出範圍時整筆拒絕
+//   ACK         電源 -> MCU  seq 為被確認的指令序號             body: uint8 狀態 (PSC_ACK_*)
+//   PING        MCU -> 電源  每 PSC_PING_INTERVAL_MS 一次       body: uint32 MCU 的 micros()
+//   PONG        電源 -> MCU  seq 與 body 原樣送回，用於計算 RTT
+//
+// 電源超過 PSC_LINK_REVERT_MS 沒收到 MCU 的有效框架 (PING 也算) 時自行退回文字協議，
+// 因此任一方重新開機後都會經由文字協議重新協商。
+// 不依賴 Arduino，模擬器的電源模型使用同一份實作。
+
+#ifndef PSC_FRAME_H
+#define PSC_FRAME_H
+
+#include <stdint.h>
+#include <string.h>
+
+enum PscFrameType {
+    PSC_FRAME_TELEMETRY   = 0x01,
+    PSC_FRAME_SET         = 0x02,   // 0x03 保留 (曾為分開的電壓/電流設定)
+    PSC_FRAME_ACK         = 0x04,
+    PSC_FRAME_PING        = 0x05,
+    PSC_FRAME_PONG        = 0x06
+};
+
+#define PSC_ACK_APPLIED  0
+#define PSC_ACK_REJECTED 1   // 超出電源的範圍，未套用
+
+#define PSC_FRAME_MAX_BODY    8
+#define PSC_FRAME_MAX_PAYLOAD (2 + PSC_FRAME_MAX_BODY + 2)
+#define PSC_FRAME_MAX_ENCODED (PSC_FRAME_MAX_PAYLOAD + 1)   // 254 bytes 以內 COBS 只多 1 byte
+#define PSC_FRAME_MAX_WIRE    (PSC_FRAME_MAX_ENCODED + 1)   // 加上 0x00 分隔
+
+// --- 協議時序 ---
+#define PSC_NEGOTIATE_TIMEOUT_MS 300   // 送出請求後等待接受行的時間
+#define PSC_NEGOTIATE_ATTEMPTS   3     // 都沒有回應時視為舊電源，直到斷線重連前維持文字協議
+#define PSC_PING_INTERVAL_MS     100
+#define PSC_BINARY_TIMEOUT_MS    250   // 二進位模式下超過此時間沒收到遙測視為斷線 (電源以 100 Hz 回報)
+#define PSC_LINK_REVERT_MS       1000
+#define PSC_ACK_TIMEOUT_MS       50
+#define PSC_SET_ATTEMPTS         3     // 同一筆 SET 都沒有 ACK 時視為斷線
+
+inline uint16_t psc_crc16(const uint8_t* data, uint8_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+inline void psc_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+inline uint32_t psc_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 組成完整框架 (含結尾 0x00) 寫入 out，out 至少 PSC_FRAME_MAX_WIRE bytes；回傳長度，body 過長時回傳 0
+inline uint8_t psc_frame_encode(uint8_t type, uint8_t seq, const uint8_t* body, uint8_t len, uint8_t* out) {
+    if (len > PSC_FRAME_MAX_BODY) return 0;
+    uint8_t payload[PSC_FRAME_MAX_PAYLOAD];
+    payload[0] = type;
+    payload[1] = seq;
+    if (len) memcpy(&payload[2], body, len);
+    uint16_t crc = psc_crc16(payload, (uint8_t)(2 + len));
+    payload[2 + len] = (uint8_t)crc;
+    payload[3 + len] = (uint8_t)(crc >> 8);
+    uint8_t n = (uint8_t)(4 + len);
+
+    // COBS：每段以 (到下一個 0 的距離) 開頭，取代資料中的 0
+    uint8_t code_pos = 0;
+    uint8_t o = 1;
+    uint8_t code = 1;
+    for (uint8_t i = 0; i < n; i++) {
+        if (payload[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = payload[i];
+            code++;
+        }
+    }
+    out[code_pos] = code;
+    out[o++] = 0;
+    return o;
+}
+
+struct PscFrame {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    uint8_t body[PSC_FRAME_MAX_BODY];
+};
+
+// 逐位元組接收框架；緩衝固定大小，不配置記憶體
+class PscFrameDecoder {
+public:
+    enum Result { NONE, FRAME, CRC_ERROR, FRAMING_ERROR };
+
+    PscFrameDecoder() { reset(); }
+    void reset() {
+        len_ = 0;
+        overflow_ = false;
+    }
+
+    Result feed(uint8_t c, PscFrame& out) {
+        if (c != 0) {
+            if (len_ < PSC_FRAME_MAX_ENCODED) buf_[len_++] = c;
+            else overflow_ = true;
+            return NONE;
+        }
+        uint8_t len = len_;
+        bool overflow = overflow_;
+        reset();
+        if (len == 0 && !overflow) return NONE;   // 連續的 0x00 可用於重新同步
+        if (overflow) return FRAMING_ERROR;
+        return decode(len, out);
+    }
+
+private:
+    Result decode(uint8_t len, PscFrame& out) {
+        uint8_t payload[PSC_FRAME_MAX_PAYLOAD];
+        uint8_t n = 0;
+        uint8_t i = 0;
+        while (i < len) {
+            uint8_t code = buf_[i++];
+            if (i + code - 1 > len) return FRAMING_ERROR;
+            for (uint8_t j = 1; j < code; j++) {
+                if (n >= PSC_FRAME_MAX_PAYLOAD) return FRAMING_ERROR;
+                payload[n++] = buf_[i++];
+            }
+            // 最後一段之後的 0 是分隔本身，不屬於資料
+            if (code < 0xFF && i < len) {
+                if (n >= PSC_FRAME_MAX_PAYLOAD) return FRAMING_ERROR;
+                payload[n++] = 0;
+            }
+        }
+        if (n < 4) return FRAMING_ERROR;
+        uint16_t crc = (uint16_t)(payload[n - 2] | (payload[n - 1] << 8));
+        if (psc_crc16(payload, (uint8_t)(n - 2)) != crc) return CRC_ERROR;
+        out.type = payload[0];
+        out.seq = payload[1];
+        out.len = (uint8_t)(n - 4);
+        memcpy(out.body, &payload[2], out.len);
+        return FRAME;
+    }
+
+    uint8_t buf_[PSC_FRAME_MAX_ENCODED];
+    uint8_t len_;
+    bool overflow_;
+};
+
+#endif // PSC_FRAME_H
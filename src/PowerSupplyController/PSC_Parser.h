@@ -0,0 +1,261 @@
+// src/PowerSupplyController/PSC_Parser.h
+// 電源 UART 協議的接收端：固定大小的環形緩衝 + 逐位元組的狀態機解析，全程不配置記憶體。
+// 遙測行為 "V=<數字>,I=<數字>\n"，前後可有空白、\t 與 \r；數字為 [+-]?整數[.小數] 或 [+-]?.小數，
+// 整數部分最多 PSC_MAX_INT_DIGITS 位。結果以千分之一單位 (mV / mA) 的整數輸出，小數第四位四捨五入。
+// 不符合格式或超過 PSC_LINE_MAX 的行整行丟棄，直到下一個 \n 才重新開始。
+// 另外辨識電源對 PSC_BINARY_REQUEST 的回覆 PSC_BINARY_ACCEPT，之後的資料改為二進位框架 (見 PSC_Frame.h)。
+// 不依賴 Arduino，模擬器的 --bench-psc / --fuzz-psc 測試同一份實作。
+
+#ifndef PSC_PARSER_H
+#define PSC_PARSER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PSC_LINE_MAX 128
+#define PSC_MAX_INT_DIGITS 6   // 999999.999 * 1000 仍在 int32 範圍內
+
+// 協議協商：MCU 送出請求行，支援二進位框架的電源回覆接受行後切換；舊電源忽略請求，繼續使用文字協議
+#define PSC_BINARY_REQUEST "PROTO:BIN1"
+#define PSC_BINARY_ACCEPT  "PROTO:BIN1 OK"
+
+// 單一生產者/單一消費者的位元組環形緩衝；N 為 2 的次方，索引自由遞增，以差值計算資料量
+template <uint16_t N>
+class PscRingBuffer {
+    static_assert(N >= 2 && N <= 32768 && (N & (N - 1)) == 0, "ring size must be a power of two");
+public:
+    PscRingBuffer() { reset(); }
+    void reset() { head_ = tail_ = 0; dropped_ = 0; }
+
+    uint16_t available() const { return (uint16_t)(head_ - tail_); }
+    uint16_t space() const { return (uint16_t)(N - available()); }
+
+    // 可直接寫入的連續空間 (到陣列尾端為止)，寫完以 commit() 確認；UART 可以直接讀進來，不經過暫存
+    uint16_t write_region(uint8_t** dst) {
+        uint16_t offset = head_ & (N - 1);
+        uint16_t contiguous = N - offset;
+        uint16_t free_bytes = space();
+        *dst = &buf_[offset];
+        return free_bytes < contiguous ? free_bytes : contiguous;
+    }
+    void commit(uint16_t n) { head_ = (uint16_t)(head_ + n); }
+
+    // 放不下的部分丟棄並計數，回傳實際寫入的數量
+    uint16_t write(const uint8_t* data, uint16_t len) {
+        uint16_t written = 0;
+        while (written < len) {
+            uint8_t* dst;
+            uint16_t n = write_region(&dst);
+            if (n == 0) break;
+            if (n > len - written) n = len - written;
+            memcpy(dst, data + written, n);
+            commit(n);
+            written += n;
+        }
+        dropped_ += (uint32_t)(len - written);
+        return written;
+    }
+
+    bool read(uint8_t& c) {
+        if (head_ == tail_) return false;
+        c = buf_[tail_ & (N - 1)];
+        tail_++;
+        return true;
+    }
+
+    uint32_t dropped() const { return dropped_; }
+
+private:
+    uint8_t buf_[N];
+    volatile uint16_t head_;
+    volatile uint16_t tail_;
+    uint32_t dropped_;
+};
+
+struct PscTelemetry {
+    int32_t voltage_mV;
+    int32_t current_mA;
+};
+
+struct PscParserStats {
+    uint32_t lines;      // 成功解析的遙測行
+    uint32_t malformed;  // 非空白但不符合格式的行 (含過長)
+    uint32_t overlong;
+};
+
+class PscParser {
+public:
+    enum Result { NONE, TELEMETRY, MALFORMED, HANDSHAKE };
+
+    PscParser() { reset(); }
+    void reset() {
+        start_line();
+        memset(&stats_, 0, sizeof(stats_));
+    }
+
+    Result feed(uint8_t c, PscTelemetry& out) {
+        if (c == '\n') return end_line(out);
+        if (state_ == S_DISCARD) return NONE;
+        if (++length_ > PSC_LINE_MAX) {
+            stats_.overlong++;
+            return discard();
+        }
+        switch (state_) {
+        case S_LEADING:
+            if (is_space(c)) return NONE;
+            if (c == (uint8_t)PSC_BINARY_ACCEPT[0]) {
+                keyword_pos_ = 1;
+                state_ = S_KEYWORD;
+                return NONE;
+            }
+            if (c != 'V') return discard();
+            state_ = S_EQUALS;
+            return NONE;
+        case S_KEYWORD:
+            if (c != (uint8_t)PSC_BINARY_ACCEPT[keyword_pos_]) return discard();
+            if (++keyword_pos_ == sizeof(PSC_BINARY_ACCEPT) - 1) {
+                field_ = FIELD_KEYWORD;
+                state_ = S_TRAILING;
+            }
+            return NONE;
+        case S_EQUALS:
+            if (c != '=') return discard();
+            begin_number();
+            state_ = S_NUMBER;
+            return NONE;
+        case S_NUMBER:
+            if (number_char(c)) return NONE;
+            if (!number_done()) return discard();
+            if (field_ == 0 && c == ',') {
+                voltage_ = number_value();
+                field_ = 1;
+                state_ = S_FIELD_I;
+                return NONE;
+            }
+            if (field_ == 1 && is_space(c)) {
+                value_ = number_value();
+                state_ = S_TRAILING;
+                return NONE;
+            }
+            return discard();
+        case S_FIELD_I:
+            if (c != 'I') return discard();
+            state_ = S_EQUALS;
+            return NONE;
+        case S_TRAILING:
+            return is_space(c) ? NONE : discard();
+        default:
+            return NONE;
+        }
+    }
+
+    const PscParserStats& stats() const { return stats_; }
+
+private:
+    enum State { S_LEADING, S_KEYWORD, S_EQUALS, S_NUMBER, S_FIELD_I, S_TRAILING, S_DISCARD };
+    enum { FIELD_KEYWORD = 2 };  // field_：0 = V、1 = I
+
+    static bool is_space(uint8_t c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    void start_line() {
+        state_ = S_LEADING;
+        length_ = 0;
+        field_ = 0;
+    }
+
+    Result discard() {
+        state_ = S_DISCARD;
+        return NONE;
+    }
+
+    Result end_line(PscTelemetry& out) {
+        State state = state_;
+        bool empty = state == S_LEADING;
+        bool ok = (state == S_NUMBER && field_ == 1 && number_done()) || state == S_TRAILING;
+        bool keyword = ok && field_ == FIELD_KEYWORD;
+        if (ok && state == S_NUMBER) value_ = number_value();
+        start_line();
+        if (empty) return NONE;
+        if (keyword) return HANDSHAKE;
+        if (!ok) {
+            stats_.malformed++;
+            return MALFORMED;
+        }
+        out.voltage_mV = voltage_;
+        out.current_mA = value_;
+        stats_.lines++;
+        return TELEMETRY;
+    }
+
+    // --- 數字 ---
+    void begin_number() {
+        negative_ = false;
+        sign_allowed_ = true;
+        in_fraction_ = false;
+        int_digits_ = 0;
+        frac_digits_ = 0;
+        milli_ = 0;
+        round_up_ = false;
+        round_seen_ = false;
+    }
+
+    // 屬於數字的字元回傳 true；整數位數過多時轉為丟棄狀態，同樣回傳 true
+    bool number_char(uint8_t c) {
+        if (sign_allowed_ && (c == '+' || c == '-')) {
+            negative_ = c == '-';
+            sign_allowed_ = false;
+            return true;
+        }
+        sign_allowed_ = false;
+        if (c >= '0' && c <= '9') {
+            uint8_t d = (uint8_t)(c - '0');
+            if (!in_fraction_) {
+                if (++int_digits_ > PSC_MAX_INT_DIGITS) {
+                    discard();
+                    return true;
+                }
+                milli_ = milli_ * 10 + d * 1000;
+            } else {
+                frac_digits_++;
+                if (frac_digits_ == 1) milli_ += d * 100;
+                else if (frac_digits_ == 2) milli_ += d * 10;
+                else if (frac_digits_ == 3) milli_ += d;
+                else if (!round_seen_) {
+                    round_up_ = d >= 5;
+                    round_seen_ = true;
+                }
+            }
+            return true;
+        }
+        if (c == '.' && !in_fraction_) {
+            in_fraction_ = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool number_done() const { return int_digits_ > 0 || frac_digits_ > 0; }
+
+    int32_t number_value() const {
+        int32_t v = milli_ + (round_up_ ? 1 : 0);
+        return negative_ ? -v : v;
+    }
+
+    State state_;
+    uint16_t length_;
+    uint8_t field_;
+    uint8_t keyword_pos_;
+    bool negative_;
+    bool sign_allowed_;
+    bool in_fraction_;
+    bool round_up_;
+    bool round_seen_;
+    uint8_t int_digits_;
+    uint8_t frac_digits_;
+    int32_t milli_;
+    int32_t voltage_;
+    int32_t value_;
+    PscParserStats stats_;
+};
+
+#endif // PSC_PARSER_H
@@ -0,0 +1,159 @@
+// src/PowerSupplyController/PSC_Setpoint.h
+// 電源設定值管理：電壓與電流合併成一筆指令，限制指令頻率，電流上升時依斜率逐步逼近目標。
+// 目標可隨時更新，由呼叫 poll() 的任務 (PSC 接收任務) 決定何時送出；數值一律以 mV / mA 整數處理，
+// 與上次送出的差值超過 deadband 才送，避免浮點比較與 BMS 請求的微小跳動造成多餘的指令。
+// 電流下降立即生效 (BMS 降低請求、重置時不能等斜坡)，上升則每秒最多 ramp mA。
+// 閉迴路修正後的電流不超過目標 + set_trim_limit() 的餘裕 (預設 0)，不論修正量為何。
+// 不依賴 Arduino，模擬器的 --bench-psc-link 測試同一份實作。
+
+#ifndef PSC_SETPOINT_H
+#define PSC_SETPOINT_H
+
+#include <stdint.h>
+
+#define PSC_SETPOINT_UNSET (-1)          // 尚未設定，指令中表示不變更此項
+#define PSC_SETPOINT_IDLE  0xFFFFFFFFUL  // due_in()：沒有待送的變更
+
+struct PscSetpointCommand {
+    int32_t voltage_mV;   // PSC_SETPOINT_UNSET 表示不變更
+    int32_t current_mA;
+};
+
+struct PscSetpointStats {
+    uint32_t commands;         // 送出的指令 (電壓與電流合併為一筆)
+    uint32_t deferred;         // 因頻率限制而延後的指令 (期間的變更合併到同一筆)
+    int32_t targetVoltage_mV;  // Logic 設定的目標
+    int32_t targetCurrent_mA;
+    int32_t rampCurrent_mA;    // 斜坡目前的電流
+    int32_t commandCurrent_mA; // 最後送出的電流 (斜坡 + 閉迴路修正，見 PSC_CurrentLoop.h)
+};
+
+class PscSetpointManager {
+public:
+    PscSetpointManager() {
+        configure(100, 20000, 50);
+        set_trim_limit(0);
+        reset();
+    }
+
+    void configure(uint32_t min_interval_ms, uint32_t ramp_mA_per_s, int32_t deadband) {
+        minInterval_ = min_interval_ms;
+        ramp_ = ramp_mA_per_s;
+        deadband_ = deadband;
+    }
+    void set_min_interval(uint32_t min_interval_ms) { minInterval_ = min_interval_ms; }
+    void set_trim_limit(int32_t max_over_mA) { maxOver_ = max_over_mA; }
+
+    void reset() {
+        stats_.commands = 0;
+        stats_.deferred = 0;
+        stats_.targetVoltage_mV = PSC_SETPOINT_UNSET;
+        stats_.targetCurrent_mA = PSC_SETPOINT_UNSET;
+        stats_.rampCurrent_mA = PSC_SETPOINT_UNSET;
+        stats_.commandCurrent_mA = PSC_SETPOINT_UNSET;
+        trim_ = 0;
+        sentVoltage_ = PSC_SETPOINT_UNSET;
+        sentCurrent_ = PSC_SETPOINT_UNSET;
+        sent_ = false;
+        deferring_ = false;
+        rampMs_ = 0;
+    }
+
+    // 電源可能已重置 (重新連線)：下一次 poll() 不論差值都送出；斜坡從現在繼續，不補上斷線期間的時間
+    void invalidate(uint32_t now_ms) {
+        sentVoltage_ = PSC_SETPOINT_UNSET;
+        sentCurrent_ = PSC_SETPOINT_UNSET;
+        rampMs_ = now_ms;
+    }
+
+    // 以最新的目標推進斜坡；需要送出時回傳 true 並填入 cmd，呼叫端必須實際送出。
+    // trim_mA 加在斜坡電流上 (閉迴路修正)，結果不低於 0
+    bool poll(int32_t target_mV, int32_t target_mA, uint32_t now_ms, PscSetpointCommand& cmd, int32_t trim_mA = 0) {
+        stats_.targetVoltage_mV = target_mV;
+        stats_.targetCurrent_mA = target_mA;
+        trim_ = trim_mA;
+        advance_ramp(now_ms);
+        if (!changed()) return false;
+        if (sent_ && now_ms - lastSendMs_ < minInterval_) {
+            if (!deferring_) stats_.deferred++;
+            deferring_ = true;
+            return false;
+        }
+        deferring_ = false;
+        cmd.voltage_mV = stats_.targetVoltage_mV;
+        cmd.current_mA = command_current();
+        stats_.commandCurrent_mA = cmd.current_mA;
+        sentVoltage_ = cmd.voltage_mV;
+        sentCurrent_ = cmd.current_mA;
+        sent_ = true;
+        lastSendMs_ = now_ms;
+        stats_.commands++;
+        return true;
+    }
+
+    // 距離下一次需要 poll() 的時間 (ms)：斜坡進行中或有延後的變更時不為 PSC_SETPOINT_IDLE
+    uint32_t due_in(uint32_t now_ms) const {
+        if (!changed()) return ramping() ? minInterval_ : PSC_SETPOINT_IDLE;   // 斜坡尚未累積超過 deadband
+        if (!sent_) return 0;
+        uint32_t elapsed = now_ms - lastSendMs_;
+        return elapsed >= minInterval_ ? 0 : minInterval_ - elapsed;
+    }
+
+    const PscSetpointStats& stats() const { return stats_; }
+
+private:
+    bool ramping() const {
+        return stats_.rampCurrent_mA != PSC_SETPOINT_UNSET && stats_.rampCurrent_mA < stats_.targetCurrent_mA;
+    }
+
+    static bool differs(int32_t value, int32_t sent, int32_t deadband) {
+        if (value == PSC_SETPOINT_UNSET) return false;
+        if (sent == PSC_SETPOINT_UNSET) return true;
+        int32_t d = value - sent;
+        return d > deadband || d < -deadband;
+    }
+
+    int32_t command_current() const {
+        int32_t ramp = stats_.rampCurrent_mA;
+        if (ramp == PSC_SETPOINT_UNSET) return PSC_SETPOINT_UNSET;
+        int32_t current = ramp + trim_;
+        int32_t limit = stats_.targetCurrent_mA + maxOver_;
+        if (current > limit) current = limit;
+        return current > 0 ? current : 0;
+    }
+
+    bool changed() const {
+        return differs(stats_.targetVoltage_mV, sentVoltage_, deadband_) ||
+               differs(command_current(), sentCurrent_, deadband_);
+    }
+
+    void advance_ramp(uint32_t now_ms) {
+        int32_t target = stats_.targetCurrent_mA;
+        int32_t& out = stats_.rampCurrent_mA;
+        // 第一次設定、清除與下降都立即生效
+        if (target == PSC_SETPOINT_UNSET || out == PSC_SETPOINT_UNSET || target <= out) {
+            out = target;
+            rampMs_ = now_ms;
+            return;
+        }
+        uint32_t step = (uint32_t)(((uint64_t)ramp_ * (now_ms - rampMs_)) / 1000);
+        if (step == 0) return;   // 不足 1 mA 時保留累積的時間
+        rampMs_ = now_ms;
+        out = (uint32_t)(target - out) <= step ? target : out + (int32_t)step;
+    }
+
+    uint32_t minInterval_;
+    uint32_t ramp_;
+    int32_t deadband_;
+    int32_t maxOver_;
+    int32_t trim_;
+    int32_t sentVoltage_;
+    int32_t sentCurrent_;
+    bool sent_;
+    bool deferring_;
+    uint32_t lastSendMs_;
+    uint32_t rampMs_;
+    PscSetpointStats stats_;
+};
+
+#endif // PSC_SETPOINT_H
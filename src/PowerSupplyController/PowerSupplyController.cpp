@@ -1,100 +1,450 @@
 #include "PowerSupplyController.h"
+#include "PSC_Frame.h"
+#include "PSC_Setpoint.h"
+#include "PSC_CurrentLoop.h"
+#include "Config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
 
 // 使用 UART0 與電源通訊
 // 在啟用了 USB CDC 的情況下，我們需要手動宣告 HardwareSerial
-HardwareSerial PowerSerial(0); 
+HardwareSerial PowerSerial(0);
 
-static bool isConnected = false;
-static float lastVoltage = 0.0;
-static float lastCurrent = 0.0;
-static unsigned long lastPacketTime = 0;
-static float last_sent_voltage = -1.0;
-static float last_sent_current = -1.0;
+extern TaskHandle_t pscRxTaskHandle;
 
-static String inputBuffer = ""; 
+// 以下只由 PSC 接收任務寫入
+static volatile bool isConnected = false;
+static volatile PscLinkMode linkMode = PSC_LINK_TEXT;
+
+// 最新一筆量測；以 seqlock 發布：寫入期間序號為奇數，讀取端發現序號改變就重讀
+static PscSample rxSample;
+static PscSample publishedSample;
+static std::atomic<uint32_t> sampleSequence(0);
+#define PSC_SAMPLE_SPIN_LIMIT 8   // 連續撞上寫入這麼多次就讓出 CPU
+
+// UART 驅動的資料直接讀進環形緩衝，再逐位元組交給解析器；每行都不配置記憶體
+#define PSC_RX_BUFFER_SIZE 256
+static PscRingBuffer<PSC_RX_BUFFER_SIZE> rx_ring;
+static PscParser parser;
+
+// --- 二進位框架 (PSC_Frame.h)，以下只由 PSC 接收任務存取 ---
+static PscFrameDecoder frameDecoder;
+static PscLinkStats linkStats;
+static uint8_t negotiateAttempts = 0;
+static uint32_t negotiateSentMs = 0;
+static bool binaryRefused = false;      // 電源沒有回應協商，直到重新連線前不再嘗試
+static uint8_t txSeq = 0;
+static uint8_t lastTelemetrySeq = 0;
+static bool telemetrySeqValid = false;
+static uint32_t lastPingMs = 0;
+
+// 設定值：Logic 只寫入目標並通知 PSC 接收任務，由接收任務合併、限速、送出與重送；
+// UART 因此只有一個寫入者，Logic 也不會因為 UART 傳送而阻塞
+static std::atomic<int32_t> targetVoltage_mV(PSC_SETPOINT_UNSET);
+static std::atomic<int32_t> targetCurrent_mA(PSC_SETPOINT_UNSET);
+static PscSetpointManager setpointManager;
+static PscSetpointStats setpointStats;   // 給其他任務讀取的副本，每次處理後更新
+
+// 等待 ACK 的 SET 框架；ACK 前不送新的 SET，期間的變更合併到下一筆
+struct PendingSet {
+    bool awaiting;
+    uint8_t seq;
+    uint8_t attempts;
+    uint32_t sentUs;
+    uint8_t body[8];
+};
+static PendingSet pendingSet;
+
+// 電流閉迴路：由 PSC 接收任務在每筆二進位遙測後更新；設定由 Web 任務寫入 pendingLoopConfig，接收任務在下一輪套用
+static PscCurrentLoop currentLoop;
+static PscCurrentLoopConfig loopConfig;
+static PscCurrentLoopConfig pendingLoopConfig;
+static bool loopConfigChanged = false;
+static portMUX_TYPE loop_config_mux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<bool> regulationRequested(false);   // Logic：繼電器閉合、輸出電流中
+static PscCurrentLoopStatus loopStatus;                 // 給其他任務讀取的副本
+static portMUX_TYPE status_mux = portMUX_INITIALIZER_UNLOCKED;   // 保護 loopStatus 與 setpointStats 副本，接收任務每 10 ms 更新
+static uint32_t loopSampleCount = 0;
+static uint32_t loopSampleUs = 0;
 
 void psc_init() {
     // 初始化 UART0，鮑率 115200，RX=44, TX=43 (請確認您的 PCB 實際腳位)
     // 假設您的 PCB 使用的是 ESP32-S3 的預設 UART0 腳位
     // 如果您在 Config.h 中有定義，請使用 Config.h 中的定義
     // 这里假设使用默认脚位，如果不是请修改
-    PowerSerial.begin(115200, SERIAL_8N1, 44, 43); 
+    PowerSerial.begin(115200, SERIAL_8N1, 44, 43);
+    rx_ring.reset();
+    parser.reset();
+    frameDecoder.reset();
+    memset(&rxSample, 0, sizeof(rxSample));
+    memset(&linkStats, 0, sizeof(linkStats));
+    targetVoltage_mV.store(PSC_SETPOINT_UNSET);
+    targetCurrent_mA.store(PSC_SETPOINT_UNSET);
+    memset(&pendingSet, 0, sizeof(pendingSet));
+    setpointManager.configure(PSC_SETPOINT_MIN_INTERVAL_MS, PSC_CURRENT_RAMP_MA_PER_S, PSC_SETPOINT_DEADBAND_MILLI);
+    setpointManager.set_trim_limit(PSC_CURRENT_LOOP_MAX_OVER_MA);
+    setpointManager.reset();
+    setpointStats = setpointManager.stats();
+    loopConfig.enabled = PSC_CURRENT_LOOP_ENABLED;
+    loopConfig.kp = PSC_CURRENT_LOOP_KP;
+    loopConfig.ki = PSC_CURRENT_LOOP_KI;
+    loopConfig.maxTrim_mA = PSC_CURRENT_LOOP_MAX_TRIM_MA;
+    pendingLoopConfig = loopConfig;
+    loopConfigChanged = false;
+    currentLoop.configure(loopConfig.kp, loopConfig.ki, loopConfig.maxTrim_mA, PSC_CURRENT_LOOP_MAX_OVER_MA);
+    currentLoop.reset();
+    memset(&loopStatus, 0, sizeof(loopStatus));
+    regulationRequested.store(false);
+    isConnected = false;
+    linkMode = PSC_LINK_TEXT;
+    binaryRefused = false;
+    // HardwareSerial 自己持有 UART 事件佇列，無法另外開 pattern 偵測；
+    // 改以 RX 靜止逾時觸發，電源每行送完就安靜，等同每行結尾通知一次
+    PowerSerial.setRxTimeout(PSC_RX_TIMEOUT_SYMBOLS);
+    PowerSerial.onReceive([]() {
+        if (pscRxTaskHandle != NULL) xTaskNotifyGive(pscRxTaskHandle);
+    });
     Serial.println("PSC: PowerSupplyController initialized on UART0.");
 }
 
-void psc_handle_task() {
-    // --- [修正] 非阻塞接收邏輯 ---
-    // 每次只讀取部分數據，不阻塞任務
-    while (PowerSerial.available()) {
-        char c = PowerSerial.read();
-        
-        if (c == '\n') {
-            // 讀到換行符，處理整行數據
-            inputBuffer.trim(); // 去除前後空白
-            
-            // 解析 V=...,I=...
-            if (inputBuffer.startsWith("V=")) {
-                int iIndex = inputBuffer.indexOf(",I=");
-                if (iIndex > 0) {
-                    String vStr = inputBuffer.substring(2, iIndex);
-                    String iStr = inputBuffer.substring(iIndex + 3);
-                    
-                    lastVoltage = vStr.toFloat();
-                    lastCurrent = iStr.toFloat();
-                    lastPacketTime = millis();
-                    
-                    if (!isConnected) {
-                        isConnected = true;
-                        Serial.println("PSC: Connected!");
-                        
-                        last_sent_voltage = -1.0;
-                        last_sent_current = -1.0;
-                    }
-                }
-            }
-            
-            // 清空緩衝區，準備下一行
-            inputBuffer = "";
-        } else {
-            // 不是換行符，加入緩衝區
-            // 防止緩衝區過大 (例如雜訊導致一直沒有 \n)
-            if (inputBuffer.length() < 128) {
-                inputBuffer += c;
+static void publish_sample() {
+    uint32_t seq = sampleSequence.load(std::memory_order_relaxed);
+    sampleSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&publishedSample, &rxSample, sizeof(PscSample));
+    sampleSequence.store(seq + 2, std::memory_order_release);
+}
+
+bool psc_get_sample(PscSample& sample) {
+    // 寫入者 (PSC 接收任務) 只複製 20 bytes，通常第一次就讀到一致的內容；重讀沒有次數上限，
+    // 但連續 PSC_SAMPLE_SPIN_LIMIT 次撞上寫入時讓出 CPU，不空轉
+    for (uint32_t attempt = 1;; attempt++) {
+        uint32_t before = sampleSequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            memcpy(&sample, &publishedSample, sizeof(PscSample));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sampleSequence.load(std::memory_order_relaxed) == before) return sample.count > 0;
+        }
+        if (attempt % PSC_SAMPLE_SPIN_LIMIT == 0) vTaskDelay(1);
+    }
+}
+
+static void send_line(const char* line) {
+    // 整行一次寫入，HardwareSerial 在單次 write 內持有鎖，不會與其他任務的輸出交錯
+    PowerSerial.write((const uint8_t*)line, strlen(line));
+}
+
+static void send_frame(uint8_t type, uint8_t seq, const uint8_t* body, uint8_t len) {
+    uint8_t wire[PSC_FRAME_MAX_WIRE];
+    uint8_t n = psc_frame_encode(type, seq, body, len, wire);
+    if (n) PowerSerial.write(wire, n);
+}
+
+static void start_negotiation(uint32_t now_ms) {
+    send_line(PSC_BINARY_REQUEST "\n");
+    negotiateAttempts++;
+    negotiateSentMs = now_ms;
+    linkMode = PSC_LINK_NEGOTIATING;
+}
+
+static void enter_binary(uint32_t now_ms) {
+    frameDecoder.reset();
+    telemetrySeqValid = false;
+    lastPingMs = now_ms - PSC_PING_INTERVAL_MS;   // 立即量測一次 RTT
+    rxSample.rxMs = now_ms;                       // 二進位逾時從切換時起算
+    pendingSet.awaiting = false;
+    linkMode = PSC_LINK_BINARY;
+    linkStats.mode = PSC_LINK_BINARY;
+    linkStats.negotiations++;
+    Serial.println("PSC: Binary framing negotiated.");
+}
+
+static void connection_lost(const char* reason) {
+    isConnected = false;
+    // 電源在 PSC_LINK_REVERT_MS 沒收到 PING 後也會退回文字協議，重新連線時再協商
+    if (linkMode == PSC_LINK_BINARY) linkStats.fallbacks++;
+    linkMode = PSC_LINK_TEXT;
+    pendingSet.awaiting = false;
+    linkStats.mode = PSC_LINK_TEXT;
+    negotiateAttempts = 0;
+    binaryRefused = false;
+    Serial.printf("PSC: Connection lost (%s)!\n", reason);
+}
+
+static void psc_on_telemetry(const PscTelemetry& t, uint32_t rx_us, uint32_t rx_ms) {
+    rxSample.voltage_mV = t.voltage_mV;
+    rxSample.current_mA = t.current_mA;
+    rxSample.rxUs = rx_us;
+    rxSample.rxMs = rx_ms;
+    rxSample.count++;
+    publish_sample();
+
+    if (!isConnected) {
+        isConnected = true;
+        negotiateAttempts = 0;
+        setpointManager.invalidate(rx_ms);   // 電源可能已重置，不論數值是否改變都重送
+        Serial.println("PSC: Connected!");
+    }
+    if (linkMode == PSC_LINK_TEXT && !binaryRefused) start_negotiation(rx_ms);
+}
+
+static void update_rtt(uint32_t rtt_us) {
+    linkStats.rttLastUs = rtt_us;
+    if (linkStats.rttMinUs == 0 || rtt_us < linkStats.rttMinUs) linkStats.rttMinUs = rtt_us;
+    if (rtt_us > linkStats.rttMaxUs) linkStats.rttMaxUs = rtt_us;
+}
+
+static void on_frame(const PscFrame& frame, uint32_t rx_us, uint32_t rx_ms) {
+    linkStats.frames++;
+    switch (frame.type) {
+    case PSC_FRAME_TELEMETRY: {
+        if (frame.len < 8) break;
+        if (telemetrySeqValid) linkStats.telemetryLost += (uint8_t)(frame.seq - lastTelemetrySeq - 1);
+        lastTelemetrySeq = frame.seq;
+        telemetrySeqValid = true;
+        PscTelemetry t;
+        t.voltage_mV = (int32_t)psc_get_u32(&frame.body[0]);
+        t.current_mA = (int32_t)psc_get_u32(&frame.body[4]);
+        psc_on_telemetry(t, rx_us, rx_ms);
+        break;
+    }
+    case PSC_FRAME_ACK: {
+        if (frame.len < 1) break;
+        if (pendingSet.awaiting && pendingSet.seq == frame.seq) {
+            pendingSet.awaiting = false;
+            uint32_t ack_us = rx_us - pendingSet.sentUs;
+            if (ack_us > linkStats.ackMaxUs) linkStats.ackMaxUs = ack_us;
+        }
+        linkStats.acks++;
+        if (frame.body[0] != PSC_ACK_APPLIED) linkStats.rejected++;
+        break;
+    }
+    case PSC_FRAME_PONG:
+        if (frame.len >= 4) update_rtt(rx_us - psc_get_u32(frame.body));
+        break;
+    default:
+        break;
+    }
+}
+
+// 重送逾時未確認的 SET；重送用原序號，電源重複套用同一數值沒有副作用。重送 PSC_SET_ATTEMPTS 次仍失敗時回傳 false
+static bool service_ack(uint32_t now_us) {
+    if (!pendingSet.awaiting || now_us - pendingSet.sentUs < PSC_ACK_TIMEOUT_MS * 1000UL) return true;
+    if (pendingSet.attempts >= PSC_SET_ATTEMPTS) {
+        pendingSet.awaiting = false;
+        linkStats.setFailures++;
+        return false;
+    }
+    pendingSet.attempts++;
+    pendingSet.sentUs = now_us;
+    linkStats.retransmits++;
+    send_frame(PSC_FRAME_SET, pendingSet.seq, pendingSet.body, sizeof(pendingSet.body));
+    return true;
+}
+
+// 二進位模式為一個 SET 框架；文字模式為兩行，以一次 write 送出
+static void send_setpoint(const PscSetpointCommand& cmd, uint32_t now_us) {
+    if (linkMode == PSC_LINK_BINARY) {
+        psc_put_u32(&pendingSet.body[0], (uint32_t)cmd.voltage_mV);
+        psc_put_u32(&pendingSet.body[4], (uint32_t)cmd.current_mA);
+        pendingSet.seq = txSeq++;
+        pendingSet.attempts = 1;
+        pendingSet.awaiting = true;
+        pendingSet.sentUs = now_us;
+        send_frame(PSC_FRAME_SET, pendingSet.seq, pendingSet.body, sizeof(pendingSet.body));
+    } else {
+        char lines[48];
+        int n = 0;
+        if (cmd.voltage_mV != PSC_SETPOINT_UNSET) n += snprintf(lines + n, sizeof(lines) - n, "SET:V=%.2f\r\n", cmd.voltage_mV / 1000.0f);
+        if (cmd.current_mA != PSC_SETPOINT_UNSET) n += snprintf(lines + n, sizeof(lines) - n, "SET:I=%.2f\r\n", cmd.current_mA / 1000.0f);
+        send_line(lines);
+    }
+}
+
+// 閉迴路只在有 100 Hz 遙測時運作；每筆新遙測更新一次，回傳目前的修正量
+static int32_t service_current_loop() {
+    portENTER_CRITICAL(&loop_config_mux);
+    bool changed = loopConfigChanged;
+    if (changed) loopConfig = pendingLoopConfig;
+    loopConfigChanged = false;
+    portEXIT_CRITICAL(&loop_config_mux);
+    if (changed) {
+        currentLoop.configure(loopConfig.kp, loopConfig.ki, loopConfig.maxTrim_mA, PSC_CURRENT_LOOP_MAX_OVER_MA);
+        currentLoop.reset();
+    }
+
+    bool active = loopConfig.enabled && linkMode == PSC_LINK_BINARY &&
+                  regulationRequested.load(std::memory_order_relaxed);
+    if (active != loopStatus.active) {
+        // 啟動時從零修正開始，第一筆遙測只取時間不積分
+        currentLoop.reset();
+        loopSampleCount = rxSample.count;
+        loopSampleUs = rxSample.rxUs;
+        setpointManager.set_min_interval(active ? PSC_CURRENT_LOOP_COMMAND_INTERVAL_MS : PSC_SETPOINT_MIN_INTERVAL_MS);
+    }
+    if (active && rxSample.count != loopSampleCount) {
+        float dt_s = (rxSample.rxUs - loopSampleUs) / 1000000.0f;
+        loopSampleCount = rxSample.count;
+        loopSampleUs = rxSample.rxUs;
+        int32_t setVoltage_mV = setpointManager.stats().targetVoltage_mV;
+        bool voltageLimited = setVoltage_mV != PSC_SETPOINT_UNSET &&
+                              rxSample.voltage_mV >= setVoltage_mV - PSC_CURRENT_LOOP_CV_MARGIN_MV;
+        currentLoop.update(setpointManager.stats().rampCurrent_mA, rxSample.current_mA, dt_s, voltageLimited);
+    }
+    PscCurrentLoopStatus status = currentLoop.status();
+    status.active = active;
+    portENTER_CRITICAL(&status_mux);
+    loopStatus = status;
+    portEXIT_CRITICAL(&status_mux);
+    return active ? currentLoop.trim() : 0;
+}
+
+// 回傳距離下一次需要處理設定值的時間 (ms)，PSC_SETPOINT_IDLE 表示沒有待送的變更
+static uint32_t service_setpoints(uint32_t now_ms) {
+    int32_t trim = service_current_loop();
+    // 協商期間電源隨時可能切換協議，等結果確定再送
+    if (!isConnected || linkMode == PSC_LINK_NEGOTIATING) return PSC_SETPOINT_IDLE;
+    if (pendingSet.awaiting) return PSC_ACK_TIMEOUT_MS;
+    PscSetpointCommand cmd;
+    if (setpointManager.poll(targetVoltage_mV.load(std::memory_order_relaxed),
+                             targetCurrent_mA.load(std::memory_order_relaxed), now_ms, cmd, trim)) {
+        send_setpoint(cmd, micros());
+    }
+    PscSetpointStats stats = setpointManager.stats();
+    portENTER_CRITICAL(&status_mux);
+    setpointStats = stats;
+    portEXIT_CRITICAL(&status_mux);
+    return pendingSet.awaiting ? PSC_ACK_TIMEOUT_MS : setpointManager.due_in(now_ms);
+}
+
+uint32_t psc_rx_service() {
+    // 只處理目前已收到的資料；同一批中的各行以讀出的時間為準
+    int pending;
+    while ((pending = PowerSerial.available()) > 0) {
+        uint32_t rx_us = micros();
+        uint32_t rx_ms = millis();
+        uint8_t* dst;
+        uint16_t space = rx_ring.write_region(&dst);
+        size_t n = PowerSerial.read(dst, (size_t)pending < space ? (size_t)pending : space);
+        if (n == 0) break;
+        rx_ring.commit((uint16_t)n);
+
+        uint8_t c;
+        while (rx_ring.read(c)) {
+            // 接受行之後的位元組已經是框架，逐位元組切換
+            if (linkMode == PSC_LINK_BINARY) {
+                PscFrame frame;
+                PscFrameDecoder::Result r = frameDecoder.feed(c, frame);
+                if (r == PscFrameDecoder::FRAME) on_frame(frame, rx_us, rx_ms);
+                else if (r == PscFrameDecoder::CRC_ERROR) linkStats.crcErrors++;
+                else if (r == PscFrameDecoder::FRAMING_ERROR) linkStats.framingErrors++;
             } else {
-                // 緩衝區滿了還沒換行，可能是垃圾數據，清空
-                inputBuffer = ""; 
+                PscTelemetry t;
+                PscParser::Result r = parser.feed(c, t);
+                if (r == PscParser::TELEMETRY) psc_on_telemetry(t, rx_us, rx_ms);
+                else if (r == PscParser::HANDSHAKE && linkMode == PSC_LINK_NEGOTIATING) enter_binary(rx_ms);
             }
         }
     }
-    
-    // 超時檢測
-    if (isConnected && (millis() - lastPacketTime > 3000)) {
-        isConnected = false;
-        Serial.println("PSC: Connection lost!");
-    }
-}
-void psc_set_voltage(float v) {
-    if (isConnected) {
-        if (abs(v - last_sent_voltage) > 0.05) { 
-            PowerSerial.print("SET:V=");
-            PowerSerial.println(v);
-            last_sent_voltage = v;
-            Serial.printf("PSC SET V: %.1f\n", v);
+
+    uint32_t now = millis();
+    if (linkMode == PSC_LINK_BINARY) {
+        if (!service_ack(micros())) {
+            connection_lost("setpoint not acknowledged");
+            return PSC_RX_IDLE_CHECK_MS;
         }
+        if (now - lastPingMs >= PSC_PING_INTERVAL_MS) {
+            lastPingMs = now;
+            uint8_t body[4];
+            psc_put_u32(body, micros());
+            send_frame(PSC_FRAME_PING, txSeq++, body, sizeof(body));
+        }
+    } else if (linkMode == PSC_LINK_NEGOTIATING && now - negotiateSentMs >= PSC_NEGOTIATE_TIMEOUT_MS) {
+        if (negotiateAttempts < PSC_NEGOTIATE_ATTEMPTS) {
+            start_negotiation(now);
+        } else {
+            linkMode = PSC_LINK_TEXT;
+            binaryRefused = true;
+            Serial.println("PSC: No reply to binary framing request, using text protocol.");
+        }
+    }
+
+    // 超時檢測
+    uint32_t timeout = linkMode == PSC_LINK_BINARY ? PSC_BINARY_TIMEOUT_MS : PSC_TIMEOUT_MS;
+    if (isConnected && (now - rxSample.rxMs > timeout)) connection_lost("telemetry timeout");
+
+    uint32_t due = service_setpoints(now);
+    return due < PSC_RX_IDLE_CHECK_MS ? due : PSC_RX_IDLE_CHECK_MS;
+}
+
+// 只更新目標，數值改變時通知 PSC 接收任務；不寫 UART，不會阻塞
+static void set_target(std::atomic<int32_t>& target, float value) {
+    int32_t milli = value > 0.0f ? (int32_t)lroundf(value * 1000.0f) : 0;
+    if (target.exchange(milli, std::memory_order_relaxed) != milli && pscRxTaskHandle != NULL) {
+        xTaskNotifyGive(pscRxTaskHandle);
+    }
+}
+
+void psc_set_voltage(float v) { set_target(targetVoltage_mV, v); }
+void psc_set_current(float a) { set_target(targetCurrent_mA, a); }
+void psc_reset_current() {
+    regulationRequested.store(false, std::memory_order_relaxed);
+    set_target(targetCurrent_mA, PSC_RESET_CURRENT_A);
+}
+
+void psc_set_current_regulation(bool active) {
+    if (regulationRequested.exchange(active, std::memory_order_relaxed) != active && pscRxTaskHandle != NULL) {
+        xTaskNotifyGive(pscRxTaskHandle);
     }
 }
 
-void psc_set_current(float a) {
-    if (isConnected) {
-        if (abs(a - last_sent_current) > 0.05) { 
-            PowerSerial.print("SET:I=");
-            PowerSerial.println(a);
-            last_sent_current = a;
-            Serial.printf("PSC SET I: %.1f\n", a); // Debug
-        } 
+bool psc_set_current_loop_config(const PscCurrentLoopConfig& config) {
+    if (!(config.kp >= 0.0f && config.kp <= 5.0f) || !(config.ki >= 0.0f && config.ki <= 50.0f) ||
+        config.maxTrim_mA < 0 || config.maxTrim_mA > 20000) {
+        return false;
     }
+    portENTER_CRITICAL(&loop_config_mux);
+    pendingLoopConfig = config;
+    loopConfigChanged = true;
+    portEXIT_CRITICAL(&loop_config_mux);
+    if (pscRxTaskHandle != NULL) xTaskNotifyGive(pscRxTaskHandle);
+    return true;
+}
+
+PscCurrentLoopConfig psc_get_current_loop_config() {
+    portENTER_CRITICAL(&loop_config_mux);
+    PscCurrentLoopConfig config = pendingLoopConfig;
+    portEXIT_CRITICAL(&loop_config_mux);
+    return config;
+}
+
+PscCurrentLoopStatus psc_get_current_loop_status() {
+    portENTER_CRITICAL(&status_mux);
+    PscCurrentLoopStatus status = loopStatus;
+    portEXIT_CRITICAL(&status_mux);
+    return status;
 }
 
 bool psc_is_connected() { return isConnected; }
-float psc_get_voltage() { return lastVoltage; }
-float psc_get_current() { return lastCurrent; }
\ No newline at end of file
+// 單一欄位為 32 位元，讀取本身是原子的
+PscParserStats psc_get_parser_stats() { return parser.stats(); }
+PscLinkStats psc_get_link_stats() { return linkStats; }
+PscSetpointStats psc_get_setpoint_stats() {
+    portENTER_CRITICAL(&status_mux);
+    PscSetpointStats stats = setpointStats;
+    portEXIT_CRITICAL(&status_mux);
+    return stats;
+}
+
+float psc_get_voltage() {
+    PscSample sample;
+    psc_get_sample(sample);
+    return sample.voltage_mV / 1000.0f;
+}
+
+float psc_get_current() {
+    PscSample sample;
+    psc_get_sample(sample);
+    return sample.current_mA / 1000.0f;
+}
@@ -2,17 +2,70 @@
 #define POWER_SUPPLY_CONTROLLER_H
 
 #include <Arduino.h>
+#include "PSC_Parser.h"
+#include "PSC_Setpoint.h"
+#include "PSC_CurrentLoop.h"
 
+// 電源回報的一筆量測；rxUs/rxMs 為收到該行結尾時的 micros()/millis()
+struct PscSample {
+    int32_t voltage_mV;
+    int32_t current_mA;
+    uint32_t rxUs;
+    uint32_t rxMs;
+    uint32_t count;   // 累計收到的筆數，0 表示尚未收到
+};
+
+enum PscLinkMode {
+    PSC_LINK_TEXT,         // "V=..,I=.." 文字協議
+    PSC_LINK_NEGOTIATING,  // 已送出 PSC_BINARY_REQUEST，等待電源接受
+    PSC_LINK_BINARY        // COBS + CRC16 框架 (PSC_Frame.h)
+};
+
+struct PscLinkStats {
+    PscLinkMode mode;
+    uint32_t negotiations;   // 成功切換到二進位的次數
+    uint32_t fallbacks;      // 二進位模式下斷線、退回文字協議的次數
+    uint32_t frames;
+    uint32_t crcErrors;
+    uint32_t framingErrors;
+    uint32_t telemetryLost;  // 依遙測序號推算的遺失筆數
+    uint32_t acks;
+    uint32_t rejected;       // 電源回覆 PSC_ACK_REJECTED
+    uint32_t retransmits;
+    uint32_t setFailures;    // 重送 PSC_SET_ATTEMPTS 次仍沒有 ACK
+    uint32_t ackMaxUs;       // 設定值送出到 ACK 的最長時間
+    uint32_t rttLastUs;      // PING/PONG 往返時間
+    uint32_t rttMinUs;
+    uint32_t rttMaxUs;
+};
+
+// 設定 UART 並註冊接收通知；資料到達時通知 pscRxTaskHandle (main.cpp 的 PSC_RX_Task)
 void psc_init();
-void psc_handle_task();
+// 由 PSC 接收任務在收到通知或等待逾時後呼叫：讀出已收到的資料、解析並發布，再檢查斷線。
+// 連線後自動協商二進位框架；也是唯一寫 UART 的地方：合併送出設定值 (PSC_Setpoint.h)、重送未確認的 SET 與定期 PING。
+// 回傳下一次需要呼叫的時間 (ms，不超過 PSC_RX_IDLE_CHECK_MS)，斜坡進行中或指令被限速時較短
+uint32_t psc_rx_service();
 
-// 發送指令
+// 設定目標值；只記錄並通知 PSC 接收任務，不阻塞。斷線期間的設定在連線後送出。
+// 電壓與電流合併為一筆指令，間隔至少 PSC_SETPOINT_MIN_INTERVAL_MS；電流上升依 PSC_CURRENT_RAMP_MA_PER_S 逐步增加
 void psc_set_voltage(float v);
 void psc_set_current(float a);
+void psc_reset_current();   // 回到 PSC_RESET_CURRENT_A，並停止閉迴路
+// Logic 在輸出電流期間 (繼電器閉合) 設為 true：閉迴路修正設定值，使量測電流追上 psc_set_current() 的目標
+void psc_set_current_regulation(bool active);
+
+// 閉迴路參數；執行中修改，下一筆遙測起生效 (積分歸零)。超出範圍時回傳 false
+bool psc_set_current_loop_config(const PscCurrentLoopConfig& config);
+PscCurrentLoopConfig psc_get_current_loop_config();
+PscCurrentLoopStatus psc_get_current_loop_status();
 
-// 獲取狀態
+// 獲取狀態；以下讀取都不需要鎖，可在任何任務呼叫
 bool psc_is_connected();
+bool psc_get_sample(PscSample& sample);  // 尚未收到任何遙測時回傳 false
 float psc_get_voltage();
 float psc_get_current();
+PscParserStats psc_get_parser_stats();  // 解析成功/格式錯誤的行數
+PscLinkStats psc_get_link_stats();
+PscSetpointStats psc_get_setpoint_stats();
 
-#endif
\ No newline at end of file
+#endif
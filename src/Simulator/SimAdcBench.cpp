@@ -0,0 +1,210 @@
+// src/Simulator/SimAdcBench.cpp
+
+#include "SimAdcBench.h"
+#include "HAL/ADC_Profile.h"
+#include "HAL/MeasurementFilter.h"
+#include "Config.h"
+#include <math.h>
+#include <random>
+#include <stdio.h>
+
+// 收到 ALERT/RDY 到寫入新的 MUX 設定 (讀取一筆 + 任務喚醒) 的估計時間，寫入後 ADS1115 立即重新開始轉換
+#define ADC_BENCH_SWITCH_US 150.0
+// 寬頻雜訊以此取樣率產生，轉換期間的平均等同 sqrt(n) 倍的衰減
+#define ADC_BENCH_NOISE_BANDWIDTH_HZ 50000.0
+#define ADC_BENCH_WARMUP 64
+#define ADC_BENCH_SAMPLES 2048
+#define ADC_BENCH_STEP_SAMPLES 200
+
+// 分壓前的輸入，數值為假設值，只用來比較設定之間的相對差異
+struct BenchSignal {
+    const char* name;
+    double dcVolts;
+    double stepVolts;       // 延遲測試的階躍量
+    double rippleVolts;     // 漣波振幅
+    double rippleHz;
+    double noiseRmsVolts;   // 寬頻雜訊
+    double dividerRatio;
+};
+
+static const BenchSignal signals[ADC_CH_COUNT] = {
+    { "voltage (0-1)", 100.0, 1.0, 0.5, 100.0, 0.3, VOLTAGE_DIVIDER_120V_RATIO },
+    { "CP (2-3)",       12.0, -12.0, 0.0, 0.0, 0.05, VOLTAGE_DIVIDER_CP_RATIO },
+};
+
+static double slot_seconds(const AdcProfile& p) {
+    return ADC_BENCH_SWITCH_US / 1e6 + (p.oversampling + 1.0) / p.sps;
+}
+
+// 一個通道在排程中的時間位置
+struct ChannelTiming {
+    double offset;   // 該通道時段在一輪中的開始時間
+    double cycle;    // 兩個通道各一個時段
+    double period;   // 一次轉換
+};
+
+static ChannelTiming channel_timing(const AdcProfile profiles[ADC_CH_COUNT], int channel) {
+    ChannelTiming t = { 0.0, 0.0, 1.0 / profiles[channel].sps };
+    for (int ch = 0; ch < ADC_CH_COUNT; ch++) {
+        if (ch < channel) t.offset += slot_seconds(profiles[ch]);
+        t.cycle += slot_seconds(profiles[ch]);
+    }
+    return t;
+}
+
+// 第 n 筆保留下來的轉換 (每個時段丟棄第一筆) 的開始時間
+static double kept_conversion_start(const ChannelTiming& t, uint8_t oversampling, uint32_t n) {
+    uint32_t slot = n / oversampling;
+    uint32_t k = n % oversampling + 1;
+    return slot * t.cycle + t.offset + ADC_BENCH_SWITCH_US / 1e6 + k * t.period;
+}
+
+// 轉換期間輸入的平均 (漣波取解析積分，雜訊依樣本數縮小)，量化後換算回分壓前的 mV，與 HAL 相同
+static int32_t convert(const BenchSignal& sig, const AdcProfile& p, double start, double period, double level,
+                       double noise, bool& clipped) {
+    double v = level + noise;
+    if (sig.rippleHz > 0.0) {
+        double w = 2.0 * M_PI * sig.rippleHz;
+        v += sig.rippleVolts * (cos(w * start) - cos(w * (start + period))) / (w * period);
+    }
+    double lsb = adc_profile_volts_per_count(p);
+    double raw = floor(v * sig.dividerRatio / lsb + 0.5);
+    if (raw > 32767.0) { raw = 32767.0; clipped = true; }
+    if (raw < -32768.0) { raw = -32768.0; clipped = true; }
+    int32_t q16 = (int32_t)lround(lsb * 1000.0 / sig.dividerRatio * 65536.0);
+    int32_t mv = (int32_t)(((int64_t)raw * q16) >> 16);
+    return mv < 0 ? -mv : mv;
+}
+
+// 輸入從 step_at 起改變，發布值 (每筆轉換都更新) 到達階躍 90% 所需的時間
+template <typename Pipeline>
+static void measure_latency(const AdcProfile profiles[ADC_CH_COUNT], int channel, double& mean_ms, double& max_ms) {
+    const BenchSignal& sig = signals[channel];
+    const AdcProfile& p = profiles[channel];
+    ChannelTiming t = channel_timing(profiles, channel);
+    double sum = 0.0;
+    max_ms = 0.0;
+    for (int i = 0; i < ADC_BENCH_STEP_SAMPLES; i++) {
+        // 先以穩定的輸入跑幾輪讓濾波器收斂
+        double step_at = 8 * t.cycle + t.cycle * i / ADC_BENCH_STEP_SAMPLES;
+        int32_t target = (int32_t)lround(fabs(sig.dcVolts + sig.stepVolts) * 1000.0);
+        int32_t tolerance = (int32_t)lround(fabs(sig.stepVolts) * 100.0);
+        Pipeline pipeline;
+        bool clipped = false;
+        // 滿量程不足時永遠到不了目標值，最多模擬到階躍後 64 輪
+        double latency = INFINITY;
+        for (uint32_t n = 0; n < 72u * p.oversampling; n++) {
+            double start = kept_conversion_start(t, p.oversampling, n);
+            double end = start + t.period;
+            // 跨越階躍的轉換取時間加權平均
+            double before = start >= step_at ? 0.0 : end <= step_at ? 1.0 : (step_at - start) / t.period;
+            double level = sig.dcVolts + sig.stepVolts * (1.0 - before);
+            int32_t out = pipeline.push(convert(sig, p, start, t.period, level, 0.0, clipped));
+            if (end > step_at && abs(out - target) <= tolerance) {
+                latency = end - step_at;
+                break;
+            }
+        }
+        sum += latency;
+        if (latency * 1000.0 > max_ms) max_ms = latency * 1000.0;
+    }
+    mean_ms = sum / ADC_BENCH_STEP_SAMPLES * 1000.0;
+}
+
+struct NoiseResult {
+    double rmsVolts;
+    double peakToPeakVolts;
+    bool clipped;
+};
+
+// 穩定輸入下發布值的雜訊；前幾筆用來讓濾波器收斂，不列入統計
+template <typename Pipeline>
+static NoiseResult measure_noise(const AdcProfile profiles[ADC_CH_COUNT], int channel) {
+    const BenchSignal& sig = signals[channel];
+    const AdcProfile& p = profiles[channel];
+    ChannelTiming t = channel_timing(profiles, channel);
+    std::mt19937 rng(2024 + channel);
+    std::normal_distribution<double> noise(0.0, sig.noiseRmsVolts / sqrt(t.period * 2.0 * ADC_BENCH_NOISE_BANDWIDTH_HZ));
+    Pipeline pipeline;
+    NoiseResult r = { 0.0, 0.0, false };
+    double sum_sq = 0.0, lo = 1e9, hi = -1e9;
+    for (uint32_t n = 0; n < ADC_BENCH_WARMUP + ADC_BENCH_SAMPLES; n++) {
+        double start = kept_conversion_start(t, p.oversampling, n);
+        double published = pipeline.push(convert(sig, p, start, t.period, sig.dcVolts, noise(rng), r.clipped)) / 1000.0;
+        if (n < ADC_BENCH_WARMUP) continue;
+        double err = published - sig.dcVolts;
+        sum_sq += err * err;
+        if (published < lo) lo = published;
+        if (published > hi) hi = published;
+    }
+    r.rmsVolts = sqrt(sum_sq / ADC_BENCH_SAMPLES);
+    r.peakToPeakVolts = hi - lo;
+    return r;
+}
+
+static void print_row(const AdcProfile profiles[ADC_CH_COUNT], int channel, bool is_default) {
+    const AdcProfile& p = profiles[channel];
+    double mean_ms, max_ms;
+    NoiseResult noise;
+    if (channel == ADC_CH_VOLTAGE) {
+        typedef MeasurementPipeline<ADC_VOLTAGE_MEDIAN, ADC_VOLTAGE_EMA_SHIFT> Pipeline;
+        measure_latency<Pipeline>(profiles, channel, mean_ms, max_ms);
+        noise = measure_noise<Pipeline>(profiles, channel);
+    } else {
+        typedef MeasurementPipeline<ADC_CP_MEDIAN, ADC_CP_EMA_SHIFT> Pipeline;
+        measure_latency<Pipeline>(profiles, channel, mean_ms, max_ms);
+        noise = measure_noise<Pipeline>(profiles, channel);
+    }
+    double cycle_ms = 0.0;
+    for (int ch = 0; ch < ADC_CH_COUNT; ch++) cycle_ms += slot_seconds(profiles[ch]) * 1000.0;
+    fprintf(stderr, "%c %5u %4u %3u | %8.2f %9.2f | %8.2f %8.2f | ",
+            is_default ? '*' : ' ', p.fullScaleMv, p.sps, p.oversampling,
+            slot_seconds(p) * 1000.0, cycle_ms, mean_ms, max_ms);
+    if (noise.clipped) fprintf(stderr, "  clipped (input exceeds full scale)\n");
+    else fprintf(stderr, "%7.1f %8.1f\n", noise.rmsVolts * 1000.0, noise.peakToPeakVolts * 1000.0);
+}
+
+int sim_adc_bench() {
+    const AdcProfile defaults[ADC_CH_COUNT] = {
+        { ADC_VOLTAGE_FULL_SCALE_MV, ADC_VOLTAGE_SPS, ADC_VOLTAGE_OVERSAMPLING },
+        { ADC_CP_FULL_SCALE_MV, ADC_CP_SPS, ADC_CP_OVERSAMPLING },
+    };
+    for (int ch = 0; ch < ADC_CH_COUNT; ch++) {
+        if (!adc_profile_is_valid(defaults[ch])) {
+            fprintf(stderr, "Invalid default ADC profile for channel %d in Config.h\n", ch);
+            return 1;
+        }
+    }
+    static const uint8_t oversampling_steps[] = { 1, 4, 16 };
+
+    for (int ch = 0; ch < ADC_CH_COUNT; ch++) {
+        const BenchSignal& sig = signals[ch];
+        fprintf(stderr, "\n--- ADC channel %s: %.1f V, ripple %.2f V @ %.0f Hz, noise %.2f V rms, step %+.1f V ---\n",
+                sig.name, sig.dcVolts, sig.rippleVolts, sig.rippleHz, sig.noiseRmsVolts, sig.stepVolts);
+        fprintf(stderr, "filter: median %d, EMA 1/%d\n", ch == ADC_CH_VOLTAGE ? ADC_VOLTAGE_MEDIAN : ADC_CP_MEDIAN,
+                1 << (ch == ADC_CH_VOLTAGE ? ADC_VOLTAGE_EMA_SHIFT : ADC_CP_EMA_SHIFT));
+        fprintf(stderr, "  FS mV  SPS  OS |  slot ms  cycle ms |  90%% avg  90%% max |  rms mV   p-p mV   (* = Config.h, times in ms)\n");
+        AdcProfile profiles[ADC_CH_COUNT] = { defaults[0], defaults[1] };
+        for (size_t r = 0; r < sizeof(ADC_DATA_RATES) / sizeof(ADC_DATA_RATES[0]); r++) {
+            for (size_t o = 0; o < sizeof(oversampling_steps); o++) {
+                profiles[ch].sps = ADC_DATA_RATES[r];
+                profiles[ch].oversampling = oversampling_steps[o];
+                bool is_default = profiles[ch].sps == defaults[ch].sps && profiles[ch].oversampling == defaults[ch].oversampling;
+                print_row(profiles, ch, is_default);
+            }
+        }
+        // 預設值不在掃描表中時另外列出，再比較 PGA 滿量程
+        profiles[ch] = defaults[ch];
+        bool default_listed = false;
+        for (size_t o = 0; o < sizeof(oversampling_steps); o++) {
+            if (oversampling_steps[o] == defaults[ch].oversampling) default_listed = true;
+        }
+        if (!default_listed) print_row(profiles, ch, true);
+        for (size_t g = 0; g < sizeof(ADC_FULL_SCALE_MV) / sizeof(ADC_FULL_SCALE_MV[0]); g++) {
+            if (ADC_FULL_SCALE_MV[g] == defaults[ch].fullScaleMv) continue;
+            profiles[ch].fullScaleMv = ADC_FULL_SCALE_MV[g];
+            print_row(profiles, ch, false);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+// src/Simulator/SimAdcBench.h
+// 比較 ADS1115 各通道取樣設定 (PGA 滿量程、SPS、過取樣) 的延遲與雜訊。
+// 依照 HAL 的排程 (兩通道輪流，切換後丟棄第一筆) 模擬連續轉換，輸入為假設的直流 + 漣波 + 寬頻雜訊，
+// 每筆轉換取轉換期間輸入的平均後量化，再經過 Config.h 設定的濾波管線；不包含 ADS1115 本身的雜訊。
+
+#ifndef SIM_ADC_BENCH_H
+#define SIM_ADC_BENCH_H
+
+// 對兩個通道分別掃描 SPS 與過取樣次數，另一個通道維持 Config.h 的預設值
+int sim_adc_bench();
+
+#endif // SIM_ADC_BENCH_H
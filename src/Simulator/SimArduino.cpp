@@ -0,0 +1,98 @@
+// src/Simulator/SimArduino.cpp
+// Arduino 替身中需要實體的部分：主控台輸出與模擬 UART 緩衝區。
+
+#include <Arduino.h>
+#include <deque>
+#include <errno.h>
+#include <unistd.h>
+
+SimConsole Serial;
+static bool console_enabled = true;
+
+void sim_console_set_enabled(bool enabled) { console_enabled = enabled; }
+
+size_t SimConsole::write(uint8_t c) {
+    if (console_enabled) fputc(c, stdout);
+    return 1;
+}
+
+size_t SimConsole::write(const uint8_t* buffer, size_t size) {
+    if (console_enabled) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+// --- 模擬 UART：每個埠兩個方向的 FIFO；接上外部檔案描述子時 MCU 端改為讀寫該描述子 ---
+#define SIM_UART_COUNT 3
+struct SimUartPort {
+    std::deque<uint8_t> to_mcu;
+    std::deque<uint8_t> to_device;
+    std::function<void(void)> on_receive;
+    int fd = -1;
+};
+static SimUartPort uart_ports[SIM_UART_COUNT];
+
+void sim_uart_attach_fd(int uart_nr, int fd) {
+    uart_ports[uart_nr].fd = fd;
+    uart_ports[uart_nr].to_mcu.clear();
+    uart_ports[uart_nr].to_device.clear();
+}
+
+bool sim_uart_is_external(int uart_nr) { return uart_ports[uart_nr].fd >= 0; }
+
+void sim_uart_poll() {
+    for (SimUartPort& port : uart_ports) {
+        if (port.fd < 0) continue;
+        uint8_t buf[256];
+        bool received = false;
+        ssize_t n;
+        while ((n = read(port.fd, buf, sizeof(buf))) > 0) {
+            port.to_mcu.insert(port.to_mcu.end(), buf, buf + n);
+            received = true;
+        }
+        if (received && port.on_receive) port.on_receive();
+    }
+}
+
+void sim_uart_device_write(int uart_nr, const uint8_t* data, size_t len) {
+    uart_ports[uart_nr].to_mcu.insert(uart_ports[uart_nr].to_mcu.end(), data, data + len);
+    if (uart_ports[uart_nr].on_receive) uart_ports[uart_nr].on_receive();
+}
+
+void sim_uart_set_receive_callback(int uart_nr, std::function<void(void)> callback) {
+    uart_ports[uart_nr].on_receive = callback;
+}
+
+int sim_uart_device_read(int uart_nr) {
+    std::deque<uint8_t>& q = uart_ports[uart_nr].to_device;
+    if (q.empty()) return -1;
+    int c = q.front();
+    q.pop_front();
+    return c;
+}
+
+int sim_uart_mcu_available(int uart_nr) { return (int)uart_ports[uart_nr].to_mcu.size(); }
+
+int sim_uart_mcu_read(int uart_nr) {
+    std::deque<uint8_t>& q = uart_ports[uart_nr].to_mcu;
+    if (q.empty()) return -1;
+    int c = q.front();
+    q.pop_front();
+    return c;
+}
+
+void sim_uart_mcu_write(int uart_nr, const uint8_t* data, size_t len) {
+    SimUartPort& port = uart_ports[uart_nr];
+    if (port.fd < 0) {
+        port.to_device.insert(port.to_device.end(), data, data + len);
+        return;
+    }
+    while (len > 0) {
+        ssize_t n = write(port.fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;   // 對方沒開啟或緩衝已滿：與實體線路一樣直接丟失
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
@@ -0,0 +1,33 @@
+// src/Simulator/SimCheck.h
+// 各 --bench 共用的檢查：失敗時列出描述並計數，最後由 sim_check_report() 輸出結果並決定結束碼。
+
+#ifndef SIM_CHECK_H
+#define SIM_CHECK_H
+
+#include <stdio.h>
+
+inline int& sim_check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void sim_check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        sim_check_failures()++;
+    }
+}
+
+// 有失敗時印出 "<n> <subject> check(s) failed" 並回傳 1，否則印出 "<label>: OK" 並回傳 0；計數隨即歸零
+inline int sim_check_report(const char* subject, const char* label) {
+    int failures = sim_check_failures();
+    sim_check_failures() = 0;
+    if (failures) {
+        fprintf(stderr, "%d %s check(s) failed\n", failures, subject);
+        return 1;
+    }
+    fprintf(stderr, "%-17s: OK\n", label);
+    return 0;
+}
+
+#endif // SIM_CHECK_H
@@ -0,0 +1,57 @@
+// src/Simulator/SimClock.cpp
+
+#include "SimClock.h"
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+
+static uint64_t now_us = 0;
+static SimDelayHook delay_hook = nullptr;
+static bool realtime = false;
+static std::chrono::steady_clock::time_point realtime_epoch;
+
+void sim_clock_reset() {
+    now_us = 0;
+    realtime_epoch = std::chrono::steady_clock::now();
+}
+
+void sim_clock_set_realtime(bool enabled) {
+    if (enabled && !realtime) {
+        realtime_epoch = std::chrono::steady_clock::now() - std::chrono::microseconds(now_us);
+    }
+    realtime = enabled;
+}
+
+bool sim_clock_is_realtime() { return realtime; }
+
+uint64_t sim_clock_now_us() {
+    if (realtime) {
+        now_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - realtime_epoch).count();
+    }
+    return now_us;
+}
+
+void sim_clock_advance_us(uint64_t us) {
+    if (realtime) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    } else {
+        now_us += us;
+    }
+}
+
+void sim_clock_set_delay_hook(SimDelayHook hook) { delay_hook = hook; }
+
+// --- Arduino 時間函數 ---
+unsigned long millis() { return (unsigned long)(sim_clock_now_us() / 1000); }
+unsigned long micros() { return (unsigned long)sim_clock_now_us(); }
+
+void delay(uint32_t ms) {
+    if (delay_hook) {
+        delay_hook(ms);
+    } else {
+        sim_clock_advance_us((uint64_t)ms * 1000);
+    }
+}
+
+void delayMicroseconds(uint32_t us) { sim_clock_advance_us(us); }
@@ -0,0 +1,24 @@
+// src/Simulator/SimClock.h
+// 虛擬時鐘：所有 millis()/micros()/delay() 都從這裡取得時間，
+// 模擬器可以任意快轉，讓狀態機在主機上以遠快於真實時間的速度執行。
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+void sim_clock_reset();
+
+// 連接真實 CAN 匯流排時改用即時模式：時間跟隨系統單調時鐘，推進時鐘改為實際休眠
+void sim_clock_set_realtime(bool enabled);
+bool sim_clock_is_realtime();
+
+uint64_t sim_clock_now_us();
+void sim_clock_advance_us(uint64_t us);
+
+// delay() 被呼叫時由此掛鉤負責推進時間 (例如讓其他模擬任務在等待期間繼續執行)。
+// 未設定時 delay() 只會直接推進時鐘。
+typedef void (*SimDelayHook)(uint32_t ms);
+void sim_clock_set_delay_hook(SimDelayHook hook);
+
+#endif // SIM_CLOCK_H
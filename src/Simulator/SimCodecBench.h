@@ -0,0 +1,13 @@
+// src/Simulator/SimCodecBench.h
+// 比較 TES_Messages.h 產生的編碼/解碼與原本手寫位移版本的結果與速度。
+
+#ifndef SIM_CODEC_BENCH_H
+#define SIM_CODEC_BENCH_H
+
+#include <stdint.h>
+
+// 先以隨機數據檢查兩者逐位元組相同，再各自執行 iterations 輪 (每輪編碼 3 種、解碼 3 種報文)。
+// 結果不一致時回傳非 0。
+int sim_codec_bench(uint32_t iterations);
+
+#endif // SIM_CODEC_BENCH_H
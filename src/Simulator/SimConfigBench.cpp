@@ -0,0 +1,100 @@
+// src/Simulator/SimConfigBench.cpp
+
+#include "SimConfigBench.h"
+#include "SimCheck.h"
+#include "SimClock.h"
+#include "ConfigStore/ConfigStore.h"
+#include "Config.h"
+#include <Preferences.h>
+
+static void clear_namespace() {
+    Preferences prefs;
+    prefs.begin("charger_config", false);
+    prefs.clear();
+    prefs.end();
+}
+
+// 以 Config 任務的方式推進時間：每 10 ms 檢查一次是否到期
+static void run_writer(uint32_t duration_ms) {
+    for (uint32_t t = 0; t < duration_ms; t += 10) {
+        sim_clock_advance_us(10000);
+        config_writer_service(millis());
+    }
+}
+
+int sim_config_bench() {
+    sim_clock_reset();
+
+    // 首次開機：預設值不在開機路徑上寫入，靜止期後轉存一次
+    clear_namespace();
+    uint32_t base = Preferences::sim_write_count();
+    config_init();
+    sim_check(Preferences::sim_write_count() == base, "config_init() does not write NVS");
+    sim_check(config_get_max_voltage() == 1000 && config_get_max_current() == 100 && config_get_target_soc() == 100,
+              "first boot loads the defaults");
+    run_writer(CONFIG_SAVE_QUIET_MS + 100);
+    sim_check(Preferences::sim_write_count() == base + 1, "first boot stores the settings blob once");
+    sim_check(config_writer_service(millis()) == CONFIG_WRITER_IDLE, "writer is idle after the blob is stored");
+
+    // 舊版韌體的個別鍵值：讀入後轉存為 blob；blob 版本不符時同樣退回舊鍵值
+    clear_namespace();
+    {
+        Preferences prefs;
+        prefs.begin("charger_config", false);
+        prefs.putUInt("max_voltage", 840);
+        prefs.putUInt("max_current", 250);
+        prefs.putInt("target_soc", 95);
+        uint8_t future_blob[16] = {99};
+        prefs.putBytes("settings", future_blob, sizeof(future_blob));
+        prefs.end();
+    }
+    config_init();
+    sim_check(config_get_max_voltage() == 840 && config_get_max_current() == 250 && config_get_target_soc() == 95,
+              "legacy keys are migrated when the blob is missing or has another version");
+    run_writer(CONFIG_SAVE_QUIET_MS + 100);
+    config_init();
+    sim_check(config_get_max_current() == 250 && config_writer_service(millis()) == CONFIG_WRITER_IDLE,
+              "migrated blob reloads without another write");
+
+    // 連續按 SETTING 切換目標 SOC：靜止期內的變更合併，只在最後一次之後寫入一次
+    const int presses = 10;  // 不是 3 的倍數，最後停在與 NVS 不同的值
+    base = Preferences::sim_write_count();
+    ConfigWriterStats before = config_get_writer_stats();
+    for (int i = 0; i < presses; i++) {
+        int soc = config_get_target_soc();
+        int next_soc = (soc < 95) ? 95 : (soc < 100) ? 100 : 80;
+        config_set_charge_settings(config_get_max_voltage(), config_get_max_current(), next_soc);
+        run_writer(300);
+    }
+    sim_check(Preferences::sim_write_count() == base, "no write while changes keep arriving");
+    int final_soc = config_get_target_soc();
+    run_writer(CONFIG_SAVE_QUIET_MS + 100);
+    uint32_t burst_writes = Preferences::sim_write_count() - base;
+    sim_check(burst_writes == 1, "a burst of changes results in one NVS write");
+
+    // 改了又改回：到期時內容與 NVS 相同，不寫入
+    base = Preferences::sim_write_count();
+    config_set_charge_settings(config_get_max_voltage(), 300, final_soc);
+    config_set_charge_settings(config_get_max_voltage(), 250, final_soc);
+    run_writer(CONFIG_SAVE_QUIET_MS + 100);
+    sim_check(Preferences::sim_write_count() == base, "reverting a change before the quiet period skips the write");
+    sim_check(config_get_writer_stats().skipped == before.skipped + 1, "skipped write is counted");
+
+    // 相同的值不算變更
+    config_set_charge_settings(config_get_max_voltage(), 250, final_soc);
+    sim_check(config_writer_service(millis()) == CONFIG_WRITER_IDLE, "setting the current value schedules nothing");
+
+    // 重新開機前 flush：未到期的變更立即寫入，重新載入後保留
+    base = Preferences::sim_write_count();
+    config_set_charge_settings(900, 150, 80);
+    config_flush();
+    sim_check(Preferences::sim_write_count() == base + 1, "config_flush() writes pending changes immediately");
+    config_init();
+    sim_check(config_get_max_voltage() == 900 && config_get_max_current() == 150 && config_get_target_soc() == 80,
+              "flushed settings survive a reboot");
+
+    if (sim_check_report("config", "Config checks")) return 1;
+    fprintf(stderr, "SOC button burst : %d changes -> %u NVS write (was %d blocking writes of 3 keys)\n",
+            presses, burst_writes, presses);
+    return 0;
+}
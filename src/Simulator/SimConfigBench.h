@@ -0,0 +1,11 @@
+// src/Simulator/SimConfigBench.h
+// ConfigStore 延遲寫入的主機端檢查：連續調整合併成一次 NVS 寫入、改回原值時不寫、
+// 舊版個別鍵值轉存為 blob、重新開機前 config_flush()。以 Preferences 模擬層的寫入次數計算磨耗。
+
+#ifndef SIM_CONFIG_BENCH_H
+#define SIM_CONFIG_BENCH_H
+
+// 檢查失敗時回傳非 0
+int sim_config_bench();
+
+#endif // SIM_CONFIG_BENCH_H
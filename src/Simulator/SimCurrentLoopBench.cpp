@@ -0,0 +1,187 @@
+// src/Simulator/SimCurrentLoopBench.cpp
+
+#include "SimCurrentLoopBench.h"
+#include "SimCheck.h"
+#include "SimPSU.h"
+#include "SimRunner.h"
+#include "PowerSupplyController/PowerSupplyController.h"
+#include "Config.h"
+#include <Arduino.h>
+#include <chrono>
+
+// 便宜電源：輸出比設定值高 8%，3 Hz、阻尼比 0.3 的電流響應 (階躍過衝約 37%)
+#define CHEAP_PSU_GAIN    1.08f
+#define CHEAP_PSU_DAMPING 0.3f
+#define CHEAP_PSU_HZ      3.0f
+
+struct StepResult {
+    float from;       // 改變目標前的輸出電流
+    float peak;       // 往目標方向最遠的輸出電流 (上升取最大、下降取最小)
+    float settled;    // 最後 500 ms 的平均輸出電流
+    uint32_t commands;
+};
+
+static void set_loop_enabled(bool enabled) {
+    PscCurrentLoopConfig config = psc_get_current_loop_config();
+    config.enabled = enabled;
+    psc_set_current_loop_config(config);
+}
+
+// 接上電池並等到電源連線、協商完成，從 PSC_RESET_CURRENT_A 開始穩流
+static void start(bool binary_capable, bool closed_loop) {
+    sim_runner_init(84.0);
+    sim_psu_set_binary_capable(binary_capable);
+    sim_psu_set_response(CHEAP_PSU_GAIN, CHEAP_PSU_DAMPING, CHEAP_PSU_HZ);
+    sim_psu_set_load(true, 80.0f);
+    set_loop_enabled(closed_loop);
+    psc_set_voltage(90.0);
+    sim_runner_run_for(1000);
+    psc_set_current_regulation(true);
+    sim_runner_run_for(2000);
+}
+
+// 改變目標後每 1 ms 取樣一次電源的實際輸出
+static StepResult step_to(float amps, uint32_t duration_ms) {
+    float from = sim_psu_get_output_current();
+    StepResult r = { from, from, 0.0f, sim_psu_get_command_count() };
+    bool rising = amps > from;
+    double settled_sum = 0.0;
+    uint32_t settled_n = 0;
+    psc_set_current(amps);
+    for (uint32_t t = 0; t < duration_ms; t++) {
+        sim_runner_run_for(1);
+        float i = sim_psu_get_output_current();
+        if (rising ? i > r.peak : i < r.peak) r.peak = i;
+        if (t + 500 >= duration_ms) {
+            settled_sum += i;
+            settled_n++;
+        }
+    }
+    r.settled = (float)(settled_sum / settled_n);
+    r.commands = sim_psu_get_command_count() - r.commands;
+    return r;
+}
+
+static void print_step(const char* label, float target, const StepResult& r) {
+    fprintf(stderr, "%-17s: %.1f -> %.0f A, peak %.2f A (%+.2f), settled %.2f A (error %+.2f), %u commands\n",
+            label, r.from, target, r.peak, r.peak - target, r.settled, r.settled - target, r.commands);
+}
+
+// 電源限流在 20 A，目標 30 A
+static void saturate_at_20a() {
+    sim_psu_set_current_limit(20.0f);
+    step_to(30.0f, 2000);
+}
+
+// 電池內阻 0.05 Ω，從 20 A 把設定電壓降到 80.8 V：電源進入定電壓，電流只剩 16 A
+static void hold_in_constant_voltage() {
+    sim_psu_set_battery_resistance(0.05f);
+    step_to(20.0f, 2000);
+    psc_set_voltage(80.8f);
+    sim_runner_run_for(2000);
+}
+
+// 目標下降後低於最終電流的幅度 (A)。以各自的最終電流為準：開迴路停在有增益誤差的電流上
+static float undershoot(const StepResult& r) {
+    return r.peak < r.settled ? r.settled - r.peak : 0.0f;
+}
+
+int sim_current_loop_bench() {
+    // 1. 開迴路：電源的增益誤差與過衝直接送到電池
+    start(true, false);
+    StepResult open = step_to(30.0f, 3000);
+    sim_check(!psc_get_current_loop_status().active, "disabled loop stays idle");
+    print_step("Open loop", 30.0f, open);
+    // 目標下降的開迴路基準：同樣的情境不開迴路，下衝只來自電源本身的動態
+    saturate_at_20a();
+    sim_psu_set_current_limit(0.0f);
+    StepResult recover_open = step_to(10.0f, 1500);
+    print_step("Open saturation", 10.0f, recover_open);
+    start(true, false);
+    hold_in_constant_voltage();
+    StepResult drop_open = step_to(3.0f, 1500);
+    print_step("Open BMS drop", 3.0f, drop_open);
+
+    // 2. 閉迴路：修正設定值，量測電流追上目標
+    start(true, true);
+    uint32_t updates = psc_get_current_loop_status().updates;
+    StepResult closed = step_to(30.0f, 3000);
+    PscCurrentLoopStatus st = psc_get_current_loop_status();
+    print_step("Closed loop", 30.0f, closed);
+    fprintf(stderr, "Loop             : %.0f updates/s, trim %.2f A, error %.2f A\n",
+            (st.updates - updates) / 3.0, st.trim_mA / 1000.0f, st.error_mA / 1000.0f);
+    sim_check(st.active && st.updates - updates >= 3 * 90, "loop runs on every 100 Hz telemetry frame");
+    sim_check(open.settled - 30.0f > 2.0f, "open loop carries the PSU gain error");
+    sim_check(fabsf(closed.settled - 30.0f) <= 0.2f, "closed loop removes the steady-state error");
+    // 過衝主要來自電源本身的動態，迴路只能修正增益誤差造成的部分：至少減半
+    sim_check(closed.peak - 30.0f < (open.peak - 30.0f) / 2, "closed loop reduces the overshoot");
+
+    // 3. 抗積分飽和：電源上限 20 A 時修正量停在上限，送出值不超過目標 + PSC_CURRENT_LOOP_MAX_OVER_MA；
+    // 目標降到 10 A 後 1.5 s 內回到目標
+    const int32_t max_up = PSC_CURRENT_LOOP_MAX_TRIM_MA < PSC_CURRENT_LOOP_MAX_OVER_MA ? PSC_CURRENT_LOOP_MAX_TRIM_MA
+                                                                                       : PSC_CURRENT_LOOP_MAX_OVER_MA;
+    saturate_at_20a();
+    st = psc_get_current_loop_status();
+    sim_check(st.saturated && st.trim_mA == max_up, "trim saturates at the limit");
+    sim_check(psc_get_setpoint_stats().commandCurrent_mA <= 30000 + PSC_CURRENT_LOOP_MAX_OVER_MA,
+              "command never exceeds the target by more than the margin");
+    sim_psu_set_current_limit(0.0f);
+    StepResult recover = step_to(10.0f, 1500);
+    print_step("After saturation", 10.0f, recover);
+    sim_check(fabsf(recover.settled - 10.0f) <= 0.3f && !psc_get_current_loop_status().saturated,
+              "loop recovers from saturation within 1.5 s");
+    sim_check(undershoot(recover) <= undershoot(recover_open) + 0.05f,
+              "no more undershoot than open loop after saturation");
+
+    // 4. 定電壓：電池內阻 0.05 Ω，設定電壓降到 80.8 V 後電流只剩 16 A。誤差不是設定值造成的，
+    // 不可積分出正向修正；BMS 接著把請求降到 3 A，送出值必須立即跟著下降
+    start(true, true);
+    hold_in_constant_voltage();
+    st = psc_get_current_loop_status();
+    float cv_current = sim_psu_get_output_current();
+    fprintf(stderr, "Voltage limited  : %.2f A at %.2f V, trim %.2f A, command %.2f A\n", cv_current,
+            sim_psu_get_output_voltage(), st.trim_mA / 1000.0f, psc_get_setpoint_stats().commandCurrent_mA / 1000.0f);
+    sim_check(st.voltageLimited && st.trim_mA <= 0 && psc_get_setpoint_stats().commandCurrent_mA <= 20000,
+              "loop does not wind up while the PSU is voltage-limited");
+    sim_check(fabsf(cv_current - 16.0f) < 0.2f, "PSU stays in constant voltage");
+    StepResult drop = step_to(3.0f, 1500);
+    print_step("BMS drops request", 3.0f, drop);
+    sim_check(psc_get_setpoint_stats().commandCurrent_mA <= 3000 + PSC_CURRENT_LOOP_MAX_OVER_MA &&
+              fabsf(drop.settled - 3.0f) <= 0.3f && !psc_get_current_loop_status().voltageLimited,
+              "current follows a lower request after constant voltage");
+    sim_check(undershoot(drop) <= undershoot(drop_open) + 0.05f,
+              "no more undershoot than open loop when the request drops");
+    sim_psu_set_battery_resistance(0.0f);
+
+    // 5. 停止穩流 (繼電器斷開)：修正量歸零，回到開迴路
+    psc_set_current(10.0);
+    sim_runner_run_for(1000);
+    psc_set_current_regulation(false);
+    sim_runner_run_for(100);
+    sim_check(!psc_get_current_loop_status().active && psc_get_setpoint_stats().commandCurrent_mA == 10000,
+              "regulation off sends the plain target");
+
+    // 6. 只懂文字協議的電源：10 Hz 遙測太慢，閉迴路不啟動
+    start(false, true);
+    step_to(20.0f, 2000);
+    sim_check(!psc_get_current_loop_status().active, "loop stays idle on a text-only PSU");
+
+    // 7. 電源卡在 8 A (不在定電壓，例如電源內部限流)：修正量停在 max_up；目標降到 3 A 時積分依比例縮小
+    PscCurrentLoop loop;
+    loop.configure(PSC_CURRENT_LOOP_KP, PSC_CURRENT_LOOP_KI, PSC_CURRENT_LOOP_MAX_TRIM_MA, PSC_CURRENT_LOOP_MAX_OVER_MA);
+    for (int i = 0; i < 500; i++) loop.update(10000, 8000, 0.01f);
+    sim_check(loop.trim() == max_up, "stuck output saturates the trim at the margin");
+    loop.update(3000, 3000, 0.01f);
+    sim_check(loop.trim() <= max_up * 3 / 10 + 1, "integral is rescaled when the reference steps down");
+
+    // 8. 單次更新的成本
+    loop.reset();
+    const uint32_t n = 1000000;
+    int32_t measured = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; i++) measured = (measured + loop.update(30000, (int32_t)(i & 0x3FFF) + 20000, 0.01f)) & 0xFFFF;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+    fprintf(stderr, "Update cost      : %.1f ns (checksum %d)\n", ns, (int)measured);
+
+    return sim_check_report("current loop", "Current loop checks");
+}
@@ -0,0 +1,11 @@
+// src/Simulator/SimCurrentLoopBench.h
+// 電流閉迴路 (PSC_CurrentLoop.h) 的檢查：韌體經由模擬 UART 連接會過衝、增益偏高的電源模型，
+// 以虛擬時間比較開迴路與閉迴路的階躍響應 (峰值、穩態誤差)，並檢查更新頻率、抗積分飽和與文字協議下不啟動。
+
+#ifndef SIM_CURRENT_LOOP_BENCH_H
+#define SIM_CURRENT_LOOP_BENCH_H
+
+// 檢查失敗時回傳非 0
+int sim_current_loop_bench();
+
+#endif // SIM_CURRENT_LOOP_BENCH_H
@@ -0,0 +1,237 @@
+// src/Simulator/SimFilterBench.cpp
+
+#include "SimFilterBench.h"
+#include "SimCheck.h"
+#include "HAL/HAL.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <vector>
+
+// --- 浮點參考實作 ---
+template <int N>
+struct FloatPipeline {
+    float window[N];
+    int count = 0, index = 0;
+    bool primed = false;
+    float y = 0.0f;
+    float alpha;
+
+    explicit FloatPipeline(int shift) : alpha(1.0f / (1 << shift)) {}
+
+    float push(float x) {
+        window[index] = x;
+        index = (index + 1) % N;
+        if (count < N) count++;
+        float sorted[N];
+        for (int i = 0; i < count; i++) {
+            int j = i;
+            while (j > 0 && sorted[j - 1] > window[i]) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = window[i];
+        }
+        float m = sorted[(count - 1) / 2];
+        if (!primed) {
+            y = m;
+            primed = true;
+        } else {
+            y += (m - y) * alpha;
+        }
+        return y;
+    }
+};
+
+static void check_median() {
+    MedianFilter<3> m3;
+    int32_t out = 0;
+    for (int i = 0; i < 5; i++) out = m3.push(1000);
+    out = m3.push(50000);
+    sim_check(out == 1000, "median<3> rejects a single spike");
+    out = m3.push(1000);
+    sim_check(out == 1000, "median<3> recovers after a spike");
+
+    MedianFilter<5> m5;
+    for (int i = 0; i < 5; i++) m5.push(-200);
+    m5.push(30000);
+    out = m5.push(-30000);
+    sim_check(out == -200, "median<5> rejects two consecutive spikes");
+
+    MedianFilter<3> m;
+    sim_check(m.push(7) == 7, "median of one sample is the sample");
+    sim_check(m.push(3) == 3, "median of two samples is the lower one");
+}
+
+template <uint8_t Shift>
+static void check_ema_constant(int32_t value) {
+    EmaFilter<Shift> ema;
+    int32_t out = 0;
+    for (int i = 0; i < 200; i++) out = ema.push(value);
+    sim_check(out == value, "EMA of a constant input has no truncation bias");
+}
+
+static void check_ema() {
+    check_ema_constant<0>(12345);
+    check_ema_constant<2>(100001);
+    check_ema_constant<4>(-4999);
+    check_ema_constant<8>(13699);
+
+    // 階躍：與浮點版本的差距不超過 1 mV，最後收斂到目標值
+    EmaFilter<3> ema;
+    double ref = 0.0;
+    ema.push(0);
+    bool close = true;
+    int32_t out = 0;
+    for (int i = 0; i < 200; i++) {
+        out = ema.push(12000);
+        ref += (12000 - ref) / 8.0;
+        if (fabs(out - ref) > 1.0) close = false;
+    }
+    sim_check(close, "EMA step response tracks the floating-point reference within 1 mV");
+    sim_check(out == 12000, "EMA settles exactly on the step value");
+}
+
+static void check_classifier() {
+    CpClassifier cp;
+    sim_check(cp.classify(1500) == CP_STATE_OFF, "CP 1.5 V is OFF");
+    sim_check(cp.classify(1800) == CP_STATE_OFF, "CP 1.8 V stays OFF (hysteresis)");
+    sim_check(cp.classify(2000) == CP_STATE_ERROR, "CP 2.0 V leaves OFF");
+    sim_check(cp.classify(1800) == CP_STATE_ERROR, "CP 1.8 V does not re-enter OFF");
+    sim_check(cp.classify(7600) == CP_STATE_ERROR, "CP 7.6 V does not enter ON");
+    sim_check(cp.classify(7700) == CP_STATE_ON, "CP 7.7 V enters ON");
+    sim_check(cp.classify(7500) == CP_STATE_ON, "CP 7.5 V stays ON (hysteresis)");
+    sim_check(cp.classify(13900) == CP_STATE_ON, "CP 13.9 V stays ON (hysteresis)");
+    sim_check(cp.classify(14100) == CP_STATE_ERROR, "CP 14.1 V leaves ON");
+    sim_check(cp.classify(0) == CP_STATE_OFF, "CP 0 V is OFF");
+}
+
+// 模擬一台分壓比偏差 +2.3%、偏移 -150 mV 的機器，兩點校準後在整個量程內比對整數路徑與實際值
+static void check_calibration() {
+    // 與 HAL 相同的標稱換算：±4.096 V 滿量程，120V 分壓
+    const int32_t nominal_q16 = (int32_t)lround(4.096 / 32768.0 * 1000.0 / VOLTAGE_DIVIDER_120V_RATIO * 65536.0);
+    AdcCalibration nominal = adc_calibration_nominal();
+    sim_check(adc_calibration_scale_q16(nominal_q16, nominal) == nominal_q16, "nominal calibration keeps the scale factor");
+    sim_check(adc_calibration_apply(-1000, nominal_q16, 0) == adc_calibration_apply(1000, nominal_q16, 0),
+              "calibrated reading ignores differential polarity");
+    sim_check(adc_calibration_apply(10, nominal_q16, -500) == 0, "negative calibrated reading clamps to 0");
+
+    const double true_gain = 1.023, true_offset = -150.0;
+    auto actual_mv = [&](int32_t nominal_mv) { return nominal_mv * true_gain + true_offset; };
+    AdcCalibration cal;
+    bool solved = adc_calibration_solve(20000, (int32_t)lround(actual_mv(20000)),
+                                        100000, (int32_t)lround(actual_mv(100000)), &cal);
+    sim_check(solved, "two-point calibration solves");
+    if (!solved) return;
+    int32_t scale = adc_calibration_scale_q16(nominal_q16, cal);
+    double max_err = 0.0;
+    for (int32_t raw = 2000; raw <= 32767; raw += 7) {
+        int32_t nominal_mv = (int32_t)(((int64_t)raw * nominal_q16) >> 16);
+        double err = fabs(adc_calibration_apply((int16_t)raw, scale, cal.offsetMv) - actual_mv(nominal_mv));
+        if (err > max_err) max_err = err;
+    }
+    fprintf(stderr, "Calibration      : gain %.5f, offset %d mV, max error %.2f mV over the range\n",
+            cal.gainQ16 / (double)ADC_CAL_GAIN_ONE, (int)cal.offsetMv, max_err);
+    // 增益量化 1/65536 在 120 V 約 2 mV，加上換算的截斷
+    sim_check(max_err <= 6.0, "calibrated integer path matches the reference within 6 mV");
+    sim_check(abs(adc_calibration_to_nominal((int32_t)lround(actual_mv(57000)), cal) - 57000) <= 1,
+              "calibrated reading converts back to nominal");
+
+    // 重新校準：擷取點以目前的校準還原為標稱值，結果應與從標稱開始相同
+    AdcCalibration again;
+    int32_t n1 = adc_calibration_to_nominal((int32_t)lround(actual_mv(30000)), cal);
+    int32_t n2 = adc_calibration_to_nominal((int32_t)lround(actual_mv(90000)), cal);
+    sim_check(adc_calibration_solve(n2, (int32_t)lround(actual_mv(90000)), n1, (int32_t)lround(actual_mv(30000)), &again) &&
+              abs(again.gainQ16 - cal.gainQ16) <= 2 && abs(again.offsetMv - cal.offsetMv) <= 2,
+              "recalibrating an already calibrated unit is stable (points in any order)");
+
+    AdcCalibration untouched = nominal;
+    sim_check(!adc_calibration_solve(50000, 50000, 50500, 50600, &untouched), "points closer than the minimum span are rejected");
+    sim_check(!adc_calibration_solve(10000, 10000, 20000, 40000, &untouched), "gain above the limit is rejected");
+    sim_check(!adc_calibration_solve(10000, 20000, 20000, 30000, &untouched), "offset above the limit is rejected");
+    sim_check(untouched.gainQ16 == nominal.gainQ16 && untouched.offsetMv == 0, "rejected calibration leaves the output unchanged");
+}
+
+// 帶突波的雜訊輸入 (mV)，與 HAL 換算後的範圍相同
+static std::vector<int32_t> make_samples(uint32_t count, int32_t level_mv, int32_t noise_mv) {
+    std::mt19937 rng(4242);
+    std::normal_distribution<double> noise(0.0, noise_mv);
+    std::uniform_int_distribution<int> spike(0, 99);
+    std::vector<int32_t> samples(count);
+    for (uint32_t i = 0; i < count; i++) {
+        double v = level_mv + noise(rng);
+        if (spike(rng) == 0) v += 20 * noise_mv;
+        samples[i] = (int32_t)lround(fabs(v));
+    }
+    return samples;
+}
+
+template <uint8_t MedianN, uint8_t Shift>
+static void check_pipeline_equivalence(const std::vector<int32_t>& samples, const char* name) {
+    MeasurementPipeline<MedianN, Shift> fixed;
+    FloatPipeline<MedianN> ref(Shift);
+    double max_diff = 0.0;
+    for (int32_t s : samples) {
+        double d = fabs(fixed.push(s) - ref.push((float)s));
+        if (d > max_diff) max_diff = d;
+    }
+    fprintf(stderr, "%-8s pipeline: median %u, EMA 1/%u, max deviation from float %.2f mV\n",
+            name, MedianN, 1u << Shift, max_diff);
+    // 每筆最多差 0.5 mV 的四捨五入，累積後仍應在幾 mV 之內
+    sim_check(max_diff <= 4.0, "fixed-point pipeline matches the floating-point reference");
+}
+
+template <typename Pipeline>
+static double time_fixed(const std::vector<int32_t>& samples, int64_t& checksum) {
+    Pipeline p;
+    CpClassifier cp;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t s : samples) {
+        int32_t v = p.push(s);
+        checksum += v + cp.classify(v);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples.size();
+}
+
+template <int MedianN>
+static double time_float(const std::vector<int32_t>& samples, int shift, double& checksum) {
+    FloatPipeline<MedianN> p(shift);
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t s : samples) {
+        float v = p.push((float)s);
+        CPState state = v <= CP_OFF_MAX_MV - CP_HYSTERESIS_MV ? CP_STATE_OFF :
+                        (v >= CP_ON_MIN_MV + CP_HYSTERESIS_MV && v <= CP_ON_MAX_MV) ? CP_STATE_ON : CP_STATE_ERROR;
+        checksum += v + state;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / samples.size();
+}
+
+int sim_filter_bench(uint32_t samples) {
+    check_median();
+    check_ema();
+    check_classifier();
+    check_calibration();
+
+    std::vector<int32_t> voltage = make_samples(samples, 100000, 300);
+    std::vector<int32_t> cp = make_samples(samples, 12000, 50);
+    check_pipeline_equivalence<ADC_VOLTAGE_MEDIAN, ADC_VOLTAGE_EMA_SHIFT>(voltage, "voltage");
+    check_pipeline_equivalence<ADC_CP_MEDIAN, ADC_CP_EMA_SHIFT>(cp, "CP");
+    if (sim_check_report("filter", "Filter checks")) return 1;
+
+    int64_t fixed_sum = 0;
+    double float_sum = 0.0;
+    double fixed_ns = 1e9, float_ns = 1e9;
+    // 交替執行兩次取較佳值
+    for (int pass = 0; pass < 2; pass++) {
+        fixed_ns = std::min(fixed_ns, time_fixed<MeasurementPipeline<ADC_CP_MEDIAN, ADC_CP_EMA_SHIFT> >(cp, fixed_sum));
+        float_ns = std::min(float_ns, time_float<ADC_CP_MEDIAN>(cp, ADC_CP_EMA_SHIFT, float_sum));
+    }
+    fprintf(stderr, "\n--- CP filter + classification (%u samples) ---\n", samples);
+    fprintf(stderr, "Fixed-point      : %.2f ns/sample\n", fixed_ns);
+    fprintf(stderr, "Floating-point   : %.2f ns/sample (%.2fx)\n", float_ns, float_ns / fixed_ns);
+    fprintf(stderr, "(checksums %lld / %.0f)\n", (long long)fixed_sum, float_sum);
+    return 0;
+}
@@ -0,0 +1,13 @@
+// src/Simulator/SimFilterBench.h
+// MeasurementFilter.h 的主機端檢查與量測：中位數去突波、EMA 無偏差、CP 遲滯分類，
+// 並與浮點版本比較結果及每筆樣本的處理時間。另外檢查 ADC_Calibration.h 的兩點校準與整數換算。
+
+#ifndef SIM_FILTER_BENCH_H
+#define SIM_FILTER_BENCH_H
+
+#include <stdint.h>
+
+// 檢查失敗時回傳非 0；通過後以 samples 筆隨機樣本量測 Config.h 設定的管線
+int sim_filter_bench(uint32_t samples);
+
+#endif // SIM_FILTER_BENCH_H
@@ -0,0 +1,299 @@
+// src/Simulator/SimHAL.cpp
+
+#include "SimHAL.h"
+#include "SimSocketCAN.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "freertos/task.h"
+#include <deque>
+
+extern TaskHandle_t logicTaskHandle;
+
+static bool buttons[4] = {false, false, false, false};
+static std::deque<ButtonEvent> button_events[BUTTON_CONSUMER_COUNT];
+static bool emergency_tripped = false;
+static float cp_voltage = 0.0;
+static CpClassifier cp_classifier;
+static float supply_voltage = 0.0;
+static float output_voltage = 0.0;
+
+static bool charge_relay_state = false;
+static uint32_t relay_open_ms = 0;
+static bool vp_relay_state = false;
+static bool coupler_lock_state = false;
+static LedState led_state = LED_STATE_STANDBY;
+static SimHalEventHook event_hook = nullptr;
+
+static std::deque<SimCanFrame> can_rx_queue;
+static std::deque<SimCanFrame> can_tx_queue;
+static uint32_t can_tx_count = 0;
+static uint32_t can_rx_count = 0;
+static uint32_t can_filtered_count = 0;
+
+// 控制器狀態：bus-off 時不收不發，恢復需 128 次 11 個隱性位元 (500 kbit/s 約 2.8 ms)
+#define SIM_CAN_RECOVERY_MS 3
+static CanBusState can_bus_state = CAN_BUS_RUNNING;
+static uint32_t can_recovery_done_ms = 0;
+static uint32_t can_tx_failed_count = 0;
+static uint32_t can_bus_error_count = 0;
+
+// 依 TWAI 雙濾波器模式的規則比對標準幀 ID (遮罩位為 1 表示不比對)，與 hal_init_can() 使用同一組 code/mask
+static bool can_filter_accepts(unsigned long id) {
+#ifdef CAN_ACCEPT_ALL_FRAMES
+    (void)id;
+    return true;
+#else
+    uint32_t f1 = (((uint32_t)id << 21) ^ CAN_ACCEPTANCE_CODE) & ~CAN_ACCEPTANCE_MASK & 0xFFE00000UL;
+    uint32_t f2 = (((uint32_t)id << 5) ^ CAN_ACCEPTANCE_CODE) & ~CAN_ACCEPTANCE_MASK & 0x0000FFE0UL;
+    return f1 == 0 || f2 == 0;
+#endif
+}
+
+void sim_hal_reset() {
+    for (int i = 0; i < 4; i++) buttons[i] = false;
+    for (int c = 0; c < BUTTON_CONSUMER_COUNT; c++) button_events[c].clear();
+    emergency_tripped = false;
+    cp_voltage = 0.0;
+    supply_voltage = 0.0;
+    output_voltage = 0.0;
+    charge_relay_state = false;
+    vp_relay_state = false;
+    coupler_lock_state = false;
+    led_state = LED_STATE_STANDBY;
+    can_rx_queue.clear();
+    can_tx_queue.clear();
+    can_tx_count = 0;
+    can_rx_count = 0;
+    can_filtered_count = 0;
+    can_bus_state = CAN_BUS_RUNNING;
+    can_tx_failed_count = 0;
+    can_bus_error_count = 0;
+}
+
+// 注入的電位沒有彈跳，直接產生按下/放開事件；模擬器不使用長按
+void sim_hal_set_button(ButtonType button, bool pressed) {
+    if (buttons[button] == pressed) return;
+    buttons[button] = pressed;
+    if (button == BUTTON_EMERGENCY && pressed) {
+        // 與實機 ISR 相同：立即斷開繼電器並通知 Logic 任務
+        hal_control_charge_relay(false);
+        hal_control_vp_relay(false);
+        emergency_tripped = true;
+        xTaskNotifyGive(logicTaskHandle);
+    }
+    ButtonEvent event = { button, pressed ? BUTTON_EVENT_PRESS : BUTTON_EVENT_RELEASE, (uint32_t)millis() };
+    for (int c = 0; c < BUTTON_CONSUMER_COUNT; c++) {
+        if (button_events[c].size() < BUTTON_EVENT_QUEUE_LENGTH) button_events[c].push_back(event);
+    }
+}
+void sim_hal_set_cp_voltage(float volts) { cp_voltage = volts; }
+void sim_hal_set_supply_voltage(float volts) { supply_voltage = volts; }
+void sim_hal_set_output_voltage(float volts) { output_voltage = volts; }
+
+void sim_hal_set_event_hook(SimHalEventHook hook) { event_hook = hook; }
+
+// 只在狀態改變時通知，邏輯每個週期重複呼叫同一指令不會產生事件
+static void notify_output(SimHalEventType type, bool previous, bool on) {
+    if (!event_hook || previous == on) return;
+    SimHalEvent event = {type, on, nullptr};
+    event_hook(event);
+}
+
+static void notify_can_tx(const SimCanFrame& frame) {
+    if (!event_hook) return;
+    SimHalEvent event = {SIM_HAL_EVENT_CAN_TX, true, &frame};
+    event_hook(event);
+}
+
+bool sim_hal_use_socketcan(const char* ifname) { return sim_socketcan_open(ifname); }
+
+void sim_hal_can_inject(const SimCanFrame& frame) {
+    if (can_bus_state != CAN_BUS_RUNNING) return;  // 脫離匯流排時收不到任何報文
+    if (!can_filter_accepts(frame.id)) {
+        can_filtered_count++;
+        return;
+    }
+    can_rx_queue.push_back(frame);
+}
+
+bool sim_hal_can_pop_tx(SimCanFrame& frame) {
+    if (can_tx_queue.empty()) return false;
+    frame = can_tx_queue.front();
+    can_tx_queue.pop_front();
+    return true;
+}
+
+uint32_t sim_hal_can_tx_count() { return can_tx_count; }
+uint32_t sim_hal_can_rx_count() { return can_rx_count; }
+uint32_t sim_hal_can_filtered_count() { return can_filtered_count; }
+
+void sim_hal_can_force_bus_off() {
+    if (can_bus_state != CAN_BUS_RUNNING) return;
+    can_bus_state = CAN_BUS_OFF;
+    can_bus_error_count += 32;  // 每次發送錯誤 TEC +8，32 次後超過 255
+}
+
+uint32_t sim_hal_get_relay_open_ms() { return relay_open_ms; }
+bool sim_hal_get_vp_relay() { return vp_relay_state; }
+bool sim_hal_get_coupler_lock() { return coupler_lock_state; }
+LedState sim_hal_get_led_state() { return led_state; }
+
+// =================================================================
+// =                      HAL.h 介面實現                           =
+// =================================================================
+
+void hal_init_pins() {
+    charge_relay_state = false;
+    vp_relay_state = false;
+    coupler_lock_state = false;
+}
+
+void hal_init_can() {
+    Serial.println("HAL(sim): Virtual CAN bus ready.");
+}
+
+void hal_init_adc() {
+    cp_classifier.reset();
+    Serial.println("HAL(sim): Virtual ADC ready.");
+}
+
+bool hal_get_button_state(ButtonType button) { return buttons[button]; }
+
+bool hal_button_get_event(ButtonConsumer consumer, ButtonEvent* event) {
+    if (button_events[consumer].empty()) return false;
+    *event = button_events[consumer].front();
+    button_events[consumer].pop_front();
+    return true;
+}
+
+void hal_button_flush(ButtonConsumer consumer) { button_events[consumer].clear(); }
+
+bool hal_emergency_button_take_trip() {
+    bool tripped = emergency_tripped;
+    emergency_tripped = false;
+    return tripped;
+}
+
+float hal_read_voltage_sensor() {
+    if (!charge_relay_state) {
+        return 0.0;
+    }
+    return output_voltage;
+}
+
+float hal_read_power_supply_voltage() { return supply_voltage; }
+float hal_read_cp_voltage() { return cp_voltage; }
+
+// 模擬的 CP 電壓沒有雜訊，不經過濾波，直接用與 HAL 相同的遲滯分類
+CPState hal_read_cp_state() {
+    return cp_classifier.classify((int32_t)lroundf(cp_voltage * 1000.0f));
+}
+
+void hal_control_vp_relay(bool on) {
+    if (on && emergency_tripped) return;
+    notify_output(SIM_HAL_EVENT_VP_RELAY, vp_relay_state, on);
+    vp_relay_state = on;
+}
+
+void hal_control_charge_relay(bool on) {
+    if (on && emergency_tripped) return;
+    if (charge_relay_state && !on) relay_open_ms = millis();
+    notify_output(SIM_HAL_EVENT_CHARGE_RELAY, charge_relay_state, on);
+    charge_relay_state = on;
+}
+
+void hal_control_coupler_lock(bool lock) {
+    notify_output(SIM_HAL_EVENT_COUPLER_LOCK, coupler_lock_state, lock);
+    coupler_lock_state = lock;
+}
+
+void hal_update_leds(LedState state) { led_state = state; }
+
+bool hal_can_send(unsigned long id, byte* data, byte len, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    if (can_bus_state != CAN_BUS_RUNNING) {
+        can_tx_failed_count++;
+        return false;
+    }
+    if (sim_socketcan_is_open()) {
+        if (sim_socketcan_send(id, data, len)) {
+            can_tx_count++;
+            can_trace_record(CAN_TRACE_TX, id, data, len);
+            return true;
+        }
+        Serial.print("!!! HAL: SocketCAN send FAILED for ID 0x");
+        Serial.println(id, HEX);
+        return false;
+    }
+    SimCanFrame frame;
+    frame.id = id;
+    frame.len = len;
+    memcpy(frame.data, data, len);
+    can_tx_queue.push_back(frame);
+    can_tx_count++;
+    can_trace_record(CAN_TRACE_TX, id, data, len);
+    notify_can_tx(frame);
+    return true;
+}
+
+// 記憶體佇列模式下不等待：SimRunner 在車輛模型送出報文後立即呼叫接收，等同事件驅動
+bool hal_can_receive(unsigned long* id, byte* len, byte* buf, uint32_t timeout_ms) {
+    if (sim_socketcan_is_open()) {
+        // SocketCAN 沒有硬體濾波器，在這裡套用相同的規則
+        while (sim_socketcan_receive(id, len, buf, timeout_ms)) {
+            if (can_filter_accepts(*id)) {
+                can_rx_count++;
+                can_trace_record(CAN_TRACE_RX, *id, buf, *len);
+                return true;
+            }
+            can_filtered_count++;
+            timeout_ms = 0;
+        }
+        return false;
+    }
+    if (can_rx_queue.empty()) {
+        return false;
+    }
+    const SimCanFrame& frame = can_rx_queue.front();
+    *id = frame.id;
+    *len = frame.len;
+    memcpy(buf, frame.data, frame.len);
+    can_rx_queue.pop_front();
+    can_rx_count++;
+    can_trace_record(CAN_TRACE_RX, *id, buf, *len);
+    return true;
+}
+
+bool hal_get_charge_relay_state() { return charge_relay_state; }
+
+bool hal_can_get_status(HalCanStatus* status) {
+    if (can_bus_state == CAN_BUS_RECOVERING && (int32_t)(millis() - can_recovery_done_ms) >= 0) {
+        can_bus_state = CAN_BUS_STOPPED;
+    }
+    memset(status, 0, sizeof(HalCanStatus));
+    status->state = can_bus_state;
+    status->txErrorCounter = (can_bus_state == CAN_BUS_OFF) ? 255 : 0;
+    status->busErrors = can_bus_error_count;
+    status->txFailed = can_tx_failed_count;
+    return true;
+}
+
+bool hal_can_initiate_recovery() {
+    if (can_bus_state != CAN_BUS_OFF) return false;
+    can_bus_state = CAN_BUS_RECOVERING;
+    can_recovery_done_ms = millis() + SIM_CAN_RECOVERY_MS;
+    return true;
+}
+
+bool hal_can_restart() {
+    if (can_bus_state != CAN_BUS_STOPPED) return false;
+    can_bus_state = CAN_BUS_RUNNING;
+    return true;
+}
+
+bool hal_can_filter_accepts_all() {
+#ifdef CAN_ACCEPT_ALL_FRAMES
+    return true;
+#else
+    return false;
+#endif
+}
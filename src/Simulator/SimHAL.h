@@ -0,0 +1,55 @@
+// src/Simulator/SimHAL.h
+// HAL.h 的模擬後端：輸出 (繼電器/LED) 只記錄狀態，輸入 (按鈕/ADC/CAN) 由模擬器注入。
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include "HAL/HAL.h"
+
+struct SimCanFrame {
+    unsigned long id;
+    byte len;
+    byte data[8];
+};
+
+void sim_hal_reset();
+
+// --- 輸出事件 ---
+// 繼電器/電磁鎖的動作與每一幀發送的報文，供回放工具記錄 (在呼叫 HAL 的當下觸發，時間精確)
+enum SimHalEventType {
+    SIM_HAL_EVENT_CHARGE_RELAY,
+    SIM_HAL_EVENT_VP_RELAY,
+    SIM_HAL_EVENT_COUPLER_LOCK,
+    SIM_HAL_EVENT_CAN_TX
+};
+struct SimHalEvent {
+    SimHalEventType type;
+    bool on;                    // 繼電器/電磁鎖的新狀態
+    const SimCanFrame* frame;   // SIM_HAL_EVENT_CAN_TX 時有效
+};
+typedef void (*SimHalEventHook)(const SimHalEvent& event);
+void sim_hal_set_event_hook(SimHalEventHook hook);
+
+// --- 輸入注入 ---
+void sim_hal_set_button(ButtonType button, bool pressed);
+void sim_hal_set_cp_voltage(float volts);
+void sim_hal_set_supply_voltage(float volts);  // 電源端 (繼電器前) 電壓
+void sim_hal_set_output_voltage(float volts);  // 輸出端 (繼電器後) 電壓，繼電器斷開時讀值為 0
+
+// --- CAN ---
+// 預設使用記憶體佇列 (供 SimVehicle 使用)；開啟 SocketCAN 後 hal_can_send/receive 改走該介面
+bool sim_hal_use_socketcan(const char* ifname);
+void sim_hal_can_inject(const SimCanFrame& frame);  // 車輛 -> 充電樁
+bool sim_hal_can_pop_tx(SimCanFrame& frame);        // 充電樁 -> 車輛
+uint32_t sim_hal_can_tx_count();
+uint32_t sim_hal_can_rx_count();
+uint32_t sim_hal_can_filtered_count();              // 被 (模擬的) 硬體濾波器擋下的報文數
+void sim_hal_can_force_bus_off();                   // 模擬接線干擾使 TEC 超過 255，控制器脫離匯流排
+
+// --- 輸出狀態查詢 ---
+uint32_t sim_hal_get_relay_open_ms();  // 主繼電器最近一次由閉合轉為斷開的時間
+bool sim_hal_get_vp_relay();
+bool sim_hal_get_coupler_lock();
+LedState sim_hal_get_led_state();
+
+#endif // SIM_HAL_H
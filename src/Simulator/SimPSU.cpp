@@ -0,0 +1,253 @@
+// src/Simulator/SimPSU.cpp
+
+#include "SimPSU.h"
+#include "PowerSupplyController/PSC_Frame.h"
+#include "PowerSupplyController/PSC_Parser.h"
+#include "PowerSupplyController/PSC_Setpoint.h"
+#include <Arduino.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define SIM_PSU_UART 0
+#define SIM_PSU_TELEMETRY_INTERVAL_MS 100
+#define SIM_PSU_BINARY_TELEMETRY_INTERVAL_MS 10
+
+static float set_voltage = 0.0;
+static float set_current = 0.0;
+static bool load_connected = false;
+static float battery_voltage = 0.0;
+static uint32_t last_telemetry_ms = 0;
+
+// 電流響應 (sim_psu_set_response)
+static float response_gain = 1.0;
+static float response_damping = 1.0;
+static float response_hz = 0.0;
+static float current_limit = 0.0;
+static float battery_resistance = 0.0;     // sim_psu_set_battery_resistance，0 為純定電流
+static float output_current = 0.0;
+static float output_current_rate = 0.0;   // A/s
+static uint32_t last_response_ms = 0;
+
+static bool binary_capable = true;
+static bool binary = false;
+static uint32_t last_frame_ms = 0;
+static uint8_t telemetry_seq = 0;
+static uint32_t corruption_per_mille = 0;
+static uint32_t corruption_state = 1;
+static bool silent = false;
+static int port_fd = -1;
+static SimPsuStats stats;
+
+static char line_buf[64];
+static size_t line_len = 0;
+static PscFrameDecoder decoder;
+
+// --- 輸入輸出：模擬 UART 或外部檔案描述子 ---
+static int port_read() {
+    if (port_fd < 0) return sim_uart_device_read(SIM_PSU_UART);
+    uint8_t c;
+    return read(port_fd, &c, 1) == 1 ? c : -1;
+}
+
+static void port_write(const uint8_t* data, size_t len) {
+    if (silent) return;
+    if (port_fd < 0) {
+        sim_uart_device_write(SIM_PSU_UART, data, len);
+        return;
+    }
+    while (len > 0) {
+        ssize_t n = write(port_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;   // 對方沒開啟或緩衝已滿：與實體線路一樣直接丟失
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_frame(uint8_t type, uint8_t seq, const uint8_t* body, uint8_t len) {
+    uint8_t wire[PSC_FRAME_MAX_WIRE];
+    uint8_t n = psc_frame_encode(type, seq, body, len, wire);
+    if (corruption_per_mille) {
+        corruption_state = corruption_state * 1103515245u + 12345u;
+        if ((corruption_state >> 16) % 1000 < corruption_per_mille) {
+            // 翻轉分隔之前的一個位元；翻出 0x00 時等同從中間切斷框架
+            uint32_t pos = (corruption_state >> 8) % (uint32_t)(n - 1);
+            wire[pos] ^= (uint8_t)(1u << ((corruption_state >> 4) & 7));
+            stats.corrupted++;
+        }
+    }
+    port_write(wire, n);
+}
+
+static void handle_command(const char* line, uint32_t now_ms) {
+    if (strncmp(line, "SET:V=", 6) == 0) {
+        set_voltage = (float)atof(line + 6);
+        stats.commands++;
+    } else if (strncmp(line, "SET:I=", 6) == 0) {
+        set_current = (float)atof(line + 6);
+        stats.commands++;
+    } else if (binary_capable && strcmp(line, PSC_BINARY_REQUEST) == 0) {
+        static const char accept[] = PSC_BINARY_ACCEPT "\n";
+        port_write((const uint8_t*)accept, sizeof(accept) - 1);
+        binary = true;
+        decoder.reset();
+        last_frame_ms = now_ms;
+        last_telemetry_ms = now_ms - SIM_PSU_BINARY_TELEMETRY_INTERVAL_MS;
+        stats.negotiations++;
+    }
+}
+
+static void handle_frame(const PscFrame& frame, uint32_t now_ms) {
+    stats.frames++;
+    last_frame_ms = now_ms;
+    switch (frame.type) {
+    case PSC_FRAME_SET: {
+        if (frame.len < 8) break;
+        int32_t mV = (int32_t)psc_get_u32(&frame.body[0]);
+        int32_t mA = (int32_t)psc_get_u32(&frame.body[4]);
+        // 兩項一起檢查再一起套用，不會只改其中一項
+        uint8_t status = PSC_ACK_APPLIED;
+        if ((mV < 0 && mV != PSC_SETPOINT_UNSET) || (mA < 0 && mA != PSC_SETPOINT_UNSET)) status = PSC_ACK_REJECTED;
+        if (status == PSC_ACK_APPLIED) {
+            if (mV != PSC_SETPOINT_UNSET) set_voltage = mV / 1000.0f;
+            if (mA != PSC_SETPOINT_UNSET) set_current = mA / 1000.0f;
+            stats.commands++;
+        }
+        send_frame(PSC_FRAME_ACK, frame.seq, &status, 1);
+        break;
+    }
+    case PSC_FRAME_PING:
+        send_frame(PSC_FRAME_PONG, frame.seq, frame.body, frame.len);
+        break;
+    default:
+        break;
+    }
+}
+
+void sim_psu_init(float nominal_voltage) {
+    set_voltage = nominal_voltage;
+    set_current = 0.0;
+    load_connected = false;
+    battery_voltage = 0.0;
+    last_telemetry_ms = 0;
+    binary = false;
+    binary_capable = true;
+    corruption_per_mille = 0;
+    corruption_state = 1;
+    silent = false;
+    response_gain = 1.0;
+    response_damping = 1.0;
+    response_hz = 0.0;
+    current_limit = 0.0;
+    battery_resistance = 0.0;
+    output_current = 0.0;
+    output_current_rate = 0.0;
+    last_response_ms = 0;
+    telemetry_seq = 0;
+    memset(&stats, 0, sizeof(stats));
+    line_len = 0;
+    decoder.reset();
+}
+
+void sim_psu_set_load(bool connected, float voltage) {
+    load_connected = connected;
+    battery_voltage = voltage;
+}
+
+void sim_psu_set_response(float gain, float damping, float natural_hz) {
+    response_gain = gain;
+    response_damping = damping;
+    response_hz = natural_hz;
+}
+
+void sim_psu_set_current_limit(float amps) { current_limit = amps; }
+void sim_psu_set_battery_resistance(float ohms) { battery_resistance = ohms; }
+
+void sim_psu_set_binary_capable(bool capable) { binary_capable = capable; }
+void sim_psu_set_corruption(uint32_t per_mille) { corruption_per_mille = per_mille; }
+void sim_psu_set_silent(bool enabled) { silent = enabled; }
+void sim_psu_attach_fd(int fd) { port_fd = fd; }
+
+float sim_psu_get_set_voltage() { return set_voltage; }
+float sim_psu_get_set_current() { return set_current; }
+float sim_psu_get_output_voltage() {
+    return load_connected ? battery_voltage + output_current * battery_resistance : set_voltage;
+}
+float sim_psu_get_output_current() { return load_connected ? output_current : 0.0f; }
+uint32_t sim_psu_get_command_count() { return stats.commands; }
+bool sim_psu_is_binary() { return binary; }
+const SimPsuStats& sim_psu_get_stats() { return stats; }
+
+static void update_output_current(uint32_t now_ms) {
+    uint32_t elapsed = now_ms - last_response_ms;
+    last_response_ms = now_ms;
+    float target = load_connected ? set_current * response_gain : 0.0f;
+    if (current_limit > 0.0f && target > current_limit) target = current_limit;
+    // 定電壓：電池端電壓到達設定值後電流由 (設定電壓 - 電池電壓) / 內阻 決定
+    if (battery_resistance > 0.0f && load_connected) {
+        float cv = (set_voltage - battery_voltage) / battery_resistance;
+        if (cv < 0.0f) cv = 0.0f;
+        if (target > cv) target = cv;
+    }
+    if (response_hz <= 0.0f || !load_connected) {
+        output_current = target;
+        output_current_rate = 0.0f;
+        return;
+    }
+    // 二階系統以 1 ms 步長積分 (半隱式 Euler)
+    float wn = 2.0f * (float)M_PI * response_hz;
+    if (elapsed > 1000) elapsed = 1000;
+    for (uint32_t i = 0; i < elapsed; i++) {
+        float accel = wn * wn * (target - output_current) - 2.0f * response_damping * wn * output_current_rate;
+        output_current_rate += accel * 0.001f;
+        output_current += output_current_rate * 0.001f;
+        if (output_current < 0.0f) {
+            output_current = 0.0f;
+            output_current_rate = 0.0f;
+        }
+    }
+}
+
+void sim_psu_tick(uint32_t now_ms) {
+    int c;
+    while ((c = port_read()) >= 0) {
+        if (binary) {
+            PscFrame frame;
+            PscFrameDecoder::Result r = decoder.feed((uint8_t)c, frame);
+            if (r == PscFrameDecoder::FRAME) handle_frame(frame, now_ms);
+            else if (r == PscFrameDecoder::CRC_ERROR) stats.crcErrors++;
+            else if (r == PscFrameDecoder::FRAMING_ERROR) stats.framingErrors++;
+        } else if (c == '\n') {
+            line_buf[line_len] = '\0';
+            handle_command(line_buf, now_ms);
+            line_len = 0;
+        } else if (c != '\r' && line_len < sizeof(line_buf) - 1) {
+            line_buf[line_len++] = (char)c;
+        }
+    }
+
+    update_output_current(now_ms);
+
+    if (binary && now_ms - last_frame_ms > PSC_LINK_REVERT_MS) {
+        binary = false;
+        line_len = 0;
+        stats.reverts++;
+    }
+
+    if (binary) {
+        if (now_ms - last_telemetry_ms >= SIM_PSU_BINARY_TELEMETRY_INTERVAL_MS) {
+            last_telemetry_ms = now_ms;
+            uint8_t body[8];
+            psc_put_u32(&body[0], (uint32_t)(int32_t)lroundf(sim_psu_get_output_voltage() * 1000.0f));
+            psc_put_u32(&body[4], (uint32_t)(int32_t)lroundf(sim_psu_get_output_current() * 1000.0f));
+            send_frame(PSC_FRAME_TELEMETRY, telemetry_seq++, body, sizeof(body));
+        }
+    } else if (now_ms - last_telemetry_ms >= SIM_PSU_TELEMETRY_INTERVAL_MS) {
+        last_telemetry_ms = now_ms;
+        char out[48];
+        int n = snprintf(out, sizeof(out), "V=%.2f,I=%.2f\n", sim_psu_get_output_voltage(), sim_psu_get_output_current());
+        port_write((const uint8_t*)out, (size_t)n);
+    }
+}
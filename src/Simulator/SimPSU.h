@@ -0,0 +1,53 @@
+// src/Simulator/SimPSU.h
+// 模擬接在 UART0 上的可程式電源供應器，說同一套協議：
+//   文字：接收 "SET:V=<volts>" / "SET:I=<amps>"，每 100ms 回報 "V=<volts>,I=<amps>"。
+//   收到 PSC_BINARY_REQUEST 時 (若支援) 回覆接受行並切換到 PSC_Frame.h 的二進位框架，以 100 Hz 回報，
+//   SET 回覆 ACK、PING 回覆 PONG；超過 PSC_LINK_REVERT_MS 沒收到有效框架時退回文字協議。
+// 預設透過模擬 UART 與韌體連接；sim_psu_attach_fd() 改接 PTY 或序列埠，供外部程式或另一個模擬器測試。
+
+#ifndef SIM_PSU_H
+#define SIM_PSU_H
+
+#include <stdint.h>
+
+struct SimPsuStats {
+    uint32_t commands;       // 套用的 SET (文字或框架)
+    uint32_t frames;         // 收到的有效框架
+    uint32_t crcErrors;
+    uint32_t framingErrors;
+    uint32_t negotiations;
+    uint32_t reverts;        // 二進位模式下逾時退回文字協議
+    uint32_t corrupted;      // 故意損壞的輸出框架
+};
+
+void sim_psu_init(float nominal_voltage);
+void sim_psu_tick(uint32_t now_ms);
+
+// 負載模型：連接電池時為定電流輸出 (電壓由電池決定)，否則開路輸出設定電壓
+void sim_psu_set_load(bool connected, float battery_voltage);
+// 電流調節的響應：輸出 = gain * 設定值，經過二階系統 (阻尼比 damping、自然頻率 natural_hz)；
+// damping < 1 時設定值上升會過衝。natural_hz 為 0 (預設) 時為理想電源，輸出立即等於設定值
+void sim_psu_set_response(float gain, float damping, float natural_hz);
+// 電源本身的電流上限 (A)，0 表示不限制
+void sim_psu_set_current_limit(float amps);
+// 電池內阻 (Ω)：輸出電壓 = 電池電壓 + 電流 * 內阻，達到設定電壓時進入定電壓、電流減少。0 (預設) 為純定電流
+void sim_psu_set_battery_resistance(float ohms);
+
+// false 模擬只懂文字協議的舊電源 (忽略協商請求)
+void sim_psu_set_binary_capable(bool capable);
+// 每千個輸出框架損壞幾個 (翻轉一個位元)，測試 CRC 與重送
+void sim_psu_set_corruption(uint32_t per_mille);
+// 暫停輸出 (模擬電源當機或線路中斷)；期間仍會接收
+void sim_psu_set_silent(bool silent);
+// 改由檔案描述子 (PTY master、序列埠) 收發；-1 回到模擬 UART
+void sim_psu_attach_fd(int fd);
+
+float sim_psu_get_set_voltage();
+float sim_psu_get_set_current();
+float sim_psu_get_output_voltage();
+float sim_psu_get_output_current();
+uint32_t sim_psu_get_command_count();
+bool sim_psu_is_binary();
+const SimPsuStats& sim_psu_get_stats();
+
+#endif // SIM_PSU_H
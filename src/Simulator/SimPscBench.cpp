@@ -0,0 +1,404 @@
+// src/Simulator/SimPscBench.cpp
+
+#include "SimPscBench.h"
+#include "SimCheck.h"
+#include "PowerSupplyController/PSC_Parser.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// --- 記憶體配置計數：取代整個模擬程序的 operator new，只多一次遞增 ---
+static uint64_t alloc_count = 0;
+
+void* operator new(size_t size) {
+    alloc_count++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// --- 參考實作 ---
+// 與 PSC_Parser.h 相同的格式，但以整行字串處理，容易逐條對照註解中的規則
+namespace reference {
+
+enum Result { NONE, TELEMETRY, MALFORMED, HANDSHAKE };
+
+static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static bool parse_number(const std::string& s, int32_t& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < s.size() && (s[i] == '+' || s[i] == '-')) negative = s[i++] == '-';
+    size_t int_start = i;
+    while (i < s.size() && isdigit((unsigned char)s[i])) i++;
+    std::string int_part = s.substr(int_start, i - int_start);
+    std::string frac_part;
+    if (i < s.size() && s[i] == '.') {
+        size_t frac_start = ++i;
+        while (i < s.size() && isdigit((unsigned char)s[i])) i++;
+        frac_part = s.substr(frac_start, i - frac_start);
+    }
+    if (i != s.size()) return false;
+    if (int_part.empty() && frac_part.empty()) return false;
+    if (int_part.size() > PSC_MAX_INT_DIGITS) return false;
+    int64_t milli = int_part.empty() ? 0 : atoll(int_part.c_str()) * 1000;
+    std::string frac3 = (frac_part + "000").substr(0, 3);
+    milli += atoi(frac3.c_str());
+    if (frac_part.size() > 3 && frac_part[3] >= '5') milli++;
+    out = (int32_t)(negative ? -milli : milli);
+    return true;
+}
+
+static Result parse_line(const std::string& raw, PscTelemetry& out) {
+    if (raw.size() > PSC_LINE_MAX) return MALFORMED;
+    size_t b = 0, e = raw.size();
+    while (b < e && is_space(raw[b])) b++;
+    while (e > b && is_space(raw[e - 1])) e--;
+    if (b == e) return NONE;
+    std::string line = raw.substr(b, e - b);
+    if (line == PSC_BINARY_ACCEPT) return HANDSHAKE;
+    size_t comma = line.find(",I=");
+    if (line.compare(0, 2, "V=") != 0 || comma == std::string::npos) return MALFORMED;
+    if (!parse_number(line.substr(2, comma - 2), out.voltage_mV)) return MALFORMED;
+    if (!parse_number(line.substr(comma + 3), out.current_mA)) return MALFORMED;
+    return TELEMETRY;
+}
+
+} // namespace reference
+
+// 改用 PSC_Parser.h 之前 psc_handle_task() 的做法
+namespace legacy {
+
+static String inputBuffer = "";
+
+static bool feed(char c, float& v, float& i) {
+    bool parsed = false;
+    if (c == '\n') {
+        inputBuffer.trim();
+        if (inputBuffer.startsWith("V=")) {
+            int iIndex = inputBuffer.indexOf(",I=");
+            if (iIndex > 0) {
+                String vStr = inputBuffer.substring(2, iIndex);
+                String iStr = inputBuffer.substring(iIndex + 3);
+                v = vStr.toFloat();
+                i = iStr.toFloat();
+                parsed = true;
+            }
+        }
+        inputBuffer = "";
+    } else if (inputBuffer.length() < 128) {
+        inputBuffer += c;
+    } else {
+        inputBuffer = "";
+    }
+    return parsed;
+}
+
+} // namespace legacy
+
+// --- 固定案例 ---
+static bool parse_one(const char* text, PscTelemetry& t, PscParser::Result* last = nullptr) {
+    PscParser parser;
+    PscParser::Result r = PscParser::NONE;
+    for (const char* p = text; *p; p++) {
+        PscParser::Result x = parser.feed((uint8_t)*p, t);
+        if (x != PscParser::NONE) r = x;
+    }
+    if (last) *last = r;
+    return r == PscParser::TELEMETRY;
+}
+
+static void check_value(const char* line, int32_t mv, int32_t ma) {
+    PscTelemetry t = {0, 0};
+    bool ok = parse_one(line, t) && t.voltage_mV == mv && t.current_mA == ma;
+    if (!ok) fprintf(stderr, "  line %s", line);
+    sim_check(ok, "valid telemetry line parses to the expected value");
+}
+
+static void check_rejected(const char* line) {
+    PscTelemetry t;
+    PscParser::Result r;
+    parse_one(line, t, &r);
+    if (r != PscParser::MALFORMED) fprintf(stderr, "  line %s", line);
+    sim_check(r == PscParser::MALFORMED, "malformed line is rejected");
+}
+
+static void check_cases() {
+    check_value("V=84.00,I=10.00\n", 84000, 10000);
+    check_value("V=84,I=0\n", 84000, 0);
+    check_value("  V=12.5,I=3.25 \r\n", 12500, 3250);
+    check_value("V=-0.5,I=+.25\n", -500, 250);
+    check_value("V=1.,I=.001\n", 1000, 1);
+    check_value("V=0.0004,I=0.0005\n", 0, 1);
+    check_value("V=999999.9994,I=1.23456\n", 999999999, 1235);
+    check_value("\tV=120.1234567,I=99.9995\r\n", 120123, 100000);
+
+    check_rejected("V=,I=1\n");
+    check_rejected("V=1,I=\n");
+    check_rejected("V=1.2.3,I=1\n");
+    check_rejected("V=1,I=2,X=3\n");
+    check_rejected("V =1,I=2\n");
+    check_rejected("V= 1,I=2\n");
+    check_rejected("V=1 ,I=2\n");
+    check_rejected("V=1,I=2 x\n");
+    check_rejected("V=1000000,I=2\n");
+    check_rejected("V=--1,I=2\n");
+    check_rejected("V=.,I=2\n");
+    check_rejected("V=1e3,I=2\n");
+    check_rejected("I=2,V=1\n");
+    check_rejected("OK\n");
+
+    PscTelemetry t;
+    PscParser::Result r;
+    parse_one("   \r\n", t, &r);
+    sim_check(r == PscParser::NONE, "blank line is ignored");
+    parse_one(" " PSC_BINARY_ACCEPT "\r\n", t, &r);
+    sim_check(r == PscParser::HANDSHAKE, "binary framing accept line is recognized");
+    check_rejected(PSC_BINARY_ACCEPT "K\n");
+    check_rejected(PSC_BINARY_REQUEST "\n");
+
+    // 過長的行整行丟棄，下一行正常解析
+    std::string stream(PSC_LINE_MAX + 10, ' ');
+    stream += "V=1,I=2\nV=3,I=4\n";
+    PscParser parser;
+    int telemetry = 0;
+    int32_t last_v = 0;
+    for (char c : stream) {
+        if (parser.feed((uint8_t)c, t) == PscParser::TELEMETRY) {
+            telemetry++;
+            last_v = t.voltage_mV;
+        }
+    }
+    sim_check(telemetry == 1 && last_v == 3000 && parser.stats().overlong == 1 && parser.stats().malformed == 1,
+              "overlong line is dropped up to the next newline");
+
+    PscRingBuffer<8> ring;
+    uint8_t data[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    sim_check(ring.write(data, 12) == 8 && ring.dropped() == 4, "full ring drops and counts the excess");
+    uint8_t c = 0;
+    for (int i = 0; i < 5; i++) ring.read(c);
+    sim_check(c == 5 && ring.write(data, 5) == 5 && ring.available() == 8, "ring wraps around");
+    bool ordered = true;
+    for (int i = 0; i < 8; i++) {
+        ring.read(c);
+        if (c != (i < 3 ? 6 + i : i - 2)) ordered = false;
+    }
+    sim_check(ordered && !ring.read(c), "ring returns bytes in order across the wrap");
+}
+
+// --- 基準測試 ---
+static std::vector<std::string> make_telemetry(uint32_t count) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<double> volts(60.0, 120.0), amps(0.0, 100.0);
+    std::vector<std::string> lines(count);
+    char buf[48];
+    for (uint32_t i = 0; i < count; i++) {
+        snprintf(buf, sizeof(buf), "V=%.3f,I=%.3f\r\n", volts(rng), amps(rng));
+        lines[i] = buf;
+    }
+    return lines;
+}
+
+struct BenchResult {
+    double ns_per_line;
+    double allocs_per_line;
+    double checksum;
+};
+
+static BenchResult time_legacy(const std::vector<std::string>& lines) {
+    double sum = 0;
+    uint64_t allocs_before = alloc_count;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& line : lines) {
+        float v = 0, i = 0;
+        for (char c : line) {
+            if (legacy::feed(c, v, i)) sum += v + i;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return { ns / lines.size(), (double)(alloc_count - allocs_before) / lines.size(), sum };
+}
+
+static BenchResult time_ring(const std::vector<std::string>& lines) {
+    PscRingBuffer<256> ring;
+    PscParser parser;
+    double sum = 0;
+    uint64_t allocs_before = alloc_count;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& line : lines) {
+        ring.write((const uint8_t*)line.data(), (uint16_t)line.size());
+        uint8_t c;
+        PscTelemetry t;
+        while (ring.read(c)) {
+            if (parser.feed(c, t) == PscParser::TELEMETRY) sum += t.voltage_mV / 1000.0f + t.current_mA / 1000.0f;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return { ns / lines.size(), (double)(alloc_count - allocs_before) / lines.size(), sum };
+}
+
+int sim_psc_bench(uint32_t lines) {
+    check_cases();
+    if (sim_check_report("PSC parser", "PSC parser checks")) return 1;
+
+    std::vector<std::string> input = make_telemetry(lines);
+    BenchResult legacy_best = { 1e18, 0, 0 }, ring_best = { 1e18, 0, 0 };
+    // 交替執行兩次取較佳值
+    for (int pass = 0; pass < 2; pass++) {
+        BenchResult l = time_legacy(input);
+        BenchResult r = time_ring(input);
+        if (l.ns_per_line < legacy_best.ns_per_line) legacy_best = l;
+        if (r.ns_per_line < ring_best.ns_per_line) ring_best = r;
+    }
+    fprintf(stderr, "\n--- PSC telemetry parsing (%u lines like \"%s\") ---\n",
+            lines, input.empty() ? "" : std::string(input[0], 0, input[0].size() - 2).c_str());
+    fprintf(stderr, "String + substring  : %8.1f ns/line, %10.0f lines/s, %.2f allocations/line\n",
+            legacy_best.ns_per_line, 1e9 / legacy_best.ns_per_line, legacy_best.allocs_per_line);
+    fprintf(stderr, "Ring + state machine: %8.1f ns/line, %10.0f lines/s, %.2f allocations/line (%.1fx)\n",
+            ring_best.ns_per_line, 1e9 / ring_best.ns_per_line, ring_best.allocs_per_line,
+            legacy_best.ns_per_line / ring_best.ns_per_line);
+    fprintf(stderr, "(String is the host shim over std::string; on the ESP32 every allocation also takes the heap lock)\n");
+    fprintf(stderr, "(checksums %.1f / %.1f)\n", legacy_best.checksum, ring_best.checksum);
+    return 0;
+}
+
+// --- 模糊測試 ---
+static const char fuzz_alphabet[] = "VI=,.+-0123456789 \t\r\nxe";
+
+static std::string random_number(std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::string s;
+    if (pick(rng) < 2) s += pick(rng) < 5 ? '-' : '+';
+    int int_digits = std::uniform_int_distribution<int>(0, 7)(rng);
+    for (int i = 0; i < int_digits; i++) s += (char)('0' + pick(rng));
+    if (pick(rng) < 7) {
+        s += '.';
+        int frac_digits = std::uniform_int_distribution<int>(0, 6)(rng);
+        for (int i = 0; i < frac_digits; i++) s += (char)('0' + pick(rng));
+    }
+    return s;
+}
+
+static std::string random_line(std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, 99);
+    std::string line;
+    int kind = pick(rng);
+    if (kind < 50) {
+        if (pick(rng) < 10) line += " \t";
+        line += "V=" + random_number(rng) + ",I=" + random_number(rng);
+        if (pick(rng) < 30) line += '\r';
+    } else if (kind < 80) {
+        // 變造：插入、刪除或替換幾個位元組
+        line = "V=" + random_number(rng) + ",I=" + random_number(rng);
+        int edits = 1 + pick(rng) % 3;
+        for (int e = 0; e < edits; e++) {
+            size_t pos = line.empty() ? 0 : std::uniform_int_distribution<size_t>(0, line.size() - 1)(rng);
+            char c = pick(rng) < 80 ? fuzz_alphabet[pick(rng) % (sizeof(fuzz_alphabet) - 1)] : (char)(pick(rng) * 2 + 1);
+            int op = pick(rng) % 3;
+            if (op == 0) line.insert(line.begin() + pos, c);
+            else if (op == 1 && !line.empty()) line.erase(pos, 1);
+            else if (!line.empty()) line[pos] = c;
+        }
+    } else if (kind < 95) {
+        int len = pick(rng) % 40;
+        for (int i = 0; i < len; i++) line += (char)std::uniform_int_distribution<int>(0, 255)(rng);
+    } else if (kind < 97) {
+        // 協商的接受行，或只差一個字元的
+        line = PSC_BINARY_ACCEPT;
+        if (pick(rng) < 50) line[pick(rng) % line.size()] = fuzz_alphabet[pick(rng) % (sizeof(fuzz_alphabet) - 1)];
+    } else {
+        // 接近與超過長度上限
+        line = std::string(PSC_LINE_MAX - 8 + pick(rng) % 16, ' ') + "V=1,I=2";
+    }
+    return line + '\n';
+}
+
+static void print_escaped(const std::string& s) {
+    for (unsigned char c : s) {
+        if (c == '\n') fprintf(stderr, "\\n");
+        else if (c >= 0x20 && c < 0x7F && c != '\\') fputc(c, stderr);
+        else fprintf(stderr, "\\x%02x", c);
+    }
+    fputc('\n', stderr);
+}
+
+int sim_psc_fuzz(uint32_t iterations, uint32_t seed) {
+    std::mt19937 rng(seed);
+    uint64_t total_lines = 0, total_telemetry = 0, total_malformed = 0;
+    for (uint32_t n = 0; n < iterations; n++) {
+        std::string stream;
+        int line_count = 1 + (int)(rng() % 6);
+        for (int i = 0; i < line_count; i++) stream += random_line(rng);
+
+        // 參考：依 \n 切行
+        std::vector<reference::Result> expected_results;
+        std::vector<PscTelemetry> expected_values;
+        size_t start = 0, nl;
+        while ((nl = stream.find('\n', start)) != std::string::npos) {
+            PscTelemetry t = {0, 0};
+            reference::Result r = reference::parse_line(stream.substr(start, nl - start), t);
+            if (r != reference::NONE) {
+                expected_results.push_back(r);
+                expected_values.push_back(t);
+            }
+            start = nl + 1;
+        }
+
+        // 受測：隨機大小分段寫入小環形緩衝，寫不下時先讀出
+        PscRingBuffer<16> ring;
+        PscParser parser;
+        std::vector<reference::Result> got_results;
+        std::vector<PscTelemetry> got_values;
+        size_t pos = 0;
+        while (pos < stream.size()) {
+            uint16_t chunk = (uint16_t)std::min<size_t>(1 + rng() % 24, stream.size() - pos);
+            uint16_t written = ring.write((const uint8_t*)stream.data() + pos, std::min<uint16_t>(chunk, ring.space()));
+            pos += written;
+            uint8_t c;
+            PscTelemetry t = {0, 0};
+            while (ring.read(c)) {
+                PscParser::Result r = parser.feed(c, t);
+                if (r == PscParser::TELEMETRY) {
+                    got_results.push_back(reference::TELEMETRY);
+                    got_values.push_back(t);
+                } else if (r == PscParser::MALFORMED) {
+                    got_results.push_back(reference::MALFORMED);
+                    got_values.push_back(PscTelemetry{0, 0});
+                } else if (r == PscParser::HANDSHAKE) {
+                    got_results.push_back(reference::HANDSHAKE);
+                    got_values.push_back(PscTelemetry{0, 0});
+                }
+            }
+        }
+
+        bool same = got_results == expected_results && ring.dropped() == 0;
+        for (size_t i = 0; same && i < got_results.size(); i++) {
+            if (got_results[i] == reference::TELEMETRY &&
+                (got_values[i].voltage_mV != expected_values[i].voltage_mV ||
+                 got_values[i].current_mA != expected_values[i].current_mA)) {
+                same = false;
+            }
+        }
+        size_t handshakes = (size_t)std::count(got_results.begin(), got_results.end(), reference::HANDSHAKE);
+        if (!same || parser.stats().lines + parser.stats().malformed + handshakes != got_results.size()) {
+            fprintf(stderr, "FAIL: parser disagrees with the reference (seed %u, iteration %u) on input:\n  ", seed, n);
+            print_escaped(stream);
+            return 1;
+        }
+        total_lines += line_count;
+        total_telemetry += parser.stats().lines;
+        total_malformed += parser.stats().malformed;
+    }
+    fprintf(stderr, "PSC fuzz         : %u inputs, %llu lines (%llu telemetry, %llu malformed), seed %u: OK\n",
+            iterations, (unsigned long long)total_lines, (unsigned long long)total_telemetry,
+            (unsigned long long)total_malformed, seed);
+    return 0;
+}
@@ -0,0 +1,17 @@
+// src/Simulator/SimPscBench.h
+// PSC_Parser.h 的主機端檢查、量測與模糊測試。
+// 基準測試與原本以 String 累積整行再 substring/toFloat 的做法比較每秒行數與每行的記憶體配置次數；
+// 模糊測試把隨機與變造過的資料以隨機大小分段寫入環形緩衝，結果與簡單的參考實作逐行比對。
+
+#ifndef SIM_PSC_BENCH_H
+#define SIM_PSC_BENCH_H
+
+#include <stdint.h>
+
+// 固定案例檢查通過後以 lines 行遙測量測兩種解析器；失敗時回傳非 0
+int sim_psc_bench(uint32_t lines);
+
+// iterations 組隨機輸入，與參考實作不一致時印出該組輸入並回傳非 0
+int sim_psc_fuzz(uint32_t iterations, uint32_t seed);
+
+#endif // SIM_PSC_BENCH_H
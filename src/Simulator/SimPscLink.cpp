@@ -0,0 +1,239 @@
+// src/Simulator/SimPscLink.cpp
+
+#include "SimPscLink.h"
+#include "SimCheck.h"
+#include "SimClock.h"
+#include "SimPSU.h"
+#include "SimRunner.h"
+#include "PowerSupplyController/PowerSupplyController.h"
+#include "PowerSupplyController/PSC_Frame.h"
+#include "Config.h"
+#include <Arduino.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static bool set_raw(int fd) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+int sim_pty_open(char* slave_path, size_t len) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, slave_path, len) != 0 || !set_raw(fd)) {
+        perror("pty");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int sim_tty_open(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (isatty(fd) && !set_raw(fd)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// --- --psu-pty ---
+int sim_psu_pty_run(bool binary_capable, uint32_t corruption_per_mille, uint32_t duration_ms, bool (*should_stop)()) {
+    char slave[128];
+    int master = sim_pty_open(slave, sizeof(slave));
+    if (master < 0) return 1;
+    // 自己保留一個 slave：對方關閉重開時 master 不會收到 EIO，電源照常運作
+    int keep = open(slave, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    sim_clock_set_realtime(true);
+    sim_psu_init(84.0);
+    sim_psu_set_binary_capable(binary_capable);
+    sim_psu_set_corruption(corruption_per_mille);
+    sim_psu_attach_fd(master);
+    printf("%s\n", slave);
+    fflush(stdout);
+    fprintf(stderr, "PSU on %s (%s%s), Ctrl-C to stop\n", slave, binary_capable ? "text + binary framing" : "text only",
+            corruption_per_mille ? ", corrupting frames" : "");
+
+    uint32_t start = millis();
+    bool was_binary = false;
+    uint32_t last_commands = 0;
+    while (!should_stop() && (duration_ms == 0 || millis() - start < duration_ms)) {
+        sim_psu_tick(millis());
+        if (sim_psu_is_binary() != was_binary) {
+            was_binary = sim_psu_is_binary();
+            fprintf(stderr, "[%8.3f] %s\n", (millis() - start) / 1000.0, was_binary ? "binary framing" : "text protocol");
+        }
+        if (sim_psu_get_command_count() != last_commands) {
+            last_commands = sim_psu_get_command_count();
+            fprintf(stderr, "[%8.3f] set %.2f V, %.2f A\n", (millis() - start) / 1000.0,
+                    sim_psu_get_set_voltage(), sim_psu_get_set_current());
+        }
+        sim_clock_advance_us(1000);
+    }
+
+    const SimPsuStats& st = sim_psu_get_stats();
+    fprintf(stderr, "\nPSU              : %u commands, %u frames, %u CRC errors, %u framing errors, "
+                    "%u negotiations, %u reverts, %u corrupted\n",
+            st.commands, st.frames, st.crcErrors, st.framingErrors, st.negotiations, st.reverts, st.corrupted);
+    sim_psu_attach_fd(-1);
+    if (keep >= 0) close(keep);
+    close(master);
+    return 0;
+}
+
+// --- --bench-psc-link ---
+static void psu_model_tick(uint32_t now_ms) { sim_psu_tick(now_ms); }
+
+static void drain(int fd) {
+    uint8_t buf[256];
+    while (read(fd, buf, sizeof(buf)) > 0) {}
+}
+
+// 重新初始化韌體與電源模型，並清掉 PTY 中前一段留下的資料
+static void restart(int master, int slave) {
+    sim_runner_init(84.0);
+    sim_runner_set_model_tick(psu_model_tick);
+    drain(master);
+    drain(slave);
+    sim_uart_attach_fd(0, slave);
+    sim_psu_attach_fd(master);
+}
+
+static bool near(float a, float b) { return fabsf(a - b) < 0.001f; }
+
+static void print_link(const char* label) {
+    PscLinkStats s = psc_get_link_stats();
+    fprintf(stderr, "%-17s: %s, %u frames, %u CRC / %u framing errors, %u telemetry lost, %u ACKs, "
+                    "%u retransmits, %u set failures, RTT %u us (min %u, max %u), ACK max %u us\n",
+            label, s.mode == PSC_LINK_BINARY ? "binary" : s.mode == PSC_LINK_NEGOTIATING ? "negotiating" : "text",
+            s.frames, s.crcErrors, s.framingErrors, s.telemetryLost, s.acks, s.retransmits, s.setFailures,
+            s.rttLastUs, s.rttMinUs, s.rttMaxUs, s.ackMaxUs);
+}
+
+int sim_psc_link_bench() {
+    char slave_path[128];
+    int master = sim_pty_open(slave_path, sizeof(slave_path));
+    if (master < 0) return 1;
+    int slave = sim_tty_open(slave_path);
+    if (slave < 0) {
+        close(master);
+        return 1;
+    }
+    // PTY 的資料由核心工作佇列轉送，有數十微秒的延遲，以即時時間執行才能反映實際的逾時與 RTT
+    sim_clock_set_realtime(true);
+    fprintf(stderr, "PTY              : %s\n", slave_path);
+
+    // 1. 支援框架的電源：連線後協商，100 Hz 遙測，設定值有 ACK
+    // logic_init() 的開機延遲以即時時間執行，期間電源已經連線
+    restart(master, slave);
+    PscLinkStats s = psc_get_link_stats();
+    sim_check(psc_is_connected() && s.mode == PSC_LINK_BINARY && sim_psu_is_binary(), "binary framing is negotiated");
+    uint32_t frames = s.frames;
+    sim_runner_run_for(1000);
+    s = psc_get_link_stats();
+    sim_check(s.negotiations == 1 && s.frames - frames >= 80 && s.crcErrors == 0 && s.telemetryLost == 0,
+              "binary telemetry arrives at 100 Hz");
+    sim_check(s.rttLastUs > 0 && s.rttMaxUs < 50000, "PING/PONG round trip is measured");
+    // 電壓與電流合併為一筆 SET；低於重置值 (6 A) 的電流立即生效
+    uint32_t acks = s.acks;
+    uint32_t commands = sim_psu_get_command_count();
+    psc_set_voltage(80.0);
+    psc_set_current(5.0);
+    sim_runner_run_for(100);
+    s = psc_get_link_stats();
+    sim_check(near(sim_psu_get_set_voltage(), 80.0f) && near(sim_psu_get_set_current(), 5.0f), "setpoints are applied");
+    sim_check(sim_psu_get_command_count() == commands + 1 && s.acks == acks + 1 && s.retransmits == 0,
+              "voltage and current are sent as one acknowledged command");
+    PscSample sample;
+    sim_check(psc_get_sample(sample) && millis() - sample.rxMs <= 50, "published sample is fresh");
+
+    // 電流上升依斜率逐步增加：5 A -> 9 A 以 20 A/s 需要 200 ms
+    psc_set_current(9.0);
+    sim_runner_run_for(100);
+    float ramp = sim_psu_get_set_current();
+    sim_check(ramp > 5.0f && ramp < 9.0f, "current rises along the ramp");
+    sim_runner_run_for(300);
+    sim_check(near(sim_psu_get_set_current(), 9.0f) && near(sim_psu_get_set_voltage(), 80.0f), "ramp reaches the target");
+    psc_set_current(4.0);
+    sim_runner_run_for(PSC_SETPOINT_MIN_INTERVAL_MS + 20);
+    sim_check(near(sim_psu_get_set_current(), 4.0f), "current decrease is applied without ramp");
+
+    // 目標每 1 ms 改變一次，送出的指令仍受限於 PSC_SETPOINT_MIN_INTERVAL_MS，最後一個目標一定送出
+    commands = sim_psu_get_command_count();
+    uint32_t start = millis();
+    for (int i = 0; i < 1000; i++) {
+        psc_set_voltage(70.0f + (i % 10));
+        sim_runner_run_for(1);
+    }
+    uint32_t elapsed = millis() - start;   // 即時時間下每圈不只 1 ms
+    sim_runner_run_for(PSC_SETPOINT_MIN_INTERVAL_MS + 20);
+    uint32_t sent = sim_psu_get_command_count() - commands;
+    sim_check(sent >= 5 && sent <= elapsed / PSC_SETPOINT_MIN_INTERVAL_MS + 2, "command rate is limited");
+    sim_check(near(sim_psu_get_set_voltage(), 79.0f) && psc_get_setpoint_stats().deferred > 0, "latest target wins");
+    fprintf(stderr, "Rate limit       : 1000 target updates in %u ms -> %u commands\n", elapsed, sent);
+    print_link("Binary link");
+
+    // 2. 5% 的輸出框架損壞：CRC 擋下，遺失的 ACK 重送，連線維持
+    sim_psu_set_corruption(50);
+    for (int i = 0; i < 30; i++) {
+        psc_set_current(i % 2 ? 10.0f : 5.0f);
+        sim_runner_run_for(100);
+    }
+    // 最後的 5 A -> 10 A 依斜率需要 250 ms，每筆遺失的 ACK 再多等 PSC_ACK_TIMEOUT_MS；即時時間下保留足夠的餘裕
+    sim_runner_run_for(1000);
+    s = psc_get_link_stats();
+    sim_check(s.crcErrors + s.framingErrors > 0 && s.telemetryLost > 0, "corrupted frames are detected");
+    sim_check(psc_is_connected() && s.mode == PSC_LINK_BINARY && s.setFailures == 0, "link survives 5% frame corruption");
+    sim_check(near(sim_psu_get_set_current(), 10.0f), "last setpoint is applied despite corruption");
+    print_link("5% corruption");
+
+    // 3. 電源的輸出全部損壞：設定值重送後放棄，視為斷線；恢復後電源退回文字協議，重新連線並協商
+    sim_psu_set_corruption(1000);
+    uint32_t retransmits = s.retransmits;
+    psc_set_current(7.0);
+    sim_runner_run_for(400);
+    s = psc_get_link_stats();
+    sim_check(!psc_is_connected() && s.mode == PSC_LINK_TEXT && s.fallbacks == 1, "unacknowledged setpoint drops the link");
+    sim_check(s.setFailures == 1 && s.retransmits == retransmits + PSC_SET_ATTEMPTS - 1, "setpoint is retransmitted before giving up");
+    sim_psu_set_corruption(0);
+    sim_runner_run_for(PSC_LINK_REVERT_MS + 1000);
+    s = psc_get_link_stats();
+    sim_check(psc_is_connected() && s.mode == PSC_LINK_BINARY && s.negotiations == 2 && sim_psu_get_stats().reverts == 1,
+              "link is renegotiated after the PSU reverts to text");
+    print_link("Recovered");
+
+    // 4. 只懂文字協議的電源：協商沒有回應，維持文字協議
+    restart(master, slave);
+    sim_psu_set_binary_capable(false);
+    sim_runner_run_for(PSC_NEGOTIATE_TIMEOUT_MS * PSC_NEGOTIATE_ATTEMPTS + 500);
+    s = psc_get_link_stats();
+    sim_check(psc_is_connected() && s.mode == PSC_LINK_TEXT && s.negotiations == 0, "text-only PSU falls back to text");
+    psc_set_voltage(80.0);
+    psc_set_current(9.0);
+    sim_runner_run_for(400);
+    sim_check(near(sim_psu_get_set_voltage(), 80.0f) && near(sim_psu_get_set_current(), 9.0f), "text setpoint is applied");
+    print_link("Text-only PSU");
+
+    sim_runner_set_model_tick(nullptr);
+    sim_uart_attach_fd(0, -1);
+    sim_psu_attach_fd(-1);
+    close(slave);
+    close(master);
+    sim_clock_set_realtime(false);
+
+    return sim_check_report("PSC link", "PSC link checks");
+}
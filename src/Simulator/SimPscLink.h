@@ -0,0 +1,24 @@
+// src/Simulator/SimPscLink.h
+// 以 PTY 測試電源 UART 協議。電源模型 (SimPSU) 接在 PTY 的一端，另一端可以是：
+//   - 同一個模擬器中的韌體 (--bench-psc-link：協商、ACK/重送、CRC 錯誤與退回文字協議的檢查)
+//   - 另一個模擬器 (--psu-pty 開出 PTY，另一個以 --psu-tty 連上，搭配 --can 即時執行)
+//   - 任何序列埠工具 (picocom、pyserial)
+
+#ifndef SIM_PSC_LINK_H
+#define SIM_PSC_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 開啟 PTY master (raw、非阻塞)，slave 路徑寫入 slave_path；失敗回傳 -1
+int sim_pty_open(char* slave_path, size_t len);
+// 開啟序列埠或 PTY slave (raw、非阻塞)；失敗回傳 -1
+int sim_tty_open(const char* path);
+
+// 以即時時間在 PTY 上執行電源模型，直到 Ctrl-C 或 duration_ms (0 = 不限)
+int sim_psu_pty_run(bool binary_capable, uint32_t corruption_per_mille, uint32_t duration_ms, bool (*should_stop)());
+
+// 韌體與電源模型經由 PTY 連接的檢查；通過回傳 0
+int sim_psc_link_bench();
+
+#endif // SIM_PSC_LINK_H
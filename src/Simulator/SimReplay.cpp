@@ -0,0 +1,194 @@
+// src/Simulator/SimReplay.cpp
+
+#include "SimReplay.h"
+#include "SimClock.h"
+#include "SimPSU.h"
+#include "SimRunner.h"
+#include "SimSession.h"
+#include "ChargerLogic/ChargerLogic.h"
+#include "Config.h"
+#include <chrono>
+#include <stdlib.h>
+
+#define SIM_REPLAY_LOGIC_PERIOD_MS 20
+
+// --- 讀取 ---
+
+static bool is_charger_frame(unsigned long id) {
+    return id == CHARGER_STATUS_ID || id == CHARGER_PARAMS_ID || id == CHARGER_EMERGENCY_STOP_ID;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 解析一行 "(1700000000.123456) can0 500#0011223344556677"，後面的欄位 (例如方向旗標) 忽略
+static bool parse_candump_line(const char* line, uint64_t& time_us, SimCanFrame& frame) {
+    unsigned long long sec = 0, usec = 0;
+    int consumed = 0;
+    if (sscanf(line, " (%llu.%llu) %*s %n", &sec, &usec, &consumed) < 2 || consumed == 0) return false;
+    const char* p = line + consumed;
+    char* end;
+    unsigned long id = strtoul(p, &end, 16);
+    if (end == p || *end != '#') return false;
+    p = end + 1;
+    if (*p == '#' || *p == 'R' || *p == 'r') return false;  // CAN FD 或遠端幀
+    frame.id = id;
+    frame.len = 0;
+    while (frame.len < 8) {
+        int hi = hex_value(p[0]);
+        int lo = hi < 0 ? -1 : hex_value(p[1]);
+        if (lo < 0) break;
+        frame.data[frame.len++] = (byte)(hi << 4 | lo);
+        p += 2;
+    }
+    time_us = (uint64_t)sec * 1000000ULL + usec;
+    return true;
+}
+
+bool sim_replay_load(const char* path, SimReplayLog& log) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    log.frames.clear();
+    log.skippedLines = 0;
+    char line[256];
+    uint64_t first_us = 0;
+    while (fgets(line, sizeof(line), f)) {
+        SimReplayFrame rf;
+        uint64_t t;
+        if (!parse_candump_line(line, t, rf.frame)) {
+            if (line[0] != '\n' && line[0] != '#') log.skippedLines++;
+            continue;
+        }
+        if (log.frames.empty()) first_us = t;
+        // 記錄中時間倒退 (多個檔案串接) 時視為同時到達
+        rf.timeUs = t >= first_us ? t - first_us : 0;
+        if (!log.frames.empty() && rf.timeUs < log.frames.back().timeUs) rf.timeUs = log.frames.back().timeUs;
+        log.frames.push_back(rf);
+    }
+    fclose(f);
+    return true;
+}
+
+// --- 回放 ---
+
+static FILE* events = nullptr;
+static uint64_t origin_us = 0;
+static bool vehicle_gone = false;
+static float logged_output_voltage = 0.0f;  // 記錄中最近一幀 0x509 的實際輸出電壓
+static SimReplayResult* result = nullptr;
+
+static double event_time_ms() {
+    return (sim_clock_now_us() - origin_us) / 1000.0;
+}
+
+static void on_state_change(ChargerState from, ChargerState to, uint32_t now_ms) {
+    (void)now_ms;
+    result->transitions++;
+    if (events) fprintf(events, "%10.3f STATE %s -> %s\n", event_time_ms(), sim_state_name(from), sim_state_name(to));
+}
+
+static void on_hal_event(const SimHalEvent& e) {
+    if (e.type == SIM_HAL_EVENT_CAN_TX) {
+        result->txFrames++;
+        if (!events) return;
+        fprintf(events, "%10.3f TX %03lX", event_time_ms(), (unsigned long)e.frame->id);
+        for (byte i = 0; i < e.frame->len; i++) fprintf(events, " %02X", e.frame->data[i]);
+        fputc('\n', events);
+        return;
+    }
+    result->relayEvents++;
+    if (!events) return;
+    static const char* const names[] = {"CHARGE_RELAY", "VP_RELAY", "COUPLER_LOCK"};
+    fprintf(events, "%10.3f %s %s\n", event_time_ms(), names[e.type], e.on ? "ON" : "OFF");
+}
+
+// 取代 SimVehicle：只提供 CP 與輸出電壓，報文由記錄提供
+static void replay_model_tick(uint32_t now_ms) {
+    (void)now_ms;
+    SimCanFrame tx;
+    while (sim_hal_can_pop_tx(tx)) {}
+    sim_hal_set_cp_voltage(sim_hal_get_vp_relay() && !vehicle_gone ? 12.0f : 0.0f);
+    bool energized = hal_get_charge_relay_state() && !vehicle_gone;
+    float vbat = logged_output_voltage > 0.0f ? logged_output_voltage : sim_psu_get_output_voltage();
+    sim_psu_set_load(energized, vbat);
+    sim_hal_set_output_voltage(energized ? vbat : 0.0f);
+}
+
+static void press_start() {
+    if (events) fprintf(events, "%10.3f START\n", event_time_ms());
+    logic_start_button_pressed();
+}
+
+SimReplayResult sim_replay_run(const SimReplayLog& log, const SimReplayOptions& options) {
+    SimReplayResult r;
+    memset(&r, 0, sizeof(r));
+    result = &r;
+    events = options.events;
+    vehicle_gone = false;
+    logged_output_voltage = 0.0f;
+    origin_us = sim_clock_now_us();
+    sim_runner_set_state_hook(on_state_change);
+    sim_runner_set_model_tick(replay_model_tick);
+    sim_hal_set_event_hook(on_hal_event);
+
+    // 自動決定 START：充電樁在按下 START 後的第一個邏輯週期開始發送 0x508
+    uint64_t start_us = 0;
+    if (options.startAtMs >= 0) {
+        start_us = (uint64_t)options.startAtMs * 1000;
+    } else {
+        for (size_t i = 0; i < log.frames.size(); i++) {
+            if (log.frames[i].frame.id == CHARGER_STATUS_ID) {
+                uint64_t t = log.frames[i].timeUs;
+                start_us = t > SIM_REPLAY_LOGIC_PERIOD_MS * 1000 ? t - SIM_REPLAY_LOGIC_PERIOD_MS * 1000 : 0;
+                break;
+            }
+        }
+    }
+    bool started = false;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    sim_hal_set_cp_voltage(12.0f);
+    for (size_t i = 0; i < log.frames.size(); i++) {
+        const SimReplayFrame& rf = log.frames[i];
+        if (!started && start_us <= rf.timeUs) {
+            sim_runner_run_until_us(origin_us + start_us);
+            press_start();
+            started = true;
+        }
+        if (is_charger_frame(rf.frame.id)) {
+            r.chargerFrames++;
+            if (rf.frame.id == CHARGER_PARAMS_ID && rf.frame.len >= 4) {
+                logged_output_voltage = (rf.frame.data[2] | rf.frame.data[3] << 8) / 10.0f;
+            }
+            continue;
+        }
+        sim_runner_run_until_us(origin_us + rf.timeUs);
+        sim_hal_can_inject(rf.frame);
+        sim_runner_deliver_can();
+        r.vehicleFrames++;
+    }
+    if (!started) {
+        press_start();
+    }
+    r.logDurationMs = log.frames.empty() ? 0 : (uint32_t)(log.frames.back().timeUs / 1000);
+
+    // 記錄結束：車輛不再發送報文並放開 CP
+    vehicle_gone = true;
+    if (events) fprintf(events, "%10.3f END OF LOG\n", event_time_ms());
+    sim_runner_run_for(options.tailMs);
+
+    r.finalState = logic_get_charger_state();
+    r.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    sim_hal_set_event_hook(nullptr);
+    sim_runner_set_model_tick(nullptr);
+    sim_runner_set_state_hook(nullptr);
+    result = nullptr;
+    return r;
+}
@@ -0,0 +1,47 @@
+// src/Simulator/SimReplay.h
+// candump -l 記錄回放：把實車記錄中的車輛報文 (0x500/0x501/0x5F0) 依原始時間間隔注入 HAL，
+// 由 can_protocol_handle_receive() 與狀態機處理，並記錄每次狀態轉換、充電樁發出的報文與繼電器動作。
+// 事件記錄的格式固定，可直接 diff 作為回歸測試；多個記錄檔依序回放可作為整條解碼+邏輯路徑的吞吐量基準。
+
+#ifndef SIM_REPLAY_H
+#define SIM_REPLAY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "SimHAL.h"
+
+struct SimReplayFrame {
+    uint64_t timeUs;   // 相對於記錄中第一幀
+    SimCanFrame frame;
+};
+
+struct SimReplayLog {
+    std::vector<SimReplayFrame> frames;
+    uint32_t skippedLines;   // 無法解析、遠端幀、CAN FD 等略過的行
+};
+
+// 讀取 candump -l 格式：(秒.微秒) 介面 ID#資料
+bool sim_replay_load(const char* path, SimReplayLog& log);
+
+struct SimReplayOptions {
+    int32_t startAtMs;     // 相對記錄開頭按下 START 的時間；< 0 表示自動 (記錄中第一幀 0x508 之前一個邏輯週期)
+    uint32_t tailMs;       // 記錄結束 (車輛離線) 後繼續執行的時間
+    FILE* events;          // 事件輸出，nullptr 表示不輸出
+};
+
+struct SimReplayResult {
+    uint32_t vehicleFrames;    // 注入的車輛端報文
+    uint32_t chargerFrames;    // 記錄中原本由充電樁發出的報文 (不注入，只用來決定 START 時間與輸出電壓)
+    uint32_t logDurationMs;
+    uint32_t transitions;
+    uint32_t txFrames;         // 回放時充電樁發出的報文
+    uint32_t relayEvents;
+    ChargerState finalState;
+    double wallMs;
+};
+
+// 先呼叫 sim_runner_init()；即時或最快速度由 sim_clock_set_realtime() 決定，兩者都保持原始的報文間隔
+SimReplayResult sim_replay_run(const SimReplayLog& log, const SimReplayOptions& options);
+
+#endif // SIM_REPLAY_H
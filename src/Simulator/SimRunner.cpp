@@ -0,0 +1,218 @@
+// src/Simulator/SimRunner.cpp
+
+#include "SimRunner.h"
+#include "SimClock.h"
+#include "SimHAL.h"
+#include "SimPSU.h"
+#include "ChargerLogic/ChargerLogic.h"
+#include "ConfigStore/ConfigStore.h"
+#include "CAN_Protocol/CAN_Protocol.h"
+#include "CAN_Protocol/CAN_TxScheduler.h"
+#include "CAN_Protocol/CAN_BusHealth.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "Config.h"
+#include "PowerSupplyController/PowerSupplyController.h"
+#include <chrono>
+
+#define SIM_LOGIC_TASK_PERIOD_MS 20
+#define SIM_MODEL_PERIOD_MS      10
+
+extern DisplayData globalDisplayData;
+
+// --- 對應 main.cpp 的 logicTaskHandle，接收 CAN 任務的安全事件通知 ---
+static SimTask logic_task = {0};
+TaskHandle_t logicTaskHandle = &logic_task;
+// Config 任務：只需要到期時寫入，每個模型週期檢查一次即可，通知不另外處理
+static SimTask config_task = {0};
+TaskHandle_t configTaskHandle = &config_task;
+// PSC 接收任務：優先級高於 Logic，UART 收到資料 (通知) 時立即執行，另外定期檢查斷線
+static SimTask psc_rx_task = {0};
+TaskHandle_t pscRxTaskHandle = &psc_rx_task;
+
+static SimModelTick model_tick = nullptr;
+static SimStateHook state_hook = nullptr;
+static SimLoopStats logic_stats;
+
+static uint32_t next_logic_ms = 0;
+static uint32_t next_model_ms = 0;
+static uint32_t next_tx_tick_ms = 0;
+static uint32_t next_psc_check_ms = 0;
+static ChargerState last_state = STATE_CHG_IDLE;
+
+static void run_psc_rx(uint32_t now) {
+    if (psc_rx_task.notifications == 0 && (int32_t)(now - next_psc_check_ms) < 0) return;
+    psc_rx_task.notifications = 0;
+    next_psc_check_ms = now + psc_rx_service();
+}
+
+static void run_models(uint32_t now) {
+    // UART0 接到外部 (--psu-tty) 時由外部電源回應，內建模型不參與
+    if (!sim_uart_is_external(0)) sim_psu_tick(now);
+    if (model_tick) model_tick(now);
+    sim_uart_poll();
+    run_psc_rx(now);
+}
+
+// CAN TX 任務優先級高於 Logic，報文一進佇列就會被送出
+static void run_can_tx() {
+    while (can_tx_handle_transmit(0)) {}
+}
+
+// 執行到期的背景任務 (邏輯任務除外)。
+// CAN 任務阻塞在接收佇列上，因此模型送出報文後立即被解析。
+static void run_background_due(uint32_t now) {
+    run_can_tx();
+    sim_uart_poll();
+    run_psc_rx(now);
+    if ((int32_t)(now - next_tx_tick_ms) >= 0) {
+        next_tx_tick_ms += PERIODIC_SEND_INTERVAL;
+        can_tx_periodic_tick();
+        run_can_tx();
+    }
+    if ((int32_t)(now - next_model_ms) >= 0) {
+        next_model_ms += SIM_MODEL_PERIOD_MS;
+        run_models(now);
+        can_protocol_handle_receive();
+        can_bus_health_poll();
+        config_writer_service(now);
+    }
+}
+
+// 邏輯任務在 delay() 期間，其他任務照常運作
+static void delay_hook(uint32_t ms) {
+    uint64_t end_us = sim_clock_now_us() + (uint64_t)ms * 1000;
+    while (sim_clock_now_us() < end_us) {
+        sim_clock_advance_us(1000);
+        run_background_due(millis());
+    }
+}
+
+static void record_state_change() {
+    ChargerState state = logic_get_charger_state();
+    if (state != last_state) {
+        if (state_hook) state_hook(last_state, state, millis());
+        last_state = state;
+    }
+}
+
+static void logic_task_iteration() {
+    uint64_t start_us = sim_clock_now_us();
+    auto wall_start = std::chrono::steady_clock::now();
+
+    logic_run_statemachine();
+    logic_handle_periodic_tasks();
+    logic_get_display_data(globalDisplayData);
+    run_can_tx();
+    can_trace_service();  // 實機由 WiFi 任務呼叫
+
+    uint64_t wall_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wall_start).count();
+    uint32_t virtual_ms = (uint32_t)((sim_clock_now_us() - start_us) / 1000);
+
+    logic_stats.iterations++;
+    logic_stats.total_wall_ns += wall_ns;
+    if (wall_ns > logic_stats.max_wall_ns) logic_stats.max_wall_ns = wall_ns;
+    if (virtual_ms > logic_stats.max_virtual_ms) logic_stats.max_virtual_ms = virtual_ms;
+    record_state_change();
+}
+
+void sim_runner_init(float psu_nominal_voltage) {
+    sim_clock_reset();
+    sim_hal_reset();
+    sim_psu_init(psu_nominal_voltage);
+    sim_hal_set_supply_voltage(psu_nominal_voltage);
+    sim_clock_set_delay_hook(delay_hook);
+
+    hal_init_pins();
+    hal_init_adc();
+    can_trace_init();
+    hal_init_can();
+    can_bus_health_init();
+    can_tx_init();
+    psc_init();
+    config_init();
+    logic_init();
+
+    uint32_t now = millis();
+    logic_task.notifications = 0;
+    next_logic_ms = now;
+    next_model_ms = now;
+    next_tx_tick_ms = now + PERIODIC_SEND_INTERVAL;
+    psc_rx_task.notifications = 0;
+    next_psc_check_ms = now;
+    last_state = logic_get_charger_state();
+    sim_runner_reset_stats();
+}
+
+void sim_runner_set_model_tick(SimModelTick tick) { model_tick = tick; }
+void sim_runner_set_state_hook(SimStateHook hook) { state_hook = hook; }
+
+uint32_t sim_runner_now_ms() { return millis(); }
+const SimLoopStats& sim_runner_get_logic_stats() { return logic_stats; }
+void sim_runner_reset_stats() { memset(&logic_stats, 0, sizeof(logic_stats)); }
+
+// limit：最多推進到這個時間點 (回放時不跳過下一幀報文的到達時間)
+static void step(uint32_t limit) {
+    uint32_t now = millis();
+    run_background_due(now);
+    // Logic 任務在週期之間以 ulTaskNotifyTake 等待，收到通知立即處理安全事件
+    if (logic_task.notifications > 0) {
+        logic_task.notifications = 0;
+        logic_handle_safety_event();
+        run_can_tx();
+        record_state_change();
+    }
+    if ((int32_t)(now - next_logic_ms) >= 0) {
+        logic_task_iteration();
+        // 與 vTaskDelayUntil 相同：若本輪超時，下一輪立即執行而不累積
+        next_logic_ms += SIM_LOGIC_TASK_PERIOD_MS;
+        if ((int32_t)(millis() - next_logic_ms) > 0) next_logic_ms = millis();
+    }
+
+    // 跳到下一個排程點
+    uint32_t next = next_logic_ms;
+    if ((int32_t)(next_model_ms - next) < 0) next = next_model_ms;
+    if ((int32_t)(next_tx_tick_ms - next) < 0) next = next_tx_tick_ms;
+    if ((int32_t)(next_psc_check_ms - next) < 0) next = next_psc_check_ms;
+    if ((int32_t)(limit - next) < 0) next = limit;
+    now = millis();
+    // 外部 UART (--psu-tty) 的資料到達時沒有辦法喚醒休眠，每 1 ms 輪詢一次
+    if (sim_uart_is_external(0) && (int32_t)(next - now) > 1) next = now + 1;
+    if ((int32_t)(next - now) > 0) {
+        sim_clock_advance_us((uint64_t)(next - now) * 1000);
+    }
+}
+
+void sim_runner_run_for(uint32_t duration_ms) {
+    uint32_t end = millis() + duration_ms;
+    while ((int32_t)(millis() - end) < 0) {
+        step(end);
+    }
+}
+
+void sim_runner_run_until_us(uint64_t target_us) {
+    uint32_t end = (uint32_t)(target_us / 1000);
+    while ((int32_t)(millis() - end) < 0) {
+        step(end);
+    }
+    if (sim_clock_now_us() < target_us) sim_clock_advance_us(target_us - sim_clock_now_us());
+}
+
+void sim_runner_deliver_can() {
+    can_protocol_handle_receive();
+    if (logic_task.notifications > 0) {
+        logic_task.notifications = 0;
+        logic_handle_safety_event();
+        run_can_tx();
+        record_state_change();
+    }
+}
+
+bool sim_runner_run_until(bool (*predicate)(), uint32_t timeout_ms) {
+    uint32_t end = millis() + timeout_ms;
+    while ((int32_t)(millis() - end) < 0) {
+        step(end);
+        if (predicate()) return true;
+    }
+    return false;
+}
@@ -0,0 +1,40 @@
+// src/Simulator/SimRunner.h
+// 以虛擬時間重現 main.cpp 的 FreeRTOS 任務配置 (事件驅動的 CAN 接收、CAN TX 排程器、Logic 20ms)，
+// 並量測每次邏輯迴圈的執行時間。
+
+#ifndef SIM_RUNNER_H
+#define SIM_RUNNER_H
+
+#include <stdint.h>
+#include "Charger_Defs.h"
+
+struct SimLoopStats {
+    uint32_t iterations;
+    uint64_t total_wall_ns;
+    uint64_t max_wall_ns;
+    uint32_t max_virtual_ms;  // 單次迴圈內被 delay() 佔用的虛擬時間
+};
+
+// 模擬周邊 (車輛、電源等) 的週期性處理，在每個排程點被呼叫
+typedef void (*SimModelTick)(uint32_t now_ms);
+typedef void (*SimStateHook)(ChargerState from, ChargerState to, uint32_t now_ms);
+
+// 對應 setup()：初始化 HAL、電源控制器與充電邏輯
+void sim_runner_init(float psu_nominal_voltage);
+
+void sim_runner_set_model_tick(SimModelTick tick);
+void sim_runner_set_state_hook(SimStateHook hook);
+
+void sim_runner_run_for(uint32_t duration_ms);
+// 執行到虛擬時鐘等於 target_us (不足 1 ms 的部分直接推進時鐘)
+void sim_runner_run_until_us(uint64_t target_us);
+// 報文注入 HAL 後立即交給 CAN 任務處理，與實機事件驅動的接收相同
+void sim_runner_deliver_can();
+// 執行直到 predicate 成立或超時，成立時回傳 true
+bool sim_runner_run_until(bool (*predicate)(), uint32_t timeout_ms);
+
+uint32_t sim_runner_now_ms();
+const SimLoopStats& sim_runner_get_logic_stats();
+void sim_runner_reset_stats();
+
+#endif // SIM_RUNNER_H
@@ -0,0 +1,102 @@
+// src/Simulator/SimSession.cpp
+
+#include "SimSession.h"
+#include "SimHAL.h"
+#include "SimRunner.h"
+#include "ChargerLogic/ChargerLogic.h"
+#include <chrono>
+
+static bool trace = false;
+static bool left_idle = false;
+static bool back_to_idle = false;
+static bool saw_dc_output = false;
+static bool saw_fault = false;
+static bool saw_emergency = false;
+static uint32_t start_ms = 0;
+static uint32_t dc_output_ms = 0;
+static uint32_t transitions = 0;
+
+const char* sim_state_name(ChargerState s) {
+    switch (s) {
+        case STATE_CHG_IDLE: return "IDLE";
+        case STATE_CHG_INITIAL_PARAM_EXCHANGE: return "INITIAL_PARAM_EXCHANGE";
+        case STATE_CHG_PRE_CHARGE_OPERATIONS: return "PRE_CHARGE";
+        case STATE_CHG_DC_CURRENT_OUTPUT: return "DC_CURRENT_OUTPUT";
+        case STATE_CHG_ENDING_CHARGE_PROCESS: return "ENDING";
+        case STATE_CHG_FAULT_HANDLING: return "FAULT_HANDLING";
+        case STATE_CHG_EMERGENCY_STOP_PROC: return "EMERGENCY_STOP";
+        case STATE_CHG_FINALIZATION: return "FINALIZATION";
+    }
+    return "?";
+}
+
+const char* sim_session_outcome_name(SimSessionOutcome outcome) {
+    switch (outcome) {
+        case SIM_SESSION_COMPLETE: return "complete";
+        case SIM_SESSION_FAULT: return "fault";
+        case SIM_SESSION_EMERGENCY: return "emergency";
+        case SIM_SESSION_NOT_STARTED: return "not-started";
+        case SIM_SESSION_TIMEOUT: return "timeout";
+    }
+    return "?";
+}
+
+void sim_session_set_trace(bool enabled) { trace = enabled; }
+
+static void on_state_change(ChargerState from, ChargerState to, uint32_t now_ms) {
+    transitions++;
+    if (trace) {
+        fprintf(stderr, "[%9lu ms] %s -> %s\n", (unsigned long)now_ms, sim_state_name(from), sim_state_name(to));
+    }
+    if (from == STATE_CHG_IDLE) left_idle = true;
+    if (to == STATE_CHG_DC_CURRENT_OUTPUT && !saw_dc_output) {
+        saw_dc_output = true;
+        dc_output_ms = now_ms;
+    }
+    if (to == STATE_CHG_FAULT_HANDLING) saw_fault = true;
+    if (to == STATE_CHG_EMERGENCY_STOP_PROC) saw_emergency = true;
+    if (to == STATE_CHG_IDLE && left_idle) back_to_idle = true;
+}
+
+static bool session_finished() { return back_to_idle; }
+static bool session_started() { return left_idle; }
+
+SimSessionResult sim_session_run(uint32_t timeout_ms) {
+    SimSessionResult result;
+    memset(&result, 0, sizeof(result));
+    left_idle = back_to_idle = saw_dc_output = saw_fault = saw_emergency = false;
+    transitions = 0;
+    sim_runner_set_state_hook(on_state_change);
+
+    auto wall_start = std::chrono::steady_clock::now();
+
+    sim_vehicle_plug_in();
+    start_ms = sim_runner_now_ms();
+    sim_hal_set_button(BUTTON_START, true);
+    bool started = sim_runner_run_until(session_started, 200);
+    sim_hal_set_button(BUTTON_START, false);
+
+    if (!started) {
+        result.outcome = SIM_SESSION_NOT_STARTED;
+    } else if (!sim_runner_run_until(session_finished, timeout_ms)) {
+        result.outcome = SIM_SESSION_TIMEOUT;
+    } else if (saw_emergency) {
+        result.outcome = SIM_SESSION_EMERGENCY;
+    } else if (saw_fault) {
+        result.outcome = SIM_SESSION_FAULT;
+    } else {
+        result.outcome = SIM_SESSION_COMPLETE;
+    }
+
+    result.handshakeMs = saw_dc_output ? dc_output_ms - start_ms : 0;
+    result.durationMs = sim_runner_now_ms() - start_ms;
+    result.transitions = transitions;
+    const SimVehicleStats& vs = sim_vehicle_get_stats();
+    uint32_t relay_open = sim_hal_get_relay_open_ms();
+    if (vs.faultVisibleMs > 0 && relay_open >= vs.faultVisibleMs) {
+        result.faultToRelayOpenMs = relay_open - vs.faultVisibleMs;
+    }
+    result.finalSoc = sim_vehicle_get_stats().soc;
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    return result;
+}
@@ -0,0 +1,36 @@
+// src/Simulator/SimSession.h
+// 完整充電流程的驅動器：插槍 -> 按下 START -> 等待狀態機回到 IDLE，並記錄握手延遲等數據。
+
+#ifndef SIM_SESSION_H
+#define SIM_SESSION_H
+
+#include <stdint.h>
+#include "Charger_Defs.h"
+#include "SimVehicle.h"
+
+enum SimSessionOutcome {
+    SIM_SESSION_COMPLETE,       // 經 ENDING/FINALIZATION 正常結束
+    SIM_SESSION_FAULT,          // 經 FAULT_HANDLING 結束
+    SIM_SESSION_EMERGENCY,      // 經 EMERGENCY_STOP 結束
+    SIM_SESSION_NOT_STARTED,    // 按下 START 後未離開 IDLE
+    SIM_SESSION_TIMEOUT         // 超過時限仍未回到 IDLE
+};
+
+struct SimSessionResult {
+    SimSessionOutcome outcome;
+    uint32_t handshakeMs;       // START -> DC_CURRENT_OUTPUT (虛擬時間)，未到達時為 0
+    uint32_t durationMs;        // START -> 回到 IDLE (虛擬時間)
+    uint32_t faultToRelayOpenMs;  // 故障可見 -> 主繼電器斷開，無故障或繼電器未斷開時為 0
+    uint32_t transitions;
+    float finalSoc;
+    double wallMs;
+};
+
+SimSessionResult sim_session_run(uint32_t timeout_ms);
+const char* sim_session_outcome_name(SimSessionOutcome outcome);
+const char* sim_state_name(ChargerState state);
+
+// 啟用時每次狀態轉換都會印到 stderr
+void sim_session_set_trace(bool enabled);
+
+#endif // SIM_SESSION_H
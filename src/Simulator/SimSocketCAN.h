@@ -0,0 +1,27 @@
+// src/Simulator/SimSocketCAN.h
+// Linux SocketCAN 後端：讓 hal_can_send()/hal_can_receive() 直接連到 vcan0 或 USB-CAN 轉接器，
+// 可以用 candump/cangen 在 PC 上與韌體邏輯互通並量測解碼吞吐量。
+
+#ifndef SIM_SOCKETCAN_H
+#define SIM_SOCKETCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct SimSocketCanStats {
+    uint64_t rxFrames;
+    uint64_t txFrames;
+    uint64_t txErrors;       // 發送失敗 (例如 ENOBUFS：介面佇列已滿)
+    uint64_t rxKernelDrops;  // 核心 socket 佇列溢位而丟棄的報文 (SO_RXQ_OVFL)
+};
+
+bool sim_socketcan_open(const char* ifname);
+void sim_socketcan_close();
+bool sim_socketcan_is_open();
+
+bool sim_socketcan_send(unsigned long id, const uint8_t* data, uint8_t len);
+bool sim_socketcan_receive(unsigned long* id, uint8_t* len, uint8_t* buf, uint32_t timeout_ms = 0);
+
+const SimSocketCanStats& sim_socketcan_get_stats();
+
+#endif // SIM_SOCKETCAN_H
@@ -0,0 +1,18 @@
+// src/Simulator/SimStubs.cpp
+// 充電邏輯所引用、但在主機模擬中不存在的模組 (OTA、OLED、檔案系統) 的替身。
+
+#include <Arduino.h>
+#include "OTAManager/OTAManager.h"
+
+bool filesystem_version_mismatch = false;
+
+void ui_show_boot_screen(const char* /* line1 */, const char* /* line2 */) {}
+
+void ota_init() {}
+void ota_handle_tasks() {}
+void ota_start_check() {}
+void ota_start_full_update() {}
+OTAStatus ota_get_status() { return OTA_IDLE; }
+const char* ota_get_status_message() { return "Simulated"; }
+const char* ota_get_latest_version() { return ""; }
+int ota_get_progress() { return 0; }
@@ -0,0 +1,251 @@
+// src/Simulator/SimVehicle.cpp
+
+#include "SimVehicle.h"
+#include "SimHAL.h"
+#include "SimPSU.h"
+#include "Config.h"
+
+#define SIM_ESTOP_HOLD_MS 200
+
+static SimVehicleConfig cfg;
+static SimVehicleStats stats;
+
+static bool plugged = false;
+static bool released = false;          // 充電結束後車輛放開 CP，可拔槍
+static bool permission = false;
+static bool permissionGiven = false;    // 每次充電只給一次許可
+static bool contactorClosed = false;
+static bool chargerSeen = false;
+static uint32_t chargerSeenTime = 0;
+static bool chargerReadySeen = false;
+static uint32_t chargerReadyTime = 0;
+static bool dcActive = false;
+static uint32_t dcStartTime = 0;
+static uint32_t lastFrameTime = 0;
+static uint32_t lastTickTime = 0;
+static byte sequenceNumber = 0;
+
+static byte chargerStatusFlags = 0;
+static byte chargerEmergencyFlags = 0;
+static bool chargerStatusFault = false;      // 最後一筆 0x508 的故障旗標
+static bool chargerEmergencySeen = false;    // 本次充電已收到 0x5F8 緊急停止
+
+SimVehicleConfig sim_vehicle_default_config() {
+    SimVehicleConfig c;
+    c.startSoc = 20;
+    c.stopSoc = 100;
+    c.capacityAh = 30.0;
+    c.socAcceleration = 200.0;
+    c.emptyVoltage = 60.0;
+    c.fullVoltage = 82.0;
+    c.chargeVoltageLimit_0_1V = 840;
+    c.maxChargeVoltage_0_1V = 840;
+    c.maxCurrent_0_1A = 100;
+    c.minCurrent_0_1A = 10;
+    c.taperStartSoc = 80;
+    c.maxChargeTime_min = 180;
+    c.permissionDelayMs = 200;
+    c.contactorDelayMs = 100;
+    c.framePeriodMs = 100;
+    c.fault = SIM_FAULT_NONE;
+    c.faultAtMs = 5000;
+    return c;
+}
+
+void sim_vehicle_init(const SimVehicleConfig& config) {
+    cfg = config;
+    memset(&stats, 0, sizeof(stats));
+    plugged = false;
+}
+
+void sim_vehicle_plug_in() {
+    plugged = true;
+    released = false;
+    permission = false;
+    permissionGiven = false;
+    contactorClosed = false;
+    chargerSeen = false;
+    chargerReadySeen = false;
+    dcActive = false;
+    chargerStatusFlags = 0;
+    chargerEmergencyFlags = 0;
+    chargerStatusFault = false;
+    chargerEmergencySeen = false;
+    stats.soc = (float)cfg.startSoc;
+    stats.faultInjected = false;
+    stats.faultVisibleMs = 0;
+}
+
+const SimVehicleStats& sim_vehicle_get_stats() { return stats; }
+
+static bool fault_active(SimVehicleFault type) {
+    return cfg.fault == type && stats.faultInjected;
+}
+
+static uint16_t current_request_0_1A() {
+    if (!permission || !contactorClosed) return 0;
+    if (stats.soc < cfg.taperStartSoc) return cfg.maxCurrent_0_1A;
+    float span = 100.0f - cfg.taperStartSoc;
+    float ratio = span > 0 ? (100.0f - stats.soc) / span : 0.0f;
+    float req = cfg.minCurrent_0_1A + (cfg.maxCurrent_0_1A - cfg.minCurrent_0_1A) * ratio;
+    return (uint16_t)constrain(req, (float)cfg.minCurrent_0_1A, (float)cfg.maxCurrent_0_1A);
+}
+
+static float battery_voltage() {
+    return cfg.emptyVoltage + (cfg.fullVoltage - cfg.emptyVoltage) * stats.soc / 100.0f;
+}
+
+static void send_frame(unsigned long id, const byte* data) {
+    SimCanFrame frame;
+    frame.id = id;
+    frame.len = 8;
+    memcpy(frame.data, data, 8);
+    sim_hal_can_inject(frame);
+    stats.framesSent++;
+}
+
+static void send_vehicle_frames() {
+    byte d[8];
+    uint16_t req = current_request_0_1A();
+
+    byte statusFlags = 0;
+    if (permission) statusFlags |= 0x01;
+    if (!contactorClosed) statusFlags |= 0x02;
+
+    d[0] = fault_active(SIM_FAULT_BMS_FLAGS) ? 0x01 : 0x00;
+    if (d[0] && stats.faultVisibleMs == 0) stats.faultVisibleMs = millis();
+    d[1] = statusFlags;
+    d[2] = req & 0xFF;
+    d[3] = (req >> 8) & 0xFF;
+    d[4] = cfg.chargeVoltageLimit_0_1V & 0xFF;
+    d[5] = (cfg.chargeVoltageLimit_0_1V >> 8) & 0xFF;
+    d[6] = cfg.maxChargeVoltage_0_1V & 0xFF;
+    d[7] = (cfg.maxChargeVoltage_0_1V >> 8) & 0xFF;
+    send_frame(VEHICLE_STATUS_ID, d);
+
+    uint16_t remaining_min = cfg.maxChargeTime_min;
+    memset(d, 0, 8);
+    d[0] = sequenceNumber;
+    d[1] = (byte)stats.soc;
+    d[2] = cfg.maxChargeTime_min & 0xFF;
+    d[3] = (cfg.maxChargeTime_min >> 8) & 0xFF;
+    d[4] = remaining_min & 0xFF;
+    d[5] = (remaining_min >> 8) & 0xFF;
+    send_frame(VEHICLE_PARAMS_ID, d);
+
+    memset(d, 0, 8);
+    // 充電樁回應緊急停止並斷開後，車輛撤回緊急請求
+    d[0] = (fault_active(SIM_FAULT_EMERGENCY) && !released) ? 0x01 : 0x00;
+    if (d[0] && stats.faultVisibleMs == 0) stats.faultVisibleMs = millis();
+    send_frame(VEHICLE_EMERGENCY_ID, d);
+}
+
+static void consume_charger_frames(uint32_t now) {
+    SimCanFrame frame;
+    while (sim_hal_can_pop_tx(frame)) {
+        stats.framesReceived++;
+        switch (frame.id) {
+            case CHARGER_STATUS_ID:
+                stats.chargerStatusFrames++;
+                chargerStatusFlags = frame.data[1];
+                chargerStatusFault = (frame.data[0] & 0x01) != 0;
+                if (chargerEmergencySeen && !chargerStatusFault) stats.emergencyOrderErrors++;
+                if (!chargerSeen) {
+                    chargerSeen = true;
+                    chargerSeenTime = now;
+                }
+                break;
+            case CHARGER_PARAMS_ID:
+                stats.chargerParamsFrames++;
+                sequenceNumber = frame.data[0];
+                break;
+            case CHARGER_EMERGENCY_STOP_ID:
+                stats.chargerEmergencyFrames++;
+                chargerEmergencyFlags = frame.data[0];
+                // 充電樁應先送出帶故障旗標的 0x508，再送 0x5F8
+                if ((frame.data[0] & 0x01) && !chargerEmergencySeen) {
+                    chargerEmergencySeen = true;
+                    if (!chargerStatusFault) stats.emergencyOrderErrors++;
+                }
+                break;
+        }
+    }
+}
+
+void sim_vehicle_tick(uint32_t now) {
+    uint32_t dt = now - lastTickTime;
+    lastTickTime = now;
+
+    consume_charger_frames(now);
+    if (fault_active(SIM_FAULT_ESTOP_BUTTON) && now - stats.faultVisibleMs >= SIM_ESTOP_HOLD_MS) {
+        sim_hal_set_button(BUTTON_EMERGENCY, false);
+    }
+    if (!plugged) {
+        sim_hal_set_cp_voltage(0.0);
+        return;
+    }
+
+    // --- 握手流程 ---
+    if (chargerSeen && !permissionGiven && now - chargerSeenTime >= cfg.permissionDelayMs) {
+        permission = true;
+        permissionGiven = true;
+    }
+    if ((chargerStatusFlags & 0x04) && !contactorClosed && !released) {
+        if (!chargerReadySeen) {
+            chargerReadySeen = true;
+            chargerReadyTime = now;
+        }
+        if (now - chargerReadyTime >= cfg.contactorDelayMs) {
+            contactorClosed = true;
+        }
+    }
+    // 充電樁宣告停止 (0x01) 且繼電器已斷開 (0x02 清除)，或送出緊急停止：斷開接觸器並放開 CP
+    if (contactorClosed && (((chargerStatusFlags & 0x01) && !(chargerStatusFlags & 0x02)) || (chargerEmergencyFlags & 0x01))) {
+        contactorClosed = false;
+        permission = false;
+        released = true;
+        dcActive = false;
+    }
+
+    bool chargerRelay = hal_get_charge_relay_state();
+    bool energized = contactorClosed && chargerRelay;
+    if (energized && !dcActive) {
+        dcActive = true;
+        dcStartTime = now;
+    }
+
+    // --- 故障注入 ---
+    if (cfg.fault != SIM_FAULT_NONE && dcActive && !stats.faultInjected && now - dcStartTime >= cfg.faultAtMs) {
+        stats.faultInjected = true;
+        if (cfg.fault == SIM_FAULT_STOP_REQUEST) permission = false;
+        if (cfg.fault == SIM_FAULT_BUS_OFF) sim_hal_can_force_bus_off();
+        if (cfg.fault == SIM_FAULT_CP_LOSS || cfg.fault == SIM_FAULT_STOP_REQUEST || cfg.fault == SIM_FAULT_CAN_SILENCE ||
+            cfg.fault == SIM_FAULT_ESTOP_BUTTON) {
+            stats.faultVisibleMs = now;
+        }
+        if (cfg.fault == SIM_FAULT_ESTOP_BUTTON) sim_hal_set_button(BUTTON_EMERGENCY, true);
+    }
+
+    // --- 電池模型 ---
+    float vbat = battery_voltage();
+    sim_psu_set_load(energized, vbat);
+    sim_hal_set_output_voltage(energized ? vbat : 0.0f);
+    if (energized) {
+        float current = sim_psu_get_output_current();
+        if (current > stats.maxObservedCurrent) stats.maxObservedCurrent = current;
+        stats.soc += current * (dt / 3600000.0f) / cfg.capacityAh * 100.0f * cfg.socAcceleration;
+        if (stats.soc > 100.0f) stats.soc = 100.0f;
+    }
+    if (permission && stats.soc >= cfg.stopSoc) {
+        permission = false;
+    }
+
+    // CP：VP 繼電器供電且車輛尚未放開時為 12V
+    bool cpOn = sim_hal_get_vp_relay() && !released && !fault_active(SIM_FAULT_CP_LOSS);
+    sim_hal_set_cp_voltage(cpOn ? 12.0f : 0.0f);
+
+    if (!fault_active(SIM_FAULT_CAN_SILENCE) && now - lastFrameTime >= cfg.framePeriodMs) {
+        lastFrameTime = now;
+        send_vehicle_frames();
+    }
+}
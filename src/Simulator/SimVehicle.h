@@ -0,0 +1,61 @@
+// src/Simulator/SimVehicle.h
+// TES-0D-02-01 車輛/BMS 模型：
+//   送出 0x500/0x501/0x5F0，讀取充電樁的 0x508/0x509/0x5F8，
+//   依握手流程控制許可位元 (0x01)、接觸器狀態 (0x02)、CP 電壓、SOC 與請求電流。
+
+#ifndef SIM_VEHICLE_H
+#define SIM_VEHICLE_H
+
+#include <stdint.h>
+
+enum SimVehicleFault {
+    SIM_FAULT_NONE,
+    SIM_FAULT_BMS_FLAGS,     // 0x500 faultFlags 置位
+    SIM_FAULT_EMERGENCY,     // 0x5F0 errorRequestFlags 置位
+    SIM_FAULT_CAN_SILENCE,   // 車輛停止發送所有 CAN 報文
+    SIM_FAULT_CP_LOSS,       // CP 訊號中斷
+    SIM_FAULT_STOP_REQUEST,  // 車輛提前撤銷充電許可 (正常停止)
+    SIM_FAULT_BUS_OFF,       // 充電樁的 CAN 控制器進入 bus-off，應自動恢復並繼續充電
+    SIM_FAULT_ESTOP_BUTTON   // 操作者按下充電樁的緊急停止按鈕 (按住 SIM_ESTOP_HOLD_MS)
+};
+
+struct SimVehicleConfig {
+    int startSoc;                       // %
+    int stopSoc;                        // 車輛在此 SOC 撤銷充電許可
+    float capacityAh;
+    float socAcceleration;              // SOC 上升速度倍率 (1.0 = 真實速度)
+    float emptyVoltage;                 // SOC 0% 時的電池電壓
+    float fullVoltage;                  // SOC 100% 時的電池電壓
+    uint16_t chargeVoltageLimit_0_1V;
+    uint16_t maxChargeVoltage_0_1V;
+    uint16_t maxCurrent_0_1A;           // 定電流階段請求值
+    uint16_t minCurrent_0_1A;           // 降流階段的最低請求值
+    int taperStartSoc;                  // 超過此 SOC 開始線性降流
+    uint16_t maxChargeTime_min;
+    uint32_t permissionDelayMs;         // 收到 0x508 後多久給出充電許可
+    uint32_t contactorDelayMs;          // 收到充電樁就緒 (0x04) 後多久閉合接觸器
+    uint32_t framePeriodMs;             // 0x500/0x501/0x5F0 發送週期
+    SimVehicleFault fault;
+    uint32_t faultAtMs;                 // 進入直流輸出後多久觸發故障
+};
+
+struct SimVehicleStats {
+    uint32_t framesSent;
+    uint32_t framesReceived;
+    uint32_t chargerStatusFrames;       // 0x508
+    uint32_t chargerParamsFrames;       // 0x509
+    uint32_t chargerEmergencyFrames;    // 0x5F8
+    uint32_t emergencyOrderErrors;      // 0x5F8 緊急停止先於帶故障旗標的 0x508，或之後又收到不帶故障旗標的 0x508
+    float soc;
+    float maxObservedCurrent;
+    bool faultInjected;
+    uint32_t faultVisibleMs;            // 故障對充電樁可見的時間 (帶故障旗標的第一幀送出、CP 中斷等)
+};
+
+SimVehicleConfig sim_vehicle_default_config();
+void sim_vehicle_init(const SimVehicleConfig& config);
+void sim_vehicle_plug_in();             // 開始新的一次充電 (SOC 回到 startSoc)
+void sim_vehicle_tick(uint32_t now_ms); // 作為 SimRunner 的 model tick
+const SimVehicleStats& sim_vehicle_get_stats();
+
+#endif // SIM_VEHICLE_H
@@ -0,0 +1,172 @@
+// src/Simulator/native/Arduino.h
+// 主機端 (Linux) 模擬用的 Arduino 核心替身，只提供韌體邏輯層實際用到的部分。
+// 時間來源為模擬器的虛擬時鐘，因此 millis()/delay() 可以比真實時間快很多倍。
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <functional>
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+#define SERIAL_8N1 0x800001c
+
+#define F(string_literal) (string_literal)
+
+using std::abs;
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// --- 虛擬時鐘 (實作於 Simulator/SimClock.cpp) ---
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// --- String (僅實作 PowerSupplyController 需要的子集) ---
+class String {
+public:
+    String() {}
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+
+    String& operator+=(char c) { s_ += c; return *this; }
+    String& operator+=(const char* s) { s_ += s; return *this; }
+    bool operator==(const char* s) const { return s_ == s; }
+
+    unsigned int length() const { return (unsigned int)s_.length(); }
+    const char* c_str() const { return s_.c_str(); }
+    bool startsWith(const char* prefix) const { return s_.compare(0, strlen(prefix), prefix) == 0; }
+    int indexOf(const char* needle) const {
+        size_t pos = s_.find(needle);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from >= s_.length() ? String() : String(s_.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= s_.length() || to <= from) return String();
+        return String(s_.substr(from, to - from));
+    }
+    void trim() {
+        size_t b = s_.find_first_not_of(" \t\r\n");
+        size_t e = s_.find_last_not_of(" \t\r\n");
+        s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+    }
+    float toFloat() const { return (float)atof(s_.c_str()); }
+    long toInt() const { return atol(s_.c_str()); }
+
+private:
+    std::string s_;
+};
+
+// --- Print: 與 Arduino 相同的 print/println/printf 介面 ---
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) {
+        if (base == DEC) return printf("%ld", n);
+        return print((unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", n); }
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(T v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len <= 0) return 0;
+        if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+        return write((const uint8_t*)buf, (size_t)len);
+    }
+};
+
+// --- 主控台 (USB CDC Serial) ---
+// 大量模擬時輸出會成為瓶頸，因此可以用 sim_console_set_enabled(false) 關閉。
+class SimConsole : public Print {
+public:
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void begin(unsigned long) {}
+};
+extern SimConsole Serial;
+void sim_console_set_enabled(bool enabled);
+
+// --- 模擬 UART 埠 ---
+// MCU 端透過 HardwareSerial 讀寫；模擬的周邊 (例如電源供應器) 透過 sim_uart_* 從另一端讀寫。
+void sim_uart_device_write(int uart_nr, const uint8_t* data, size_t len);
+int  sim_uart_device_read(int uart_nr);
+int  sim_uart_mcu_available(int uart_nr);
+int  sim_uart_mcu_read(int uart_nr);
+void sim_uart_mcu_write(int uart_nr, const uint8_t* data, size_t len);
+// onReceive 的回呼；實機由 UART 事件任務呼叫，模擬中在周邊寫入資料後立即呼叫
+void sim_uart_set_receive_callback(int uart_nr, std::function<void(void)> callback);
+// MCU 端改接外部的 PTY 或序列埠 (非阻塞 fd，-1 取消)；sim_uart_poll() 讀入已到達的資料並觸發回呼
+void sim_uart_attach_fd(int uart_nr, int fd);
+bool sim_uart_is_external(int uart_nr);
+void sim_uart_poll();
+
+class HardwareSerial : public Print {
+public:
+    explicit HardwareSerial(int uart_nr) : uart_nr_(uart_nr) {}
+    void begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) {}
+    void onReceive(std::function<void(void)> callback, bool = false) { sim_uart_set_receive_callback(uart_nr_, callback); }
+    bool setRxTimeout(uint8_t) { return true; }
+    int available() { return sim_uart_mcu_available(uart_nr_); }
+    int read() { return sim_uart_mcu_read(uart_nr_); }
+    size_t read(uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        int c;
+        while (n < size && (c = sim_uart_mcu_read(uart_nr_)) >= 0) buffer[n++] = (uint8_t)c;
+        return n;
+    }
+    size_t write(uint8_t c) override { sim_uart_mcu_write(uart_nr_, &c, 1); return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { sim_uart_mcu_write(uart_nr_, buffer, size); return size; }
+    using Print::write;
+    void flush() {}
+
+private:
+    int uart_nr_;
+};
+
+#endif // SIM_ARDUINO_H
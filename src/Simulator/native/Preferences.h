@@ -0,0 +1,84 @@
+// src/Simulator/native/Preferences.h
+// 以記憶體模擬 NVS 的 Preferences，命名空間與鍵值在整個模擬程序中保留。
+
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        ns_ = name;
+        readOnly_ = readOnly;
+        open_ = true;
+        return true;
+    }
+    void end() { open_ = false; }
+
+    bool isKey(const char* key) { return store()[ns_].count(key) > 0; }
+    bool remove(const char* key) { return !readOnly_ && store()[ns_].erase(key) > 0; }
+    bool clear() { if (readOnly_) return false; store()[ns_].clear(); return true; }
+
+    size_t putBool(const char* key, bool v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putInt(const char* key, int32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putUInt(const char* key, uint32_t v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putFloat(const char* key, float v) { return putRaw(key, &v, sizeof(v)); }
+    size_t putString(const char* key, const String& v) { return putRaw(key, v.c_str(), v.length() + 1); }
+    size_t putBytes(const char* key, const void* v, size_t len) { return putRaw(key, v, len); }
+
+    bool getBool(const char* key, bool def = false) { return getRaw(key, def); }
+    int32_t getInt(const char* key, int32_t def = 0) { return getRaw(key, def); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return getRaw(key, def); }
+    float getFloat(const char* key, float def = NAN) { return getRaw(key, def); }
+    String getString(const char* key, const String& def = String()) {
+        auto& ns = store()[ns_];
+        auto it = ns.find(key);
+        return it == ns.end() ? def : String((const char*)it->second.data());
+    }
+    size_t getBytesLength(const char* key) {
+        auto& ns = store()[ns_];
+        auto it = ns.find(key);
+        return it == ns.end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        auto& ns = store()[ns_];
+        auto it = ns.find(key);
+        if (it == ns.end() || it->second.size() > maxLen) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    // 模擬用：統計寫入次數以評估快閃記憶體磨耗
+    static uint32_t sim_write_count() { return writes(); }
+
+private:
+    typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> Store;
+    static Store& store() { static Store s; return s; }
+    static uint32_t& writes() { static uint32_t w = 0; return w; }
+
+    size_t putRaw(const char* key, const void* v, size_t len) {
+        if (!open_ || readOnly_) return 0;
+        const uint8_t* p = (const uint8_t*)v;
+        store()[ns_][key].assign(p, p + len);
+        writes()++;
+        return len;
+    }
+    template <typename T> T getRaw(const char* key, T def) {
+        auto& ns = store()[ns_];
+        auto it = ns.find(key);
+        if (it == ns.end() || it->second.size() != sizeof(T)) return def;
+        T v;
+        memcpy(&v, it->second.data(), sizeof(T));
+        return v;
+    }
+
+    std::string ns_;
+    bool readOnly_ = false;
+    bool open_ = false;
+};
+
+#endif // SIM_PREFERENCES_H
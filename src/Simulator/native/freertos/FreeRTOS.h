@@ -0,0 +1,30 @@
+// src/Simulator/native/freertos/FreeRTOS.h
+// 模擬器以單執行緒依序排程各任務，FreeRTOS 只需提供型別與時間換算。
+
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+#include <Arduino.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+struct SimTask;
+typedef SimTask* TaskHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// 臨界區 (ESP32 的 portMUX 自旋鎖)，單執行緒下不需要任何動作
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+
+#endif // SIM_FREERTOS_H
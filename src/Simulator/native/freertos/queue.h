@@ -0,0 +1,44 @@
+// src/Simulator/native/freertos/queue.h
+
+#ifndef SIM_QUEUE_H
+#define SIM_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+#include <deque>
+#include <vector>
+
+// 單執行緒模擬中佇列永遠不會阻塞：空或滿時立即返回失敗，由 SimRunner 負責在適當時機取出
+struct SimQueue {
+    size_t itemSize;
+    size_t capacity;
+    std::deque<std::vector<uint8_t>> items;
+};
+typedef SimQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new SimQueue{itemSize, length, {}};
+}
+
+inline BaseType_t sim_queue_push(QueueHandle_t q, const void* item, bool front) {
+    if (q->items.size() >= q->capacity) return pdFAIL;
+    const uint8_t* p = (const uint8_t*)item;
+    if (front) q->items.emplace_front(p, p + q->itemSize);
+    else q->items.emplace_back(p, p + q->itemSize);
+    return pdPASS;
+}
+
+inline BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t) { return sim_queue_push(q, item, false); }
+inline BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t) { return sim_queue_push(q, item, true); }
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t t) { return xQueueSendToBack(q, item, t); }
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t) {
+    if (q->items.empty()) return pdFALSE;
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) { return (UBaseType_t)q->items.size(); }
+inline BaseType_t xQueueReset(QueueHandle_t q) { q->items.clear(); return pdPASS; }
+
+#endif // SIM_QUEUE_H
@@ -0,0 +1,16 @@
+// src/Simulator/native/freertos/semphr.h
+
+#ifndef SIM_SEMPHR_H
+#define SIM_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+// 單執行緒模擬中互斥鎖永遠可以立即取得
+struct SimSemaphore { int count; };
+typedef SimSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new SimSemaphore{1}; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif // SIM_SEMPHR_H
@@ -0,0 +1,21 @@
+// src/Simulator/native/freertos/task.h
+
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// 任務通知以計數表示，由 SimRunner 在任務等待點取出
+struct SimTask {
+    uint32_t notifications;
+};
+
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    task->notifications++;
+    return pdPASS;
+}
+
+#endif // SIM_TASK_H
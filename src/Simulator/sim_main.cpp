@@ -0,0 +1,415 @@
+// src/Simulator/sim_main.cpp
+// 主機端模擬器進入點 (pio run -e native)。
+// 以虛擬時鐘驅動 ChargerLogic 與車輛模型，連續執行多次完整充電流程，
+// 統計每秒可完成的充電次數、握手延遲與控制迴圈延遲。
+// 也可以透過 SocketCAN 連到 vcan0 或實體 USB-CAN 轉接器 (--can / --bench-decode)。
+
+#include <Arduino.h>
+#include "Charger_Defs.h"
+#include "SimHAL.h"
+#include "SimRunner.h"
+#include "SimSession.h"
+#include "SimVehicle.h"
+#include "SimClock.h"
+#include "SimSocketCAN.h"
+#include "SimCodecBench.h"
+#include "SimAdcBench.h"
+#include "SimFilterBench.h"
+#include "SimConfigBench.h"
+#include "SimPscBench.h"
+#include "SimPscLink.h"
+#include "SimCurrentLoopBench.h"
+#include "SimReplay.h"
+#include "CAN_Protocol/CAN_Protocol.h"
+#include "CAN_Protocol/CAN_TxScheduler.h"
+#include "CAN_Protocol/CAN_BusHealth.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "ChargerLogic/ChargerLogic.h"
+#include <chrono>
+#include <signal.h>
+#include <vector>
+
+// --- 對應 main.cpp 中的全域資源 ---
+DisplayData globalDisplayData;
+
+static volatile sig_atomic_t stop_requested = 0;
+static void on_sigint(int) { stop_requested = 1; }
+static bool should_stop() { return stop_requested != 0; }
+
+static void print_usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --sessions <n>        number of charge sessions (default 1)\n"
+        "  --start-soc <pct>     vehicle SOC at plug-in (default 20)\n"
+        "  --stop-soc <pct>      vehicle withdraws permission at this SOC (default 100)\n"
+        "  --soc-accel <x>       SOC ramp speed multiplier (default 200)\n"
+        "  --current <A>         BMS constant-current request (default 10.0)\n"
+        "  --fault <type>        none|bms|emergency|silence|cp-loss|stop|bus-off|estop\n"
+        "  --fault-at <ms>       delay after DC output starts (default 5000)\n"
+        "  --timeout <ms>        per-session virtual time limit (default 3600000)\n"
+        "  --trace               print every state transition\n"
+        "  --verbose             keep firmware Serial output\n"
+        "  --can-log <file>      write the CAN trace (fault window if captured) as candump -l, or ASC for *.asc\n"
+        "  --bench-codec <n>     compare generated vs hand-written CAN codec over n rounds\n"
+        "  --bench-adc           latency/noise of ADS1115 SPS and oversampling profiles per channel\n"
+        "  --bench-filter <n>    check the fixed-point measurement filters and time them over n samples\n"
+        "  --bench-config        check that settings changes are coalesced into few NVS writes\n"
+        "  --bench-psc <n>       check the PSC telemetry parser and compare it with the String parser over n lines\n"
+        "  --fuzz-psc <n>        feed n random inputs to the PSC parser and compare with a reference parser\n"
+        "  --fuzz-seed <n>       random seed for --fuzz-psc (default 1)\n"
+        "  --bench-psc-link      check PSU binary framing (negotiation, ACK/retransmit, fallback) over a PTY\n"
+        "  --bench-current-loop  compare open- and closed-loop current regulation against an overshooting PSU\n"
+        "Log replay (candump -l files, original frame timing):\n"
+        "  --replay <file>       replay vehicle frames from <file>; repeat for a corpus\n"
+        "  --replay-out <file>   write state transitions, TX frames and relay events ('-' = stdout)\n"
+        "  --realtime            pace the replay in wall-clock time instead of as fast as possible\n"
+        "SocketCAN modes (real time, Ctrl-C to stop):\n"
+        "  --can <ifname>        run the charger logic on a real/virtual CAN bus\n"
+        "  --start-at <ms>       press START after this delay (--replay: log time, default just before the first 0x508)\n"
+        "  --bench-decode <if>   decode frames from <if> as fast as possible\n"
+        "  --duration <ms>       SocketCAN mode run time (default: until Ctrl-C)\n"
+        "  --psu-tty <path>      connect the firmware's PSU UART to a serial port or PTY instead of the built-in PSU model\n"
+        "PSU simulator (real time, Ctrl-C to stop):\n"
+        "  --psu-pty <proto>     run the PSU model on a new PTY and print its path; proto: binary|text (text-only PSU)\n"
+        "  --psu-corrupt <n>     corrupt n of every 1000 binary frames sent by --psu-pty\n",
+        prog);
+}
+
+static bool parse_fault(const char* s, SimVehicleFault& fault) {
+    if (!strcmp(s, "none")) fault = SIM_FAULT_NONE;
+    else if (!strcmp(s, "bms")) fault = SIM_FAULT_BMS_FLAGS;
+    else if (!strcmp(s, "emergency")) fault = SIM_FAULT_EMERGENCY;
+    else if (!strcmp(s, "silence")) fault = SIM_FAULT_CAN_SILENCE;
+    else if (!strcmp(s, "cp-loss")) fault = SIM_FAULT_CP_LOSS;
+    else if (!strcmp(s, "stop")) fault = SIM_FAULT_STOP_REQUEST;
+    else if (!strcmp(s, "bus-off")) fault = SIM_FAULT_BUS_OFF;
+    else if (!strcmp(s, "estop")) fault = SIM_FAULT_ESTOP_BUTTON;
+    else return false;
+    return true;
+}
+
+// 與網頁下載相同的輸出，方便用 canplayer / python-can 檢查
+static bool write_can_log(const char* path) {
+    size_t path_len = strlen(path);
+    CanTraceFormat format = (path_len > 4 && !strcmp(path + path_len - 4, ".asc")) ? CAN_TRACE_FORMAT_ASC
+                                                                                  : CAN_TRACE_FORMAT_CANDUMP;
+    CanTraceSource source = can_trace_get_status().faultCaptured ? CAN_TRACE_SOURCE_FAULT : CAN_TRACE_SOURCE_LIVE;
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    CAN_Trace_Cursor cursor;
+    can_trace_open(cursor, source, format);
+    char buf[1460];
+    size_t n;
+    while ((n = can_trace_read(cursor, buf, sizeof(buf))) > 0) fwrite(buf, 1, n, f);
+    fclose(f);
+    fprintf(stderr, "CAN log          : %s (%s)\n", path, source == CAN_TRACE_SOURCE_FAULT ? "fault window" : "live buffer");
+    return true;
+}
+
+// 回放一組記錄檔；每個檔案都從重新初始化的韌體開始，結果才不受前一個檔案影響
+static int run_replay(const std::vector<const char*>& paths, const char* out_path, bool realtime, int32_t start_at_ms) {
+    FILE* out = nullptr;
+    if (out_path) {
+        out = !strcmp(out_path, "-") ? stdout : fopen(out_path, "w");
+        if (!out) {
+            perror(out_path);
+            return 1;
+        }
+    }
+    sim_clock_set_realtime(realtime);
+
+    uint64_t total_frames = 0;
+    uint64_t total_log_ms = 0;
+    double total_wall_ms = 0;
+    int failed = 0;
+    for (const char* path : paths) {
+        SimReplayLog log;
+        if (!sim_replay_load(path, log)) {
+            failed++;
+            continue;
+        }
+        sim_runner_init(84.0);
+        if (out) fprintf(out, "# replay %s: %zu frames\n", path, log.frames.size());
+        SimReplayOptions options = {start_at_ms, 5000, out};
+        SimReplayResult r = sim_replay_run(log, options);
+        fprintf(stderr, "%s: %u vehicle + %u charger frames (%u lines skipped), %.1f s log, %u transitions, "
+                        "%u TX, %u relay events, final %s, wall %.2f ms\n",
+                path, r.vehicleFrames, r.chargerFrames, log.skippedLines, r.logDurationMs / 1000.0, r.transitions,
+                r.txFrames, r.relayEvents, sim_state_name(r.finalState), r.wallMs);
+        total_frames += r.vehicleFrames;
+        total_log_ms += r.logDurationMs;
+        total_wall_ms += r.wallMs;
+    }
+    if (out && out != stdout) fclose(out);
+
+    fprintf(stderr, "\n--- Replay Summary ---\n");
+    fprintf(stderr, "Logs             : %zu (%d failed to load)\n", paths.size(), failed);
+    fprintf(stderr, "Vehicle frames   : %llu over %.1f s of log time\n", (unsigned long long)total_frames, total_log_ms / 1000.0);
+    if (total_wall_ms > 0) {
+        fprintf(stderr, "Throughput       : %.0f frames/s decode+logic (x%.0f real time)\n",
+                total_frames * 1000.0 / total_wall_ms, total_log_ms / total_wall_ms);
+    }
+    return failed ? 1 : 0;
+}
+
+static void print_socketcan_stats() {
+    const SimSocketCanStats& st = sim_socketcan_get_stats();
+    fprintf(stderr, "SocketCAN        : RX %llu, TX %llu, TX errors %llu, kernel RX drops %llu\n",
+            (unsigned long long)st.rxFrames, (unsigned long long)st.txFrames,
+            (unsigned long long)st.txErrors, (unsigned long long)st.rxKernelDrops);
+}
+
+// 即時模式：以真實時間執行邏輯，車輛端由外部匯流排提供
+static int run_live(const char* ifname, uint32_t start_at_ms, uint32_t duration_ms) {
+    sim_clock_set_realtime(true);
+    if (!sim_hal_use_socketcan(ifname)) return 1;
+    sim_session_set_trace(true);
+    sim_runner_init(84.0);
+    sim_hal_set_cp_voltage(12.0);
+
+    uint32_t start = sim_runner_now_ms();
+    bool pressed = false;
+    while (!should_stop() && (duration_ms == 0 || sim_runner_now_ms() - start < duration_ms)) {
+        if (start_at_ms && !pressed && sim_runner_now_ms() - start >= start_at_ms) {
+            logic_start_button_pressed();
+            pressed = true;
+        }
+        sim_runner_run_for(100);
+    }
+    fprintf(stderr, "\nFinal state      : %s\n", sim_state_name(logic_get_charger_state()));
+    print_socketcan_stats();
+    return 0;
+}
+
+// 解碼吞吐量：連續呼叫 can_protocol_handle_receive()，統計每秒解碼數與單幀解碼成本
+static int run_bench_decode(const char* ifname, uint32_t duration_ms) {
+    sim_clock_set_realtime(true);
+    if (!sim_hal_use_socketcan(ifname)) return 1;
+
+    uint64_t busy_ns = 0;
+    uint32_t rx_before = sim_hal_can_rx_count();
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    uint32_t rx_last = rx_before;
+
+    fprintf(stderr, "Decoding from %s (e.g. run: cangen %s -g 0 -I 500 -L 8, or without -I for mixed traffic)\n", ifname, ifname);
+    while (!should_stop()) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint32_t before = sim_hal_can_rx_count();
+        can_protocol_handle_receive();
+        auto t1 = std::chrono::steady_clock::now();
+        if (sim_hal_can_rx_count() != before) {
+            busy_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+        double elapsed_ms = std::chrono::duration<double, std::milli>(t1 - start).count();
+        if (duration_ms && elapsed_ms >= duration_ms) break;
+        if (std::chrono::duration<double>(t1 - last_report).count() >= 1.0) {
+            uint32_t rx = sim_hal_can_rx_count();
+            fprintf(stderr, "%8.1f s: %u frames/s, kernel drops %llu\n", elapsed_ms / 1000.0, rx - rx_last,
+                    (unsigned long long)sim_socketcan_get_stats().rxKernelDrops);
+            rx_last = rx;
+            last_report = t1;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint32_t frames = sim_hal_can_rx_count() - rx_before;
+    CAN_Rx_Counters rx = can_protocol_get_rx_counters();
+    fprintf(stderr, "\n--- Decode Benchmark ---\n");
+    fprintf(stderr, "Frames accepted  : %u in %.2f s (%.0f frames/s)\n", frames, seconds, frames / seconds);
+    fprintf(stderr, "Frame filtering  : %u rejected by HW filter%s, %u decoded, %u discarded in SW\n",
+            sim_hal_can_filtered_count(), hal_can_filter_accepts_all() ? " (ACCEPT ALL)" : "",
+            rx.decoded, rx.discarded);
+    if (frames > 0) {
+        fprintf(stderr, "Decode cost      : %.0f ns/frame (receive + decode)\n", (double)busy_ns / frames);
+    }
+    print_socketcan_stats();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    SimVehicleConfig vehicle = sim_vehicle_default_config();
+    uint32_t sessions = 1;
+    uint32_t timeout_ms = 3600000;
+    bool verbose = false;
+    bool trace = false;
+    const char* can_ifname = nullptr;
+    const char* bench_ifname = nullptr;
+    uint32_t start_at_ms = 0;
+    uint32_t duration_ms = 0;
+    uint32_t codec_rounds = 0;
+    uint32_t filter_samples = 0;
+    uint32_t psc_lines = 0;
+    uint32_t psc_fuzz = 0;
+    uint32_t fuzz_seed = 1;
+    const char* can_log_path = nullptr;
+    std::vector<const char*> replay_paths;
+    const char* replay_out = nullptr;
+    bool realtime = false;
+    bool start_at_set = false;
+    bool adc_bench = false;
+    bool config_bench = false;
+    bool psc_link_bench = false;
+    bool current_loop_bench = false;
+    const char* psu_pty = nullptr;
+    const char* psu_tty = nullptr;
+    uint32_t psu_corrupt = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(arg, "--trace")) { trace = true; continue; }
+        if (!strcmp(arg, "--verbose")) { verbose = true; continue; }
+        if (!strcmp(arg, "--realtime")) { realtime = true; continue; }
+        if (!strcmp(arg, "--bench-adc")) { adc_bench = true; continue; }
+        if (!strcmp(arg, "--bench-config")) { config_bench = true; continue; }
+        if (!strcmp(arg, "--bench-psc-link")) { psc_link_bench = true; continue; }
+        if (!strcmp(arg, "--bench-current-loop")) { current_loop_bench = true; continue; }
+        if (!val) { print_usage(argv[0]); return 2; }
+        i++;
+        if (!strcmp(arg, "--sessions")) sessions = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--start-soc")) vehicle.startSoc = atoi(val);
+        else if (!strcmp(arg, "--stop-soc")) vehicle.stopSoc = atoi(val);
+        else if (!strcmp(arg, "--soc-accel")) vehicle.socAcceleration = (float)atof(val);
+        else if (!strcmp(arg, "--current")) vehicle.maxCurrent_0_1A = (uint16_t)(atof(val) * 10);
+        else if (!strcmp(arg, "--fault-at")) vehicle.faultAtMs = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--timeout")) timeout_ms = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--can")) can_ifname = val;
+        else if (!strcmp(arg, "--bench-decode")) bench_ifname = val;
+        else if (!strcmp(arg, "--start-at")) { start_at_ms = (uint32_t)atol(val); start_at_set = true; }
+        else if (!strcmp(arg, "--duration")) duration_ms = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--bench-codec")) codec_rounds = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--bench-filter")) filter_samples = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--bench-psc")) psc_lines = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--fuzz-psc")) psc_fuzz = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--fuzz-seed")) fuzz_seed = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--psu-pty")) psu_pty = val;
+        else if (!strcmp(arg, "--psu-corrupt")) psu_corrupt = (uint32_t)atol(val);
+        else if (!strcmp(arg, "--psu-tty")) psu_tty = val;
+        else if (!strcmp(arg, "--can-log")) can_log_path = val;
+        else if (!strcmp(arg, "--replay")) replay_paths.push_back(val);
+        else if (!strcmp(arg, "--replay-out")) replay_out = val;
+        else if (!strcmp(arg, "--fault")) {
+            if (!parse_fault(val, vehicle.fault)) { print_usage(argv[0]); return 2; }
+        } else { print_usage(argv[0]); return 2; }
+    }
+
+    sim_console_set_enabled(verbose);
+    sim_session_set_trace(trace);
+    memset(&globalDisplayData, 0, sizeof(DisplayData));
+    signal(SIGINT, on_sigint);
+
+    if (codec_rounds) return sim_codec_bench(codec_rounds);
+    if (adc_bench) return sim_adc_bench();
+    if (filter_samples) return sim_filter_bench(filter_samples);
+    if (config_bench) return sim_config_bench();
+    if (psc_lines) return sim_psc_bench(psc_lines);
+    if (psc_fuzz) return sim_psc_fuzz(psc_fuzz, fuzz_seed);
+    if (psc_link_bench) return sim_psc_link_bench();
+    if (current_loop_bench) return sim_current_loop_bench();
+    if (psu_pty) {
+        if (strcmp(psu_pty, "binary") && strcmp(psu_pty, "text")) { print_usage(argv[0]); return 2; }
+        return sim_psu_pty_run(!strcmp(psu_pty, "binary"), psu_corrupt, duration_ms, should_stop);
+    }
+    if (psu_tty) {
+        int fd = sim_tty_open(psu_tty);
+        if (fd < 0) return 1;
+        sim_uart_attach_fd(0, fd);
+    }
+    if (!replay_paths.empty()) return run_replay(replay_paths, replay_out, realtime, start_at_set ? (int32_t)start_at_ms : -1);
+    if (bench_ifname) return run_bench_decode(bench_ifname, duration_ms);
+    if (can_ifname) return run_live(can_ifname, start_at_ms, duration_ms);
+
+    sim_runner_init(84.0);
+    sim_vehicle_init(vehicle);
+    sim_runner_set_model_tick(sim_vehicle_tick);
+    sim_runner_reset_stats();
+
+    uint32_t outcome_count[SIM_SESSION_TIMEOUT + 1] = {0};
+    uint64_t handshake_total = 0;
+    uint32_t handshake_max = 0;
+    uint32_t handshake_count = 0;
+    uint64_t fault_latency_total = 0;
+    uint32_t fault_latency_max = 0;
+    uint32_t fault_latency_count = 0;
+    uint32_t virtual_start = sim_runner_now_ms();
+    auto wall_start = std::chrono::steady_clock::now();
+
+    for (uint32_t n = 0; n < sessions; n++) {
+        SimSessionResult r = sim_session_run(timeout_ms);
+        outcome_count[r.outcome]++;
+        if (r.handshakeMs > 0) {
+            handshake_total += r.handshakeMs;
+            handshake_count++;
+            if (r.handshakeMs > handshake_max) handshake_max = r.handshakeMs;
+        }
+        if (sim_vehicle_get_stats().faultVisibleMs > 0) {
+            fault_latency_total += r.faultToRelayOpenMs;
+            fault_latency_count++;
+            if (r.faultToRelayOpenMs > fault_latency_max) fault_latency_max = r.faultToRelayOpenMs;
+        }
+        if (trace || sessions <= 10) {
+            fprintf(stderr, "session %u: %s, handshake %u ms, duration %u ms, SOC %.1f%%, wall %.2f ms\n",
+                    n + 1, sim_session_outcome_name(r.outcome), r.handshakeMs, r.durationMs, r.finalSoc, r.wallMs);
+        }
+    }
+
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    uint32_t virtual_ms = sim_runner_now_ms() - virtual_start;
+    const SimLoopStats& loop = sim_runner_get_logic_stats();
+    const SimVehicleStats& vs = sim_vehicle_get_stats();
+
+    fprintf(stderr, "\n--- Simulation Summary ---\n");
+    fprintf(stderr, "Sessions         : %u (", sessions);
+    for (int o = SIM_SESSION_COMPLETE; o <= SIM_SESSION_TIMEOUT; o++) {
+        fprintf(stderr, "%s%s=%u", o ? ", " : "", sim_session_outcome_name((SimSessionOutcome)o), outcome_count[o]);
+    }
+    fprintf(stderr, ")\n");
+    fprintf(stderr, "Virtual time     : %.1f s\n", virtual_ms / 1000.0);
+    fprintf(stderr, "Wall time        : %.2f ms (x%.0f real time)\n", wall_ms, virtual_ms / wall_ms);
+    fprintf(stderr, "Throughput       : %.1f sessions/s (%.0f sessions/min)\n",
+            sessions * 1000.0 / wall_ms, sessions * 60000.0 / wall_ms);
+    if (handshake_count > 0) {
+        fprintf(stderr, "Handshake        : avg %.1f ms, max %u ms (START -> DC_CURRENT_OUTPUT)\n",
+                (double)handshake_total / handshake_count, handshake_max);
+    }
+    if (fault_latency_count > 0) {
+        fprintf(stderr, "Fault -> relay   : avg %.1f ms, max %u ms over %u faulted sessions\n",
+                (double)fault_latency_total / fault_latency_count, fault_latency_max, fault_latency_count);
+    }
+    if (loop.iterations > 0) {
+        fprintf(stderr, "Logic loop (wall): avg %.2f us, max %.2f us over %u iterations\n",
+                loop.total_wall_ns / 1000.0 / loop.iterations, loop.max_wall_ns / 1000.0, loop.iterations);
+    }
+    fprintf(stderr, "Logic loop (virt): max %u ms blocked in delay()\n", loop.max_virtual_ms);
+    fprintf(stderr, "CAN frames       : vehicle TX %u, charger TX %u (508=%u 509=%u 5F8=%u)\n",
+            vs.framesSent, vs.framesReceived, vs.chargerStatusFrames, vs.chargerParamsFrames, vs.chargerEmergencyFrames);
+    if (vs.emergencyOrderErrors) {
+        fprintf(stderr, "FAIL: %u emergency stop frame(s) out of order (0x5F8 before 0x508, or a stale 0x508 after)\n",
+                vs.emergencyOrderErrors);
+    }
+    CAN_Vehicle_Snapshot vehicle_rx;
+    can_protocol_get_vehicle_snapshot(vehicle_rx);
+    static const char* const rx_names[VEHICLE_MSG_COUNT] = {"0x500", "0x501", "0x5F0"};
+    for (int i = 0; i < VEHICLE_MSG_COUNT; i++) {
+        const CAN_Rx_Timing& t = vehicle_rx.timing[i];
+        fprintf(stderr, "RX %s timing   : %u frames, mean %.1f ms, jitter %.2f ms, max %.1f ms, gaps %u\n",
+                rx_names[i], t.count, t.meanIntervalUs / 1000.0, t.jitterUs / 1000.0, t.maxIntervalUs / 1000.0, t.gaps);
+    }
+    CAN_Tx_Stats tx = can_tx_get_stats();
+    fprintf(stderr, "CAN TX scheduler : sent %u, failed %u, queue full %u, periods skipped %u, stale dropped %u, max jitter %u us\n",
+            tx.sent, tx.failed, tx.queueFull, tx.periodsSkipped, tx.periodicDropped, tx.maxPeriodJitterUs);
+    CAN_Bus_Health bus = can_bus_health_get();
+    fprintf(stderr, "CAN bus health   : bus-off %u, recovered %u, TX failed %u, RX missed %u, bus errors %u\n",
+            bus.busOffCount, bus.recoveries, bus.txFailed, bus.rxMissed, bus.busErrors);
+    can_trace_service();
+    CAN_Trace_Status trace_status = can_trace_get_status();
+    fprintf(stderr, "CAN trace        : %u frames recorded, %u triggers, fault window %u frames\n",
+            trace_status.recorded, trace_status.triggers, trace_status.faultFrames);
+    if (can_log_path && !write_can_log(can_log_path)) return 1;
+
+    return (outcome_count[SIM_SESSION_TIMEOUT] || outcome_count[SIM_SESSION_NOT_STARTED] || vs.emergencyOrderErrors) ? 1 : 0;
+}
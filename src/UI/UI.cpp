@@ -4,12 +4,18 @@
 #include "Config.h"
 #include "Version.h"
 #include "HAL/HAL.h"
+#include "HAL/I2C_Bus.h"
 #include <U8g2lib.h>
 #include <Wire.h>
 #include "OTAManager/OTAManager.h"
+#include "ConfigStore/ConfigStore.h"
 
 // --- 私有(static)變量 ---
-static U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
+// 指定腳位，u8g2 初始化時的 Wire.begin() 才不會把總線改回預設腳位
+static U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE, /* clock=*/ I2C_SCL_PIN, /* data=*/ I2C_SDA_PIN);
+// 每塊除了 tile 資料還有位址、控制位元組與設定頁/欄的命令
+static const uint32_t OLED_CHUNK_OVERHEAD_BYTES = 8;
+static const uint32_t OLED_INIT_BYTES = 32;
 static UIState currentUIState = UI_STATE_NORMAL;
 static bool isOledConnected = false;
 static unsigned long lastDisplayUpdateTime = 0;
@@ -17,51 +23,108 @@ static unsigned long savedScreenStartTime = 0;
 static int mainMenuSelection = 0;
 static int mainMenuOffset = 0;
 const int MAX_MENU_ITEMS_ON_SCREEN = 4;
-static const char* mainMenuItems[] = {"Max Voltage", "Max Current", "Target SOC", "Save & Exit", "Network", "About"};
+static const char* mainMenuItems[] = {"Max Voltage", "Max Current", "Target SOC", "Save & Exit", "Network", "Calibration", "About"};
 static int aboutMenuSelection = 0; 
 static int updateMenuSelection = 0; 
 static const char* updateMenuItemText = "Check for Updates";
 static unsigned int tempSetting_Voltage;
 static unsigned int tempSetting_Current;
 static int tempSetting_SOC;
-static unsigned long settingButtonPressedTime = 0;
 static bool isSettingButtonLongPress = false;
-static unsigned long keyRepeatStartTime = 0;
+static ButtonType repeatButton = BUTTON_START;
+static bool isRepeatButtonHeld = false;
 static unsigned long nextRepeatTime = 0;
 const unsigned long KEY_REPEAT_INITIAL_DELAY_MS = 400;
 const unsigned long KEY_REPEAT_INTERVAL_MS = 80;
 static bool force_display_update = false;
 
+// 兩點分壓校準：選通道 -> 輸入電錶讀值並擷取第 1 點 -> 第 2 點 (擷取後立即計算並儲存) -> 結果
+enum CalStep { CAL_STEP_CHANNEL, CAL_STEP_POINT1, CAL_STEP_POINT2, CAL_STEP_RESULT };
+static CalStep calStep = CAL_STEP_CHANNEL;
+static AdcChannel calChannel = ADC_CH_VOLTAGE;
+static int32_t calReference_mV = 0;
+static bool calResultOk = false;
+
 
 // --- 引用外部函數以獲取初始設定值和保存設定 ---
 // 這是 UI 層唯一需要與 Logic 層直接交互的地方
-extern unsigned int logic_get_max_voltage_setting();
-extern unsigned int logic_get_max_current_setting();
-extern int logic_get_target_soc_setting();
-extern void logic_save_config(unsigned int voltage, unsigned int current, int soc);
 
 extern bool filesystem_version_mismatch;
 extern void net_reset_wifi_credentials();
 
+static float cal_reading() {
+    return calChannel == ADC_CH_VOLTAGE ? hal_read_power_supply_voltage() : hal_read_cp_voltage();
+}
+
+// 短按一次的調整量；長按重複時為 10 倍
+static int32_t cal_step_mV() {
+    return calChannel == ADC_CH_VOLTAGE ? 100 : 10;
+}
+
+// 總線已由 hal_init_adc() 啟動，這裡只探測位址
 static byte findOledDevice() {
     byte common_addresses[] = {0x3C, 0x3D};
-    Wire.begin();
     for (byte i = 0; i < sizeof(common_addresses); i++) {
         byte addr = common_addresses[i];
+        if (!i2c_bus_acquire(I2C_CLIENT_DISPLAY, i2c_bus_transfer_us(1))) continue;
         Wire.beginTransmission(addr);
-        if (Wire.endTransmission() == 0) return addr;
+        bool found = Wire.endTransmission() == 0;
+        i2c_bus_release(I2C_CLIENT_DISPLAY);
+        if (found) return addr;
     }
     return 0;
 }
 
+// 整個畫面約 1 KB，400 kHz 下要 25 ms 以上；分成小塊傳送，每次重新取得總線，ADC 讀取可以插在中間。
+// 每次傳送量填滿到 ADC 下一筆轉換的空檔 (跨列時每列各一塊)：固定每次 2 個 tile 時兩個通道都是 860 SPS
+// 一幀要 64 個空檔 (約 75 ms)，超過 UI 更新週期。ADC 沒有排定時每次最多一列，不長時間佔住總線
+static void ui_send_buffer() {
+    const uint8_t tiles_w = u8g2.getBufferTileWidth();
+    const uint8_t tiles_h = u8g2.getBufferTileHeight();
+    const uint32_t overhead_us = i2c_bus_transfer_us(OLED_CHUNK_OVERHEAD_BYTES);
+    const uint32_t tile_us = i2c_bus_transfer_us(8) - i2c_bus_transfer_us(0);
+    const uint32_t row_us = overhead_us + tiles_w * tile_us;
+    uint32_t start_us = micros();
+    uint8_t tx = 0;
+    uint8_t ty = 0;
+    while (ty < tiles_h) {
+        uint32_t window_us;
+        if (!i2c_bus_acquire_window(I2C_CLIENT_DISPLAY, overhead_us + tile_us, &window_us)) return;  // 總線卡住時放棄這一幀
+        if (window_us > row_us) window_us = row_us;
+        while (ty < tiles_h && window_us >= overhead_us + tile_us) {
+            uint32_t fit = (window_us - overhead_us) / tile_us;
+            uint8_t tw = fit < (uint32_t)(tiles_w - tx) ? (uint8_t)fit : tiles_w - tx;
+            u8g2.updateDisplayArea(tx, ty, tw, 1);
+            window_us -= overhead_us + tw * tile_us;
+            tx += tw;
+            if (tx == tiles_w) {
+                tx = 0;
+                ty++;
+            }
+        }
+        i2c_bus_release(I2C_CLIENT_DISPLAY);
+    }
+    i2c_bus_record_display_frame(micros() - start_us);
+}
+
 void ui_init() {
     byte oledAddress = findOledDevice();
     if (oledAddress > 0) {
         u8g2.setI2CAddress(oledAddress * 2);
-        if (u8g2.begin()) {
+        u8g2.setBusClock(I2C_BUS_FREQUENCY_HZ);
+        // 不用 u8g2.begin()：它會一次送出 1 KB 的清除畫面，改為初始化命令與分塊清除
+        if (i2c_bus_acquire(I2C_CLIENT_DISPLAY, i2c_bus_transfer_us(OLED_INIT_BYTES))) {
+            u8g2.initDisplay();
+            u8g2.setFlipMode(1);
+            i2c_bus_release(I2C_CLIENT_DISPLAY);
+            u8g2.clearBuffer();
+            ui_send_buffer();
+            if (i2c_bus_acquire(I2C_CLIENT_DISPLAY, i2c_bus_transfer_us(OLED_CHUNK_OVERHEAD_BYTES))) {
+                u8g2.setPowerSave(0);
+                i2c_bus_release(I2C_CLIENT_DISPLAY);
+            }
             isOledConnected = true;
             Serial.println(F("UI: OLED display initialized successfully."));
-            u8g2.setFlipMode(1);
 
             ui_show_boot_screen("TES Charger", "Booting...");
             delay(1000);
@@ -93,7 +156,7 @@ void ui_show_boot_screen(const char* line1, const char* line2) {
     strWidth = u8g2.getStrWidth(FIRMWARE_VERSION);
     u8g2.drawStr(128 - strWidth - 2, 62, FIRMWARE_VERSION);
     
-    u8g2.sendBuffer();
+    ui_send_buffer();
 }
 
 UIState ui_get_current_state() {
@@ -101,12 +164,11 @@ UIState ui_get_current_state() {
 }
 
 void ui_handle_input(const DisplayData& data) {
-    if (!isOledConnected) return;
+    if (!isOledConnected) {
+        hal_button_flush(BUTTON_CONSUMER_UI);
+        return;
+    }
 
-    bool settingIsPressed = hal_get_button_state(BUTTON_SETTING);
-    bool upIsPressed = hal_get_button_state(BUTTON_START);
-    bool downIsPressed = hal_get_button_state(BUTTON_STOP);
-    
     bool upShortPressTrigger = false;
     bool downShortPressTrigger = false;
     bool upRepeatTrigger = false;
@@ -116,45 +178,42 @@ void ui_handle_input(const DisplayData& data) {
 
     unsigned long now = millis();
 
-    // 處理 上/下 按鈕的短按與重複
-    if (upIsPressed) {
-        if (keyRepeatStartTime == 0) {
-            keyRepeatStartTime = now;
-            nextRepeatTime = now + KEY_REPEAT_INITIAL_DELAY_MS;
-            upShortPressTrigger = true;
-        } else if (now >= nextRepeatTime) {
-            nextRepeatTime = now + KEY_REPEAT_INTERVAL_MS;
-            upRepeatTrigger = true;
-        }
-    } else if (downIsPressed) {
-        if (keyRepeatStartTime == 0) {
-            keyRepeatStartTime = now;
-            nextRepeatTime = now + KEY_REPEAT_INITIAL_DELAY_MS;
-            downShortPressTrigger = true;
-        } else if (now >= nextRepeatTime) {
-            nextRepeatTime = now + KEY_REPEAT_INTERVAL_MS;
-            downRepeatTrigger = true;
+    // 按鈕事件已由 HAL 去彈跳；START/STOP 作為 上/下，SETTING 放開時若未觸發過長按才算短按
+    ButtonEvent event;
+    while (hal_button_get_event(BUTTON_CONSUMER_UI, &event)) {
+        switch (event.button) {
+            case BUTTON_START:
+            case BUTTON_STOP:
+                if (event.type == BUTTON_EVENT_PRESS) {
+                    if (event.button == BUTTON_START) upShortPressTrigger = true;
+                    else downShortPressTrigger = true;
+                    repeatButton = event.button;
+                    isRepeatButtonHeld = true;
+                    nextRepeatTime = now + KEY_REPEAT_INITIAL_DELAY_MS;
+                } else if (event.type == BUTTON_EVENT_RELEASE && event.button == repeatButton) {
+                    isRepeatButtonHeld = false;
+                }
+                break;
+            case BUTTON_SETTING:
+                if (event.type == BUTTON_EVENT_PRESS) {
+                    isSettingButtonLongPress = false;
+                } else if (event.type == BUTTON_EVENT_LONG_PRESS) {
+                    settingLongPressTrigger = true;
+                    isSettingButtonLongPress = true;
+                } else if (!isSettingButtonLongPress) {
+                    settingShortPressTrigger = true;
+                }
+                break;
+            default:
+                break;
         }
-    } else {
-        keyRepeatStartTime = 0;
     }
 
-    // 處理 Setting 按鈕的長短按
-    if (settingIsPressed) {
-        if (settingButtonPressedTime == 0) {
-            settingButtonPressedTime = now;
-            isSettingButtonLongPress = false;
-        }
-        if (!isSettingButtonLongPress && (now - settingButtonPressedTime > LONG_PRESS_DURATION_MS)) {
-            settingLongPressTrigger = true;
-            isSettingButtonLongPress = true;
-        }
-    } else {
-        if (settingButtonPressedTime > 0 && !isSettingButtonLongPress) {
-            settingShortPressTrigger = true;
-        }
-        settingButtonPressedTime = 0;
-        isSettingButtonLongPress = false;
+    // 按住 上/下 時的重複
+    if (isRepeatButtonHeld && (long)(now - nextRepeatTime) >= 0) {
+        nextRepeatTime = now + KEY_REPEAT_INTERVAL_MS;
+        if (repeatButton == BUTTON_START) upRepeatTrigger = true;
+        else downRepeatTrigger = true;
     }
 
     // 如果有任何按鍵動作，強制刷新螢幕
@@ -166,19 +225,17 @@ void ui_handle_input(const DisplayData& data) {
             if (data.chargerState == STATE_CHG_IDLE) {
                 if (settingLongPressTrigger) {
                     Serial.println(F("UI: Long press detected. Entering settings menu."));
-                    tempSetting_Voltage = logic_get_max_voltage_setting();
-                    tempSetting_Current = logic_get_max_current_setting();
-                    tempSetting_SOC = logic_get_target_soc_setting();
+                    tempSetting_Voltage = config_get_max_voltage();
+                    tempSetting_Current = config_get_max_current();
+                    tempSetting_SOC = config_get_target_soc();
                     currentUIState = UI_STATE_MENU_MAIN;
                     mainMenuSelection = 0;
                     mainMenuOffset = 0;
                 } else if (settingShortPressTrigger) {
                     Serial.println(F("UI: Short press detected. Cycling Target SOC."));
-                    int current_soc = logic_get_target_soc_setting();
+                    int current_soc = config_get_target_soc();
                     int next_soc = (current_soc < 95) ? 95 : (current_soc < 100) ? 100 : 80;
-                    unsigned int current_v = logic_get_max_voltage_setting();
-                    unsigned int current_a = logic_get_max_current_setting();
-                    logic_save_config(current_v, current_a, next_soc);
+                    config_set_charge_settings(config_get_max_voltage(), config_get_max_current(), next_soc);
                 }
             }
             break;
@@ -195,7 +252,7 @@ void ui_handle_input(const DisplayData& data) {
                 else if (mainMenuSelection == 1) currentUIState = UI_STATE_MENU_SET_CURRENT;
                 else if (mainMenuSelection == 2) currentUIState = UI_STATE_MENU_SET_SOC;
                 else if (mainMenuSelection == 3) {
-                    logic_save_config(tempSetting_Voltage, tempSetting_Current, tempSetting_SOC);
+                    config_set_charge_settings(tempSetting_Voltage, tempSetting_Current, tempSetting_SOC);
                     currentUIState = UI_STATE_MENU_SAVED;
                     savedScreenStartTime = millis();
                 }
@@ -203,6 +260,10 @@ void ui_handle_input(const DisplayData& data) {
                     currentUIState = UI_STATE_MENU_NETWORK;
                 }
                 else if (mainMenuSelection == 5) {
+                    currentUIState = UI_STATE_MENU_CALIBRATION;
+                    calStep = CAL_STEP_CHANNEL;
+                }
+                else if (mainMenuSelection == 6) {
                     currentUIState = UI_STATE_MENU_ABOUT;
                 }
             }
@@ -245,6 +306,46 @@ void ui_handle_input(const DisplayData& data) {
             }
             break;
 
+        case UI_STATE_MENU_CALIBRATION:
+            if (settingLongPressTrigger) {
+                currentUIState = UI_STATE_MENU_MAIN;
+                break;
+            }
+            switch (calStep) {
+                case CAL_STEP_CHANNEL:
+                    if (upShortPressTrigger || downShortPressTrigger) {
+                        calChannel = (calChannel == ADC_CH_VOLTAGE) ? ADC_CH_CP : ADC_CH_VOLTAGE;
+                    }
+                    if (settingShortPressTrigger) {
+                        // 以目前讀值作為起點，通常只需要微調
+                        int32_t step = cal_step_mV();
+                        calReference_mV = (int32_t)lroundf(cal_reading() * 1000.0f / step) * step;
+                        calStep = CAL_STEP_POINT1;
+                    }
+                    break;
+                case CAL_STEP_POINT1:
+                case CAL_STEP_POINT2:
+                    if (upShortPressTrigger) calReference_mV += cal_step_mV();
+                    if (downShortPressTrigger) calReference_mV -= cal_step_mV();
+                    if (upRepeatTrigger) calReference_mV += cal_step_mV() * 10;
+                    if (downRepeatTrigger) calReference_mV -= cal_step_mV() * 10;
+                    if (calReference_mV < 0) calReference_mV = 0;
+                    if (settingShortPressTrigger) {
+                        hal_adc_cal_capture(calChannel, calStep == CAL_STEP_POINT1 ? 0 : 1, calReference_mV);
+                        if (calStep == CAL_STEP_POINT1) {
+                            calStep = CAL_STEP_POINT2;
+                        } else {
+                            calResultOk = hal_adc_cal_commit(calChannel);
+                            calStep = CAL_STEP_RESULT;
+                        }
+                    }
+                    break;
+                case CAL_STEP_RESULT:
+                    if (settingShortPressTrigger) currentUIState = UI_STATE_MENU_MAIN;
+                    break;
+            }
+            break;
+
         case UI_STATE_MENU_SET_VOLTAGE:
             if (upShortPressTrigger) tempSetting_Voltage += 1;
             if (downShortPressTrigger) tempSetting_Voltage -= 1;
@@ -397,6 +498,43 @@ void ui_update_display(const DisplayData& data) {
                     sprintf(buffer, "SOC  : %d %%", data.targetSOC);
                     u8g2.drawStr(5, 60, buffer);
                     break;
+                case UI_STATE_MENU_CALIBRATION: {
+                    u8g2.setFont(u8g2_font_ncenB10_tr);
+                    u8g2.drawStr(0, 12, calChannel == ADC_CH_VOLTAGE ? "Calibrate Vout" : "Calibrate CP");
+                    u8g2.drawHLine(0, 14, 128);
+                    u8g2.setFont(u8g2_font_6x10_tr);
+                    sprintf(buffer, "Now: %.3f V", cal_reading());
+                    u8g2.drawStr(0, 26, buffer);
+                    AdcCalibration cal = hal_adc_get_calibration(calChannel);
+                    if (calStep == CAL_STEP_CHANNEL) {
+                        sprintf(buffer, "Gain %.5f %ldmV", cal.gainQ16 / (float)ADC_CAL_GAIN_ONE, (long)cal.offsetMv);
+                        u8g2.drawStr(0, 38, buffer);
+                        u8g2.setFont(u8g2_font_5x8_tr);
+                        u8g2.drawStr(0, 52, "Up/Down: channel");
+                        u8g2.drawStr(0, 62, "Press: start, Hold: exit");
+                    } else if (calStep == CAL_STEP_RESULT) {
+                        u8g2.setFont(u8g2_font_ncenB08_tr);
+                        u8g2.drawStr(0, 42, calResultOk ? "Saved" : "Rejected");
+                        u8g2.setFont(u8g2_font_5x8_tr);
+                        if (calResultOk) {
+                            sprintf(buffer, "Gain %.5f Offset %ldmV", cal.gainQ16 / (float)ADC_CAL_GAIN_ONE, (long)cal.offsetMv);
+                        } else {
+                            strcpy(buffer, "Points < 1V apart?");
+                        }
+                        u8g2.drawStr(0, 54, buffer);
+                        u8g2.drawStr(0, 63, "Press: back");
+                    } else {
+                        sprintf(buffer, "Meter P%d:", calStep == CAL_STEP_POINT1 ? 1 : 2);
+                        u8g2.drawStr(0, 40, buffer);
+                        u8g2.setFont(u8g2_font_7x13B_tr);
+                        sprintf(buffer, "%.2f V", calReference_mV / 1000.0);
+                        u8g2.drawStr(60, 41, buffer);
+                        u8g2.setFont(u8g2_font_5x8_tr);
+                        u8g2.drawStr(0, 54, "Up/Down: adjust");
+                        u8g2.drawStr(0, 63, "Press: capture, Hold: exit");
+                    }
+                    break;
+                }
                 case UI_STATE_MENU_SET_VOLTAGE:
                     u8g2.setFont(u8g2_font_ncenB10_tr);
                     u8g2.drawStr(0, 12, "Set Max Voltage");
@@ -436,7 +574,11 @@ void ui_update_display(const DisplayData& data) {
                         u8g2.setFont(u8g2_font_6x10_tr);
                         sprintf(buffer, "Last Req: %.1fA", data.lastValidRequestedCurrent);
                         u8g2.drawStr(0, 28, buffer);
-                        sprintf(buffer, "Fault Flags: 0x%02X", data.lastFaultFlags);
+                        if (data.vehicleCanTimeout) {
+                            strcpy(buffer, "Vehicle CAN Timeout");
+                        } else {
+                            sprintf(buffer, "Fault Flags: 0x%02X", data.lastFaultFlags);
+                        }
                         u8g2.drawStr(0, 40, buffer);
                         
                         // 新增 Ready 和 Target SOC 顯示
@@ -508,6 +650,6 @@ void ui_update_display(const DisplayData& data) {
                     break;
             }
         }
-        u8g2.sendBuffer();
+        ui_send_buffer();
     }
 }
\ No newline at end of file
@@ -4,6 +4,6 @@
 #define VERSION_H
 
 #define FIRMWARE_VERSION "v2.5.0_Beta"
-#define FILESYSTEM_VERSION "v1.2.0"
+#define FILESYSTEM_VERSION "v1.2.3"
 
 #endif // VERSION_H
\ No newline at end of file
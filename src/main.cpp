@@ -58,26 +58,45 @@
 #include "Version.h" 
 #include <LittleFS.h> 
 #include "PowerSupplyController/PowerSupplyController.h"
+#include "CAN_Protocol/CAN_TxScheduler.h"
+#include "CAN_Protocol/CAN_BusHealth.h"
+#include "CAN_Protocol/CAN_Trace.h"
+#include "ConfigStore/ConfigStore.h"
+#include "HAL/I2C_Bus.h"
+#include "esp_timer.h"
 
 // --- FreeRTOS 任務函數原型 ---
+void adc_task(void *pvParameters);
 void can_task(void *pvParameters);
+void can_tx_task(void *pvParameters);
 void logic_task(void *pvParameters);
 void ui_task(void *pvParameters);
 void wifi_task(void *pvParameters);
 void monitor_task(void *pvParameters);
 void ota_task(void *pvParameters);
+void config_task(void *pvParameters);
+void psc_rx_task(void *pvParameters);
 
 // --- FreeRTOS 同步工具 ---
-// 為CAN數據創建一個互斥鎖
-SemaphoreHandle_t canDataMutex;
 DisplayData globalDisplayData;
 SemaphoreHandle_t displayDataMutex;
 
+TaskHandle_t adcTaskHandle = NULL;
 TaskHandle_t canTaskHandle = NULL;
+TaskHandle_t canTxTaskHandle = NULL;
 TaskHandle_t logicTaskHandle = NULL;
 TaskHandle_t uiTaskHandle = NULL;
 TaskHandle_t wifitaskHandle = NULL;
 TaskHandle_t otaTaskHandle = NULL;
+TaskHandle_t configTaskHandle = NULL;
+TaskHandle_t pscRxTaskHandle = NULL;
+
+// 0x508/0x509/0x5F8 的週期計時器，不受 Logic 任務的執行時間影響
+static esp_timer_handle_t canTxTimer = NULL;
+
+static void can_tx_timer_callback(void* arg) {
+    can_tx_periodic_tick();
+}
 
 bool filesystem_version_mismatch = false;
 char current_filesystem_version[16] = "N/A";
@@ -121,12 +140,6 @@ void setup() {
     delay(1000);
     Serial.println(F("DC Charger Controller Booting Up..."));
 
-    canDataMutex = xSemaphoreCreateMutex();
-    if (canDataMutex == NULL) {
-        Serial.println("FATAL: Failed to create canDataMutex!");
-        while(1);
-    }
-
     displayDataMutex = xSemaphoreCreateMutex();
     if (displayDataMutex == NULL) {
         Serial.println("FATAL: Failed to create displayDataMutex!");
@@ -135,10 +148,25 @@ void setup() {
     
     memset(&globalDisplayData, 0, sizeof(DisplayData));
 
+    // 設定只在開機時從 NVS 讀一次，之後各模組都讀 RAM 中的快取
+    config_init();
+
     // 按順序初始化各層
     hal_init_pins();
     hal_init_adc();
+    // ADC 任務在 logic_init() 之前啟動，開機偵測電源電壓時已有濾波值
+    xTaskCreate(
+        adc_task,
+        "ADC_Task",
+        2048,
+        NULL,
+        5,
+        &adcTaskHandle
+    );
+    can_trace_init();
     hal_init_can();
+    can_bus_health_init();
+    can_tx_init();
     psc_init();
 
     ui_init(); 
@@ -163,12 +191,40 @@ void setup() {
     xTaskCreate(
         can_task,
         "CAN_Task",
-        1024, // 堆疊大小 (Bytes)
+        3072, // 堆疊大小 (Bytes)；bus-off/遺失報文的 Serial.printf 需要較多堆疊
         NULL,
         5,    // 優先級 (數字越大越高)
         &canTaskHandle
     );
 
+    xTaskCreate(
+        can_tx_task,
+        "CAN_TX_Task",
+        2048,
+        NULL,
+        5,
+        &canTxTaskHandle
+    );
+
+    // 優先級高於 Logic：遙測一到就解析發布，Logic 讀到的是最新一筆而不是上個週期前的
+    xTaskCreate(
+        psc_rx_task,
+        "PSC_RX_Task",
+        3072, // 協商與斷線時的 Serial.printf
+        NULL,
+        5,
+        &pscRxTaskHandle
+    );
+
+    esp_timer_create_args_t canTxTimerArgs = {};
+    canTxTimerArgs.callback = &can_tx_timer_callback;
+    canTxTimerArgs.name = "can_tx";
+    if (esp_timer_create(&canTxTimerArgs, &canTxTimer) != ESP_OK ||
+        esp_timer_start_periodic(canTxTimer, PERIODIC_SEND_INTERVAL * 1000) != ESP_OK) {
+        Serial.println("FATAL: Failed to start CAN TX timer!");
+        while(1);
+    }
+
     xTaskCreate(
         logic_task,
         "Logic_Task",
@@ -205,6 +261,16 @@ void setup() {
         &otaTaskHandle
     );
     
+    // 優先級最低：NVS 寫入期間會暫停 flash cache，不應搶在控制與通訊任務之前
+    xTaskCreate(
+        config_task,
+        "Config_Task",
+        3072,
+        NULL,
+        1,
+        &configTaskHandle
+    );
+
     xTaskCreate(
         monitor_task, 
         "Monitor_Task", 
@@ -221,12 +287,29 @@ void setup() {
 void loop() {
 }
 
+void adc_task(void *pvParameters) {
+    Serial.println("ADC Task started.");
+    for (;;) {
+        // 阻塞等待 ADS1115 的 ALERT/RDY 中斷，每筆轉換只做一次 I2C 讀取
+        hal_adc_handle_sampling();
+    }
+}
+
 void can_task(void *pvParameters) {
     Serial.println("CAN Task started.");
     for (;;) {
-        can_protocol_handle_receive();
-        
-        vTaskDelay(pdMS_TO_TICKS(10)); 
+        // 阻塞在 TWAI 接收佇列上，報文一到就立即解析，不再以 10ms 輪詢
+        can_protocol_handle_receive(CAN_RX_WAIT_MS);
+        // 沒有報文時最多 CAN_RX_WAIT_MS 也會回到這裡，bus-off 時仍能偵測並恢復
+        can_bus_health_poll();
+    }
+}
+
+void can_tx_task(void *pvParameters) {
+    Serial.println("CAN TX Task started.");
+    for (;;) {
+        // 只有這個任務會呼叫 twai_transmit；匯流排壅塞時阻塞的是這裡，而不是 Logic 任務
+        can_tx_handle_transmit(portMAX_DELAY);
     }
 }
 
@@ -238,6 +321,9 @@ void logic_task(void *pvParameters) {
         if (ui_get_current_state() == UI_STATE_NORMAL) {
             logic_run_statemachine();
             logic_handle_periodic_tasks();
+        } else {
+            // 選單中 START/STOP 作為上下鍵，離開選單後不應被當成啟動/停止
+            hal_button_flush(BUTTON_CONSUMER_LOGIC);
         }
 
         if (xSemaphoreTake(displayDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
@@ -247,12 +333,21 @@ void logic_task(void *pvParameters) {
             globalDisplayData.filesystemMismatch = filesystem_version_mismatch;
             strncpy(globalDisplayData.filesystemVersion, current_filesystem_version, 15);
             globalDisplayData.filesystemVersion[15] = '\0';
+            globalDisplayData.canBus = can_bus_health_get();
             
             xSemaphoreGive(displayDataMutex);
         }
 
-        psc_handle_task();
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // 等待下一個週期；期間若 CAN 任務通知安全事件 (緊急停止/車輛故障)，立即處理而不等到下個週期
+        xLastWakeTime += xFrequency;
+        for (;;) {
+            TickType_t remaining = xLastWakeTime - xTaskGetTickCount();
+            if ((int32_t)remaining <= 0) break;
+            if (ulTaskNotifyTake(pdTRUE, remaining) > 0) {
+                // 緊急停止按鈕即使在選單中也要處理
+                logic_handle_safety_event();
+            }
+        }
     }
 }
 
@@ -291,6 +386,8 @@ void wifi_task(void *pvParameters) {
             net_handle_tasks(globalDisplayData);
             xSemaphoreGive(displayDataMutex);
         }
+        // 故障視窗在此複製 (最多 128 KB)，不佔用 CAN 與 Logic 任務的時間
+        can_trace_service();
         
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
     }
@@ -304,26 +401,118 @@ void ota_task(void *pvParameters) {
     }
 }
 
+void config_task(void *pvParameters) {
+    Serial.println("Config Task started.");
+    for (;;) {
+        // 設定變更時被通知；靜止 CONFIG_SAVE_QUIET_MS 後才寫入，期間的變更只延後期限
+        uint32_t wait_ms = config_writer_service(millis());
+        ulTaskNotifyTake(pdTRUE, wait_ms == CONFIG_WRITER_IDLE ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms));
+    }
+}
+
+void psc_rx_task(void *pvParameters) {
+    Serial.println("PSC RX Task started.");
+    for (;;) {
+        // UART 收到一行或 Logic 更新設定值時被通知；沒有資料時也定期醒來檢查斷線，斜坡進行中則依回傳的時間醒來
+        uint32_t wait_ms = psc_rx_service();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+    }
+}
+
 void monitor_task(void *pvParameters) {
     Serial.println("System Monitor Task started.");
     for (;;) {
         // 每10秒打印一次報告
         vTaskDelay(pdMS_TO_TICKS(10000));
 
+        UBaseType_t adc_stack_hwm = uxTaskGetStackHighWaterMark(adcTaskHandle);
         UBaseType_t can_stack_hwm = uxTaskGetStackHighWaterMark(canTaskHandle);
+        UBaseType_t can_tx_stack_hwm = uxTaskGetStackHighWaterMark(canTxTaskHandle);
         UBaseType_t logic_stack_hwm = uxTaskGetStackHighWaterMark(logicTaskHandle);
         UBaseType_t ui_stack_hwm = uxTaskGetStackHighWaterMark(uiTaskHandle);
         UBaseType_t wifi_stack_hwm = uxTaskGetStackHighWaterMark(wifitaskHandle);
         UBaseType_t ota_stack_hwm = uxTaskGetStackHighWaterMark(otaTaskHandle);
+        UBaseType_t config_stack_hwm = uxTaskGetStackHighWaterMark(configTaskHandle);
+        UBaseType_t psc_rx_stack_hwm = uxTaskGetStackHighWaterMark(pscRxTaskHandle);
 
         Serial.println("\n--- RTOS STATUS ---");
         //打印的是剩餘的最小值，單位是字(4 bytes)
+        Serial.printf("ADC Task Stack HWM: %u words (%u bytes)\n", adc_stack_hwm, adc_stack_hwm * 4);
         Serial.printf("CAN Task Stack HWM: %u words (%u bytes)\n", can_stack_hwm, can_stack_hwm * 4);
+        Serial.printf("CAN TX Task Stack HWM: %u words (%u bytes)\n", can_tx_stack_hwm, can_tx_stack_hwm * 4);
         Serial.printf("Logic Task Stack HWM: %u words (%u bytes)\n", logic_stack_hwm, logic_stack_hwm * 4);
         Serial.printf("UI Task Stack HWM: %u words (%u bytes)\n", ui_stack_hwm, ui_stack_hwm * 4);
         Serial.printf("WiFi Task Stack HWM: %u words (%u bytes)\n", wifi_stack_hwm, wifi_stack_hwm * 4);
         Serial.printf("OTA Task Stack HWM: %u words (%u bytes)\n", ota_stack_hwm, ota_stack_hwm * 4);
+        Serial.printf("Config Task Stack HWM: %u words (%u bytes)\n", config_stack_hwm, config_stack_hwm * 4);
+        Serial.printf("PSC RX Task Stack HWM: %u words (%u bytes)\n", psc_rx_stack_hwm, psc_rx_stack_hwm * 4);
         Serial.printf("Free Heap: %u bytes\n", ESP.getFreeHeap());
+
+        ConfigWriterStats cfg = config_get_writer_stats();
+        Serial.printf("Config NVS: writes %lu, skipped (unchanged) %lu, failed %lu\n",
+                      (unsigned long)cfg.writes, (unsigned long)cfg.skipped, (unsigned long)cfg.failures);
+        PscParserStats psc = psc_get_parser_stats();
+        PscSample psc_sample;
+        bool psc_has_sample = psc_get_sample(psc_sample);
+        Serial.printf("PSC UART: telemetry lines %lu, malformed %lu (overlong %lu), last sample %ld ms ago\n",
+                      (unsigned long)psc.lines, (unsigned long)psc.malformed, (unsigned long)psc.overlong,
+                      psc_has_sample ? (long)(millis() - psc_sample.rxMs) : -1L);
+        PscLinkStats link = psc_get_link_stats();
+        Serial.printf("PSC link: %s, frames %lu, CRC errors %lu, framing errors %lu, telemetry lost %lu, ACKs %lu, "
+                      "retransmits %lu, set failures %lu, RTT %lu us (max %lu), fallbacks %lu\n",
+                      link.mode == PSC_LINK_BINARY ? "binary" : link.mode == PSC_LINK_NEGOTIATING ? "negotiating" : "text",
+                      (unsigned long)link.frames, (unsigned long)link.crcErrors, (unsigned long)link.framingErrors,
+                      (unsigned long)link.telemetryLost, (unsigned long)link.acks, (unsigned long)link.retransmits,
+                      (unsigned long)link.setFailures, (unsigned long)link.rttLastUs, (unsigned long)link.rttMaxUs,
+                      (unsigned long)link.fallbacks);
+        PscSetpointStats sp = psc_get_setpoint_stats();
+        Serial.printf("PSC setpoint: target %.2f V / %.2f A, ramp %.2f A, sent %.2f A, commands %lu, deferred %lu\n",
+                      sp.targetVoltage_mV / 1000.0f, sp.targetCurrent_mA / 1000.0f, sp.rampCurrent_mA / 1000.0f,
+                      sp.commandCurrent_mA / 1000.0f, (unsigned long)sp.commands, (unsigned long)sp.deferred);
+        PscCurrentLoopStatus loop = psc_get_current_loop_status();
+        Serial.printf("PSC current loop: %s, error %.2f A, trim %.2f A%s%s, updates %lu\n",
+                      loop.active ? "active" : "idle", loop.error_mA / 1000.0f, loop.trim_mA / 1000.0f,
+                      loop.saturated ? " (saturated)" : "", loop.voltageLimited ? " (CV)" : "", (unsigned long)loop.updates);
+        HalAdcStats adc = hal_adc_get_stats();
+        Serial.printf("ADC: conversions %lu, RDY timeouts %lu, channel cycles %lu\n",
+                      (unsigned long)adc.conversions, (unsigned long)adc.readyTimeouts, (unsigned long)adc.channelCycles);
+        // 佔用率以這次與上次報告之間的差值計算
+        static I2cBusStats last_i2c;
+        static int64_t last_i2c_us = 0;
+        I2cBusStats i2c = i2c_bus_get_stats();
+        int64_t now_us = esp_timer_get_time();
+        double i2c_span_us = last_i2c_us ? (double)(now_us - last_i2c_us) : (double)now_us;
+        Serial.printf("I2C (%lu kHz): ADC %.1f%% (%lu txn, max wait %lu us), OLED %.1f%% (%lu txn, max hold %lu us), OLED deferred %lu, timeouts %lu, "
+                      "OLED frame %lu us (max %lu us, %lu frames)\n",
+                      (unsigned long)(I2C_BUS_FREQUENCY_HZ / 1000),
+                      100.0 * (i2c.busyUs[I2C_CLIENT_ADC] - last_i2c.busyUs[I2C_CLIENT_ADC]) / i2c_span_us,
+                      (unsigned long)(i2c.transactions[I2C_CLIENT_ADC] - last_i2c.transactions[I2C_CLIENT_ADC]),
+                      (unsigned long)i2c.maxWaitUs[I2C_CLIENT_ADC],
+                      100.0 * (i2c.busyUs[I2C_CLIENT_DISPLAY] - last_i2c.busyUs[I2C_CLIENT_DISPLAY]) / i2c_span_us,
+                      (unsigned long)(i2c.transactions[I2C_CLIENT_DISPLAY] - last_i2c.transactions[I2C_CLIENT_DISPLAY]),
+                      (unsigned long)i2c.maxHoldUs[I2C_CLIENT_DISPLAY],
+                      (unsigned long)i2c.deferred, (unsigned long)i2c.timeouts,
+                      (unsigned long)i2c.lastFrameUs, (unsigned long)i2c.maxFrameUs, (unsigned long)i2c.displayFrames);
+        last_i2c = i2c;
+        last_i2c_us = now_us;
+        // 硬體濾波器擋下的報文控制器不計數；全收模式下 SW discarded 即為濾波器可省下的量
+        CAN_Rx_Counters rx = can_protocol_get_rx_counters();
+        Serial.printf("CAN RX (filter %s): accepted %lu, decoded %lu, SW discarded %lu\n",
+                      hal_can_filter_accepts_all() ? "ACCEPT ALL" : "HW",
+                      (unsigned long)rx.received, (unsigned long)rx.decoded, (unsigned long)rx.discarded);
+        CAN_Tx_Stats tx = can_tx_get_stats();
+        Serial.printf("CAN TX: sent %lu, failed %lu, queue full %lu, periods skipped %lu, stale periodic dropped %lu, "
+                      "max latency %lu us, max jitter %lu us\n",
+                      (unsigned long)tx.sent, (unsigned long)tx.failed, (unsigned long)tx.queueFull,
+                      (unsigned long)tx.periodsSkipped, (unsigned long)tx.periodicDropped,
+                      (unsigned long)tx.maxQueueLatencyUs, (unsigned long)tx.maxPeriodJitterUs);
+        static const char* const bus_state_names[] = {"STOPPED", "RUNNING", "BUS-OFF", "RECOVERING"};
+        CAN_Bus_Health bus = can_bus_health_get();
+        Serial.printf("CAN BUS: %s%s, TEC %u, REC %u, RX missed %lu, RX overrun %lu, arb lost %lu, bus errors %lu, TX failed %lu, bus-off %lu (recovered %lu)\n",
+                      bus_state_names[bus.state], bus.errorPassive ? " (error passive)" : "",
+                      bus.txErrorCounter, bus.rxErrorCounter, (unsigned long)bus.rxMissed, (unsigned long)bus.rxOverrun,
+                      (unsigned long)bus.arbLost, (unsigned long)bus.busErrors, (unsigned long)bus.txFailed,
+                      (unsigned long)bus.busOffCount, (unsigned long)bus.recoveries);
         Serial.println("-------------------\n");
     }
 }